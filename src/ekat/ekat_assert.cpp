@@ -1,4 +1,10 @@
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
 
 #include "ekat_assert.hpp"
 #include "ekat_session.hpp"
@@ -14,6 +20,117 @@
 namespace ekat {
 namespace error {
 
+namespace {
+
+struct FlushCallback {
+  std::function<void()> f;
+  int num_running = 0;
+};
+
+std::mutex& flush_callbacks_mutex () {
+  static std::mutex m;
+  return m;
+}
+std::condition_variable& flush_callbacks_cv () {
+  static std::condition_variable cv;
+  return cv;
+}
+std::map<int,FlushCallback>& flush_callbacks () {
+  static std::map<int,FlushCallback> callbacks;
+  return callbacks;
+}
+
+// Whether this thread is running the callbacks
+thread_local bool running_flush_callbacks = false;
+
+std::terminate_handler& prev_terminate_handler () {
+  static std::terminate_handler h = nullptr;
+  return h;
+}
+
+[[noreturn]] void flush_and_terminate () {
+  run_flush_callbacks();
+  auto prev = prev_terminate_handler();
+  if (prev!=nullptr) {
+    prev();
+  }
+  std::abort();
+}
+
+} // anonymous namespace
+
+int add_flush_callback (const std::function<void()>& f) {
+  // Uncaught exceptions (and the like) end up in std::terminate
+  static std::once_flag terminate_handler_set;
+  std::call_once(terminate_handler_set,[]() {
+    prev_terminate_handler() = std::set_terminate(flush_and_terminate);
+  });
+
+  std::lock_guard<std::mutex> lock(flush_callbacks_mutex());
+  static int next_id = 0;
+  flush_callbacks()[next_id].f = f;
+  return next_id++;
+}
+
+void remove_flush_callback (const int id) {
+  std::unique_lock<std::mutex> lock(flush_callbacks_mutex());
+  auto it = flush_callbacks().find(id);
+  if (it==flush_callbacks().end()) {
+    return;
+  }
+  // Wait for other threads running it, so that the caller can destroy what
+  // the callback uses. This thread cannot be running it: callbacks must not
+  // remove themselves.
+  if (not running_flush_callbacks) {
+    flush_callbacks_cv().wait(lock,[&]() { return it->second.num_running==0; });
+  }
+  flush_callbacks().erase(it);
+}
+
+void run_flush_callbacks () {
+  // A callback may fail a check itself: do not recurse
+  if (running_flush_callbacks) {
+    return;
+  }
+  running_flush_callbacks = true;
+
+  // Call the callbacks without holding the lock, since they may wait on
+  // other threads that run the callbacks themselves
+  std::vector<int> ids;
+  {
+    std::lock_guard<std::mutex> lock(flush_callbacks_mutex());
+    for (const auto& it : flush_callbacks()) {
+      ids.push_back(it.first);
+    }
+  }
+  for (const auto id : ids) {
+    std::function<void()> f;
+    {
+      std::lock_guard<std::mutex> lock(flush_callbacks_mutex());
+      auto it = flush_callbacks().find(id);
+      if (it==flush_callbacks().end()) {
+        continue;
+      }
+      ++it->second.num_running;
+      f = it->second.f;
+    }
+    try {
+      f();
+    } catch (...) {
+      // Nothing we can do
+    }
+    {
+      std::lock_guard<std::mutex> lock(flush_callbacks_mutex());
+      auto it = flush_callbacks().find(id);
+      if (it!=flush_callbacks().end()) {
+        --it->second.num_running;
+      }
+    }
+    flush_callbacks_cv().notify_all();
+  }
+  running_flush_callbacks = false;
+}
+
 void runtime_check(bool cond, const std::string& message, int code) {
   if (!cond) {
     runtime_abort(message,code);
@@ -23,8 +140,8 @@ void runtime_check(bool cond, const std::string& message, int code) {
 void runtime_abort(const std::string& message, int code) {
   std::cerr << message << std::endl << "Exiting..." << std::endl;
 
-  // Finalize ekat (e.g., finalize kokkos);
-  finalize_ekat_session();
+  // Finalize ekat (e.g., finalize kokkos), without waiting on other ranks
+  ekat_impl::finalize_ekat_session_local();
 
 #ifdef EKAT_ENABLE_MPI
   // Check if mpi is active. If so, use MPI_Abort, otherwise, simply std::abort
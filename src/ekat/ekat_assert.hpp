@@ -3,6 +3,7 @@
 
 #include <sstream>
 #include <exception>
+#include <functional>
 #include <assert.h>
 #include <stdexcept>  // For std::logic_error
 
@@ -25,6 +26,23 @@
 #define EKAT_BACKTRACE __FILE__ << ":" << __LINE__
 #endif
 
+namespace ekat {
+namespace error {
+
+// Callbacks run when the ekat session is finalized, on runtime_abort, and
+// when std::terminate is called (e.g., for an uncaught exception). They can
+// be used to flush buffered output (e.g., asynchronous logs), which would
+// otherwise be lost if the program terminates. Failed checks that are caught
+// do not run them. Callbacks must not throw. Returns an id, to be used to
+// remove the callback; once remove_flush_callback returns, the callback is
+// not running, and will not run anymore.
+int  add_flush_callback (const std::function<void()>& f);
+void remove_flush_callback (const int id);
+void run_flush_callbacks ();
+
+} // namespace error
+} // namespace ekat
+
 // Internal do not call directly
 #define IMPL_THROW(condition, msg, exception_type)    \
   do {                                                \
@@ -2,7 +2,10 @@
 #include "ekat/ekat_session.hpp"
 #include "ekat/ekat_assert.hpp"
 #include "ekat/util/ekat_arch.hpp"
+#include "ekat/mpi/ekat_comm.hpp"
+#include "ekat/mpi/ekat_comm_profiler.hpp"
 
+#include <iostream>
 #include <vector>
 #include <cfenv>
 
@@ -66,6 +69,13 @@ void initialize_kokkos () {
   Kokkos::initialize(settings);
 }
 
+void finalize_ekat_session_local () {
+  // E.g., flush asynchronous logs
+  ekat::error::run_flush_callbacks();
+
+  Kokkos::finalize();
+}
+
 } // anonymous namespace
 
 namespace ekat {
@@ -108,7 +118,20 @@ void initialize_ekat_session (int argc, char **argv, bool print_config) {
 
 extern "C" {
 void finalize_ekat_session () {
-  Kokkos::finalize();
+  if (comm_profiling_enabled()) {
+    // The profile can only be reduced if MPI is still usable
+#ifdef EKAT_ENABLE_MPI
+    int inited, finalized;
+    MPI_Initialized(&inited);
+    MPI_Finalized(&finalized);
+    if (inited && not finalized) {
+      print_comm_profile(Comm(MPI_COMM_WORLD),std::cout);
+    }
+#else
+    print_comm_profile(Comm(MPI_COMM_WORLD),std::cout);
+#endif
+  }
+  ekat_impl::finalize_ekat_session_local();
 }
 } // extern "C"
 
@@ -7,10 +7,18 @@ void initialize_ekat_session(bool print_config = true);
 void initialize_ekat_session(int argc, char **argv, bool print_config = true);
 
 // A version callable from Fortran, which can help
-// in case of errors to correctly shut down Kokkos
+// in case of errors to correctly shut down Kokkos.
+// If Comm profiling is enabled, this is collective on MPI_COMM_WORLD,
+// since root prints the Comm profile of all ranks.
 extern "C" {
 void finalize_ekat_session();
 } // extern "C"
 } // namespace ekat
 
+namespace ekat_impl {
+// Finalize the session without communicating with other ranks (e.g., when
+// aborting, since other ranks may not get to finalize).
+void finalize_ekat_session_local ();
+} // namespace ekat_impl
+
 #endif // EKAT_SESSION_HPP
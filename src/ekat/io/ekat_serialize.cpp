@@ -0,0 +1,94 @@
+#include "ekat/io/ekat_serialize.hpp"
+#include "ekat/ekat_parameter_list.hpp"
+#include "ekat/util/ekat_meta_utils.hpp"
+
+namespace ekat {
+
+// The parameter types that can be (de)serialized, which are those produced by
+// the YAML parser. Each parameter is preceded by the index of its type in this
+// list, so the order of the types must not change.
+using param_values_t = TypeList<bool,int,double,std::string,
+                                std::vector<char>,std::vector<int>,
+                                std::vector<double>,std::vector<std::string>>;
+
+void serialize (const ParameterList& params, std::vector<char>& buf)
+{
+  serialize(params.name(),buf);
+
+  const auto nparams = std::distance(params.params_names_cbegin(),params.params_names_cend());
+  serialize(static_cast<std::uint64_t>(nparams),buf);
+  for (auto it=params.params_names_cbegin(); it!=params.params_names_cend(); ++it) {
+    const auto& pname = *it;
+    serialize(pname,buf);
+
+    std::uint8_t type_idx = 0;
+    bool found = false;
+    TypeListFor<param_values_t>([&](auto t) -> bool {
+      using vtype = decltype(t);
+      if (params.isType<vtype>(pname)) {
+        serialize(type_idx,buf);
+        serialize(params.get<vtype>(pname),buf);
+        found = true;
+      }
+      ++type_idx;
+      return found;
+    });
+    EKAT_REQUIRE_MSG (found,
+        "Error! Parameter type not supported by serialize.\n"
+        "  - list name : " + params.name() + "\n"
+        "  - param name: " + pname + "\n"
+        "  Supported types: bool, int, double, std::string,\n"
+        "    std::vector<char>, std::vector<int>, std::vector<double>, std::vector<std::string>\n");
+  }
+
+  const auto nsublists = std::distance(params.sublists_names_cbegin(),params.sublists_names_cend());
+  serialize(static_cast<std::uint64_t>(nsublists),buf);
+  for (auto it=params.sublists_names_cbegin(); it!=params.sublists_names_cend(); ++it) {
+    serialize(params.sublist(*it),buf);
+  }
+}
+
+void deserialize (ParameterList& params, const std::vector<char>& buf, std::size_t& pos)
+{
+  std::string name;
+  deserialize(name,buf,pos);
+  ParameterList tmp(name);
+
+  const auto nparams = impl::deserialize_size(buf,pos);
+  for (std::size_t i=0; i<nparams; ++i) {
+    std::string pname;
+    std::uint8_t type_idx;
+    deserialize(pname,buf,pos);
+    deserialize(type_idx,buf,pos);
+
+    std::uint8_t idx = 0;
+    bool found = false;
+    TypeListFor<param_values_t>([&](auto t) -> bool {
+      using vtype = decltype(t);
+      if (idx==type_idx) {
+        vtype val;
+        deserialize(val,buf,pos);
+        tmp.set(pname,val);
+        found = true;
+      }
+      ++idx;
+      return found;
+    });
+    EKAT_REQUIRE_MSG (found,
+        "Error! Invalid parameter type found while deserializing a ParameterList.\n"
+        "  - list name : " + name + "\n"
+        "  - param name: " + pname + "\n"
+        "  - type index: " + std::to_string(type_idx) + "\n");
+  }
+
+  const auto nsublists = impl::deserialize_size(buf,pos);
+  for (std::size_t i=0; i<nsublists; ++i) {
+    ParameterList sub;
+    deserialize(sub,buf,pos);
+    tmp.sublist(sub.name()) = sub;
+  }
+
+  params = tmp;
+}
+
+} // namespace ekat
@@ -0,0 +1,229 @@
+#ifndef EKAT_SERIALIZE_HPP
+#define EKAT_SERIALIZE_HPP
+
+#include "ekat/ekat_assert.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ekat {
+
+class ParameterList;
+
+/*
+ * Compact binary serialization of values, STL containers, and ParameterList's.
+ *
+ * serialize appends the bytes of a value to a buffer, and deserialize reads
+ * them back, starting at position pos in the buffer, and advancing pos past
+ * the bytes read. Values are stored with their native representation (sizes
+ * as 64-bit integers), so a buffer can only be read on an architecture with
+ * the same endianness and type sizes as the one that wrote it (e.g., to
+ * broadcast a value from one rank to all the others, see Comm::broadcast).
+ *
+ * Supported types are:
+ *  - arithmetic types
+ *  - std::string
+ *  - std::vector, std::set, std::map and std::pair of supported types
+ *  - ParameterList, if its parameters are of the types produced by the YAML
+ *    parser (see ekat_yaml.hpp); any other parameter type throws.
+ *
+ * Reading past the end of the buffer throws.
+ */
+
+void serialize (const ParameterList& params, std::vector<char>& buf);
+void deserialize (ParameterList& params, const std::vector<char>& buf, std::size_t& pos);
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type
+serialize (const T& val, std::vector<char>& buf) {
+  const char* bytes = reinterpret_cast<const char*>(&val);
+  buf.insert(buf.end(),bytes,bytes+sizeof(T));
+}
+
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type
+deserialize (T& val, const std::vector<char>& buf, std::size_t& pos) {
+  EKAT_REQUIRE_MSG (pos+sizeof(T)<=buf.size(),
+      "Error! Attempting to deserialize past the end of the buffer.\n"
+      "  - buffer size: " + std::to_string(buf.size()) + "\n"
+      "  - position   : " + std::to_string(pos) + "\n");
+  std::memcpy(&val,buf.data()+pos,sizeof(T));
+  pos += sizeof(T);
+}
+
+// Forward declarations, so that containers of containers can be handled
+template<typename T>
+void serialize (const std::vector<T>& vals, std::vector<char>& buf);
+template<typename T>
+void deserialize (std::vector<T>& vals, const std::vector<char>& buf, std::size_t& pos);
+template<typename T>
+void serialize (const std::set<T>& vals, std::vector<char>& buf);
+template<typename T>
+void deserialize (std::set<T>& vals, const std::vector<char>& buf, std::size_t& pos);
+template<typename K, typename V>
+void serialize (const std::map<K,V>& vals, std::vector<char>& buf);
+template<typename K, typename V>
+void deserialize (std::map<K,V>& vals, const std::vector<char>& buf, std::size_t& pos);
+template<typename T1, typename T2>
+void serialize (const std::pair<T1,T2>& val, std::vector<char>& buf);
+template<typename T1, typename T2>
+void deserialize (std::pair<T1,T2>& val, const std::vector<char>& buf, std::size_t& pos);
+
+inline void serialize (const std::string& str, std::vector<char>& buf) {
+  serialize(static_cast<std::uint64_t>(str.size()),buf);
+  buf.insert(buf.end(),str.begin(),str.end());
+}
+
+inline void deserialize (std::string& str, const std::vector<char>& buf, std::size_t& pos) {
+  std::uint64_t size;
+  deserialize(size,buf,pos);
+  EKAT_REQUIRE_MSG (size<=buf.size()-pos,
+      "Error! Attempting to deserialize past the end of the buffer.\n"
+      "  - buffer size: " + std::to_string(buf.size()) + "\n"
+      "  - position   : " + std::to_string(pos) + "\n");
+  str.assign(buf.data()+pos,size);
+  pos += size;
+}
+
+namespace impl {
+// Vectors of these types are copied in bulk (std::vector<bool> is not contiguous)
+template<typename T>
+using is_bulk_serializable = std::integral_constant<bool,
+    std::is_arithmetic<T>::value && not std::is_same<T,bool>::value>;
+
+template<typename T>
+void serialize_vector (const std::vector<T>& vals, std::vector<char>& buf, std::true_type) {
+  const char* bytes = reinterpret_cast<const char*>(vals.data());
+  buf.insert(buf.end(),bytes,bytes+vals.size()*sizeof(T));
+}
+template<typename T>
+void serialize_vector (const std::vector<T>& vals, std::vector<char>& buf, std::false_type) {
+  for (std::size_t i=0; i<vals.size(); ++i) {
+    serialize(static_cast<const T&>(vals[i]),buf);
+  }
+}
+template<typename T>
+void deserialize_vector (std::vector<T>& vals, const std::vector<char>& buf, std::size_t& pos, std::true_type) {
+  EKAT_REQUIRE_MSG (vals.size()<=(buf.size()-pos)/sizeof(T),
+      "Error! Attempting to deserialize past the end of the buffer.\n"
+      "  - buffer size: " + std::to_string(buf.size()) + "\n"
+      "  - position   : " + std::to_string(pos) + "\n");
+  std::memcpy(vals.data(),buf.data()+pos,vals.size()*sizeof(T));
+  pos += vals.size()*sizeof(T);
+}
+template<typename T>
+void deserialize_vector (std::vector<T>& vals, const std::vector<char>& buf, std::size_t& pos, std::false_type) {
+  for (std::size_t i=0; i<vals.size(); ++i) {
+    T val;
+    deserialize(val,buf,pos);
+    vals[i] = std::move(val);
+  }
+}
+
+// The number of entries of a container, checking that it could fit in the
+// rest of the buffer (each entry takes at least one byte), so that a corrupted
+// buffer does not trigger a huge allocation
+inline std::size_t deserialize_size (const std::vector<char>& buf, std::size_t& pos) {
+  std::uint64_t size;
+  deserialize(size,buf,pos);
+  EKAT_REQUIRE_MSG (size<=buf.size()-pos,
+      "Error! Attempting to deserialize past the end of the buffer.\n"
+      "  - buffer size: " + std::to_string(buf.size()) + "\n"
+      "  - position   : " + std::to_string(pos) + "\n"
+      "  - num entries: " + std::to_string(size) + "\n");
+  return size;
+}
+} // namespace impl
+
+template<typename T>
+void serialize (const std::vector<T>& vals, std::vector<char>& buf) {
+  serialize(static_cast<std::uint64_t>(vals.size()),buf);
+  impl::serialize_vector(vals,buf,impl::is_bulk_serializable<T>());
+}
+
+template<typename T>
+void deserialize (std::vector<T>& vals, const std::vector<char>& buf, std::size_t& pos) {
+  vals.resize(impl::deserialize_size(buf,pos));
+  impl::deserialize_vector(vals,buf,pos,impl::is_bulk_serializable<T>());
+}
+
+template<typename T>
+void serialize (const std::set<T>& vals, std::vector<char>& buf) {
+  serialize(static_cast<std::uint64_t>(vals.size()),buf);
+  for (const auto& v : vals) {
+    serialize(v,buf);
+  }
+}
+
+template<typename T>
+void deserialize (std::set<T>& vals, const std::vector<char>& buf, std::size_t& pos) {
+  const auto size = impl::deserialize_size(buf,pos);
+  vals.clear();
+  for (std::size_t i=0; i<size; ++i) {
+    T val;
+    deserialize(val,buf,pos);
+    vals.insert(vals.end(),std::move(val));
+  }
+}
+
+template<typename K, typename V>
+void serialize (const std::map<K,V>& vals, std::vector<char>& buf) {
+  serialize(static_cast<std::uint64_t>(vals.size()),buf);
+  for (const auto& it : vals) {
+    serialize(it.first,buf);
+    serialize(it.second,buf);
+  }
+}
+
+template<typename K, typename V>
+void deserialize (std::map<K,V>& vals, const std::vector<char>& buf, std::size_t& pos) {
+  const auto size = impl::deserialize_size(buf,pos);
+  vals.clear();
+  for (std::size_t i=0; i<size; ++i) {
+    K key;
+    deserialize(key,buf,pos);
+    deserialize(vals[key],buf,pos);
+  }
+}
+
+template<typename T1, typename T2>
+void serialize (const std::pair<T1,T2>& val, std::vector<char>& buf) {
+  serialize(val.first,buf);
+  serialize(val.second,buf);
+}
+
+template<typename T1, typename T2>
+void deserialize (std::pair<T1,T2>& val, const std::vector<char>& buf, std::size_t& pos) {
+  deserialize(val.first,buf,pos);
+  deserialize(val.second,buf,pos);
+}
+
+namespace impl {
+// Whether serialize/deserialize are available for T
+template<typename T>
+struct is_serializable : std::is_arithmetic<T> {};
+template<>
+struct is_serializable<std::string> : std::true_type {};
+template<>
+struct is_serializable<ParameterList> : std::true_type {};
+template<typename T>
+struct is_serializable<std::vector<T>> : is_serializable<T> {};
+template<typename T>
+struct is_serializable<std::set<T>> : is_serializable<T> {};
+template<typename K, typename V>
+struct is_serializable<std::map<K,V>>
+  : std::integral_constant<bool,is_serializable<K>::value && is_serializable<V>::value> {};
+template<typename T1, typename T2>
+struct is_serializable<std::pair<T1,T2>>
+  : std::integral_constant<bool,is_serializable<T1>::value && is_serializable<T2>::value> {};
+} // namespace impl
+
+} // namespace ekat
+
+#endif // EKAT_SERIALIZE_HPP
@@ -0,0 +1,277 @@
+#include "ekat/logging/ekat_log_aggregate.hpp"
+#include "ekat/io/ekat_serialize.hpp"
+#include "ekat/ekat_assert.hpp"
+
+#include <map>
+#include <tuple>
+
+namespace ekat {
+namespace logger {
+
+namespace {
+
+// Compact list of ranks, such as "rank 4", "ranks 3-17, 40", or "all ranks"
+std::string ranks_str (const std::vector<int>& ranks, const int comm_size)
+{
+  if (static_cast<int>(ranks.size())==comm_size) {
+    return "all ranks";
+  }
+
+  std::string s = ranks.size()==1 ? "rank " : "ranks ";
+  for (std::size_t i=0; i<ranks.size(); ) {
+    std::size_t j = i;
+    while (j+1<ranks.size() && ranks[j+1]==ranks[j]+1) {
+      ++j;
+    }
+    if (i>0) {
+      s += ", ";
+    }
+    s += std::to_string(ranks[i]);
+    if (j>i) {
+      s += "-" + std::to_string(ranks[j]);
+    }
+    i = j+1;
+  }
+  return s;
+}
+
+} // anonymous namespace
+
+std::shared_ptr<AggregatingSink>
+AggregatingSink::create (const Comm& comm, const std::shared_ptr<sink_t>& target)
+{
+  EKAT_REQUIRE_MSG (not comm.am_i_root() || target!=nullptr,
+      "Error! Invalid (null) target sink for AggregatingSink on the root rank.\n");
+
+  std::shared_ptr<AggregatingSink> sink(new AggregatingSink(comm,target));
+
+  // Do not keep the sink alive just for the sake of writing the local messages.
+  // The callback cannot outlive the sink, since the destructor removes it first.
+  AggregatingSink* raw = sink.get();
+  sink->m_flush_callback_id = error::add_flush_callback([raw]() {
+    raw->write_local();
+  });
+  return sink;
+}
+
+AggregatingSink::AggregatingSink (const Comm& comm, const std::shared_ptr<sink_t>& target)
+ : m_comm      (comm.size()>1 ? comm.split(0) : comm)  // Keep our messages apart from the user's
+ , m_owns_comm (comm.size()>1)
+ , m_target    (target)
+{
+  // Nothing to do here
+}
+
+AggregatingSink::~AggregatingSink ()
+{
+  error::remove_flush_callback(m_flush_callback_id);
+
+#ifdef EKAT_ENABLE_MPI
+  int finalized;
+  MPI_Finalized(&finalized);
+  if (finalized) {
+    // Too late to collect the messages (pending requests are just dropped)
+    write_local();
+    return;
+  }
+#endif
+
+  try {
+    sync(true);
+    Comm::Request::wait_all(m_send_reqs[0]);
+    Comm::Request::wait_all(m_send_reqs[1]);
+    if (m_target) {
+      m_target->flush();
+    }
+  } catch (...) {
+    // Nothing we can do
+  }
+  if (m_owns_comm) {
+    m_comm.free_mpi_comm();
+  }
+}
+
+void AggregatingSink::log (const spdlog::details::log_msg& msg)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_batch.loggers.emplace_back(msg.logger_name.data(),msg.logger_name.size());
+  m_batch.levels.push_back(static_cast<int>(msg.level));
+  m_batch.payloads.emplace_back(msg.payload.data(),msg.payload.size());
+}
+
+void AggregatingSink::flush ()
+{
+  if (m_comm.am_i_root()) {
+    m_target->flush();
+  }
+}
+
+void AggregatingSink::set_pattern (const std::string& pattern)
+{
+  if (m_target) {
+    m_target->set_pattern(pattern);
+  }
+}
+
+void AggregatingSink::set_formatter (std::unique_ptr<spdlog::formatter> formatter)
+{
+  if (m_target) {
+    m_target->set_formatter(std::move(formatter));
+  }
+}
+
+void AggregatingSink::sync (const bool wait_all)
+{
+  Batch batch;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::swap(batch,m_batch);
+  }
+
+  const int size = m_comm.size();
+  if (size==1) {
+    write({batch});
+    return;
+  }
+
+  const int root = m_comm.root_rank();
+  if (not m_comm.am_i_root()) {
+    // Reuse the buffer of the batch sent two syncs ago. Root received it at
+    // its previous sync, so this only waits if this rank is ahead of root.
+    const int idx = m_send_idx;
+    m_send_idx = 1-m_send_idx;
+    Comm::Request::wait_all(m_send_reqs[idx]);
+    m_send_reqs[idx].clear();
+
+    auto& buf = m_send_buf[idx];
+    buf.clear();
+    serialize(batch.loggers,buf);
+    serialize(batch.levels,buf);
+    serialize(batch.payloads,buf);
+    m_send_size[idx] = buf.size();
+
+    m_send_reqs[idx].emplace_back(m_comm.isend(&m_send_size[idx],1,root,0));
+    m_send_reqs[idx].emplace_back(m_comm.isend(buf.data(),m_send_size[idx],root,1));
+    return;
+  }
+
+  // Root: write the messages of the previous sync, then start receiving
+  // the ones of this sync
+  if (m_pending) {
+    receive_pending();
+  }
+  m_pending_batch = std::move(batch);
+  m_recv_sizes.resize(size);
+  m_recv_reqs.clear();
+  for (int r=0; r<size; ++r) {
+    if (r!=root) {
+      m_recv_reqs.emplace_back(m_comm.irecv(&m_recv_sizes[r],1,r,0));
+    }
+  }
+  m_pending = true;
+
+  if (wait_all) {
+    receive_pending();
+  }
+}
+
+void AggregatingSink::receive_pending ()
+{
+  // The size messages were posted first, so they also arrive first
+  const int size = m_comm.size();
+  const int root = m_comm.root_rank();
+  Comm::Request::wait_all(m_recv_reqs);
+  m_recv_reqs.clear();
+
+  std::vector<Batch> batches(size);
+  std::vector<char> buf;
+  for (int r=0; r<size; ++r) {
+    if (r==root) {
+      batches[r] = std::move(m_pending_batch);
+      continue;
+    }
+    buf.resize(m_recv_sizes[r]);
+    m_comm.recv(buf.data(),buf.size(),r,1);
+
+    std::size_t pos = 0;
+    deserialize(batches[r].loggers,buf,pos);
+    deserialize(batches[r].levels,buf,pos);
+    deserialize(batches[r].payloads,buf,pos);
+  }
+  m_pending = false;
+
+  write(batches);
+}
+
+void AggregatingSink::write (const std::vector<Batch>& batches)
+{
+  using key_t = std::tuple<std::string,int,std::string>;
+
+  // Distinct messages, in order of first appearance (by rank), with the
+  // ranks that logged them
+  std::map<key_t,int> index;
+  std::vector<const key_t*> msgs;
+  std::vector<std::vector<int>> ranks;
+  for (std::size_t r=0; r<batches.size(); ++r) {
+    const auto& b = batches[r];
+    for (std::size_t i=0; i<b.payloads.size(); ++i) {
+      auto it = index.emplace(key_t(b.loggers[i],b.levels[i],b.payloads[i]),msgs.size()).first;
+      if (it->second==static_cast<int>(msgs.size())) {
+        msgs.push_back(&it->first);
+        ranks.emplace_back();
+      }
+      auto& mr = ranks[it->second];
+      if (mr.empty() || mr.back()!=static_cast<int>(r)) {
+        mr.push_back(r);
+      }
+    }
+  }
+
+  const int size = m_comm.size();
+  std::string payload;
+  for (std::size_t i=0; i<msgs.size(); ++i) {
+    const auto& logger = std::get<0>(*msgs[i]);
+    const auto  level  = static_cast<spdlog::level::level_enum>(std::get<1>(*msgs[i]));
+    payload = std::get<2>(*msgs[i]);
+    if (size>1) {
+      payload += " (" + ranks_str(ranks[i],size) + ")";
+    }
+    m_target->log(spdlog::details::log_msg(logger,level,payload));
+  }
+}
+
+void AggregatingSink::write_local ()
+{
+  Batch batch;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::swap(batch,m_batch);
+  }
+  if (m_comm.am_i_root() && m_pending) {
+    // Root's messages from the last sync were not written yet either
+    auto& p = m_pending_batch;
+    batch.loggers.insert(batch.loggers.begin(),p.loggers.begin(),p.loggers.end());
+    batch.levels.insert(batch.levels.begin(),p.levels.begin(),p.levels.end());
+    batch.payloads.insert(batch.payloads.begin(),p.payloads.begin(),p.payloads.end());
+    p = Batch();
+  }
+  if (not m_target) {
+    return;
+  }
+
+  const std::string rank = m_comm.size()>1
+                         ? " (rank " + std::to_string(m_comm.rank()) + ")"
+                         : "";
+  try {
+    for (std::size_t i=0; i<batch.payloads.size(); ++i) {
+      const auto level = static_cast<spdlog::level::level_enum>(batch.levels[i]);
+      m_target->log(spdlog::details::log_msg(batch.loggers[i],level,batch.payloads[i]+rank));
+    }
+    m_target->flush();
+  } catch (...) {
+    // Nothing we can do
+  }
+}
+
+} // namespace logger
+} // namespace ekat
@@ -0,0 +1,117 @@
+#ifndef EKAT_LOG_AGGREGATE_HPP
+#define EKAT_LOG_AGGREGATE_HPP
+
+#include "ekat/mpi/ekat_comm.hpp"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/sink.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ekat {
+namespace logger {
+
+/*
+ * A sink that collects the messages of all the ranks of a comm on its root,
+ * which writes each distinct message once, followed by the list of ranks that
+ * logged it, as in
+ *
+ *   Negative mass in column 12 (ranks 3-17, 40)
+ *
+ * Messages logged by all ranks end with "(all ranks)". On a single rank,
+ * messages are written as they are.
+ *
+ * Messages are buffered on each rank, and exchanged only by sync, which is
+ * collective. Each rank sends its buffered messages to root without waiting
+ * for them to be received, while root writes the messages collected by the
+ * *previous* call to sync. This way, root only waits for ranks that did not
+ * reach the previous call yet, and other ranks only wait if they are more than
+ * one call ahead of root (they keep two batches in flight). E.g., calling sync
+ * once per time step keeps the logging off the critical path. Call sync(true) to have root wait for
+ * the messages of all ranks, and write them immediately. Since messages are
+ * formatted on root, time stamps (if any) are those of the writing.
+ *
+ * flush does not communicate (spdlog may call it on a single rank), and only
+ * flushes the target sink. If the program aborts (see ekat::error::add_flush_callback),
+ * the messages that this rank did not send yet are written to its target sink,
+ * so they are not lost.
+ *
+ * Create with AggregatingSink::create, which is collective, as is the
+ * destructor (which calls sync(true), unless MPI was already finalized).
+ */
+class AggregatingSink : public spdlog::sinks::sink
+{
+public:
+  using sink_t = spdlog::sinks::sink;
+
+  // The target sink of root gets the aggregated messages. On other ranks,
+  // the target is only used if the program aborts, and can be null.
+  static std::shared_ptr<AggregatingSink>
+  create (const Comm& comm, const std::shared_ptr<sink_t>& target);
+
+  ~AggregatingSink ();
+
+  void log (const spdlog::details::log_msg& msg) override;
+  void flush () override;
+
+  void set_pattern (const std::string& pattern) override;
+  void set_formatter (std::unique_ptr<spdlog::formatter> formatter) override;
+
+  // Collective. See above.
+  void sync (const bool wait_all = false);
+
+  const Comm& get_comm () const { return m_comm; }
+  const std::shared_ptr<sink_t>& get_target () const { return m_target; }
+
+private:
+  AggregatingSink (const Comm& comm, const std::shared_ptr<sink_t>& target);
+
+  // Messages logged on one rank, in order
+  struct Batch {
+    std::vector<std::string>  loggers;
+    std::vector<int>          levels;
+    std::vector<std::string>  payloads;
+  };
+
+  // Root only: write the distinct messages of the batches of all ranks
+  void write (const std::vector<Batch>& batches);
+
+  // Root only: receive the batches announced by the pending size requests
+  void receive_pending ();
+
+  // Write the unsent messages of this rank to its target (on abort)
+  void write_local ();
+
+  // A split of the input comm (if more than one rank), freed on destruction
+  Comm                      m_comm;
+  bool                      m_owns_comm;
+  std::shared_ptr<sink_t>   m_target;
+
+  std::mutex                m_mutex;
+  Batch                     m_batch;
+
+  // Non-root ranks: the last two batches sent, and their requests. A batch is
+  // received by root at its next sync, so a rank only waits on a send if it
+  // is two syncs ahead of root.
+  long long                 m_send_size[2] = {0, 0};
+  std::vector<char>         m_send_buf[2];
+  std::vector<Comm::Request> m_send_reqs[2];
+  int                       m_send_idx = 0;
+
+  // Root: the batch sizes of the other ranks (for the pending sync), and
+  // root's own batch for that same sync
+  std::vector<long long>    m_recv_sizes;
+  std::vector<Comm::Request> m_recv_reqs;
+  Batch                     m_pending_batch;
+  bool                      m_pending = false;
+
+  int                       m_flush_callback_id = -1;
+};
+
+} // namespace logger
+} // namespace ekat
+
+#endif // EKAT_LOG_AGGREGATE_HPP
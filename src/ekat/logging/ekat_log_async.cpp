@@ -0,0 +1,176 @@
+#include "ekat/logging/ekat_log_async.hpp"
+#include "ekat/ekat_assert.hpp"
+
+#include <chrono>
+
+namespace ekat {
+namespace logger {
+
+std::shared_ptr<AsyncSink>
+AsyncSink::create (const std::shared_ptr<sink_t>& target,
+                   const std::size_t queue_size,
+                   const AsyncOverflowPolicy overflow)
+{
+  EKAT_REQUIRE_MSG (target!=nullptr,
+      "Error! Invalid (null) target sink for AsyncSink.\n");
+  EKAT_REQUIRE_MSG (queue_size>0,
+      "Error! Invalid (zero) queue size for AsyncSink.\n");
+
+  std::shared_ptr<AsyncSink> sink(new AsyncSink(target,queue_size,overflow));
+
+  // Do not keep the sink alive just for the sake of flushing it. The callback
+  // cannot outlive the sink, since the destructor removes it first.
+  AsyncSink* raw = sink.get();
+  sink->m_flush_callback_id = error::add_flush_callback([raw]() {
+    raw->flush();
+  });
+  return sink;
+}
+
+AsyncSink::AsyncSink (const std::shared_ptr<sink_t>& target,
+                      const std::size_t queue_size,
+                      const AsyncOverflowPolicy overflow)
+ : m_target   (target)
+ , m_overflow (overflow)
+ , m_queue    (queue_size)
+{
+  m_thread = std::thread(&AsyncSink::run,this);
+}
+
+AsyncSink::~AsyncSink ()
+{
+  // Waits until the callback is not running anymore
+  error::remove_flush_callback(m_flush_callback_id);
+
+  // The background thread writes all the queued messages before exiting.
+  // It never owns the sink, so this does not run on the background thread.
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  m_thread.join();
+
+  try {
+    m_target->flush();
+  } catch (...) {
+    // Nothing we can do
+  }
+}
+
+void AsyncSink::log (const spdlog::details::log_msg& msg)
+{
+  // Count the message before it is visible in the queue, so that flush
+  // waits for it if it started after this call
+  ++m_queued;
+
+  spdlog::details::log_msg_buffer buf(msg);
+  while (true) {
+    // If the queue is full, any message processed after this point frees a slot
+    const auto processed = m_processed.load();
+    if (m_queue.try_push(std::move(buf))) {
+      break;
+    }
+    switch (m_overflow) {
+      case AsyncOverflowPolicy::DropNew:
+        ++m_dropped;
+        ++m_processed;
+        return;
+      case AsyncOverflowPolicy::DropOldest:
+      {
+        spdlog::details::log_msg_buffer oldest;
+        if (m_queue.try_pop(oldest)) {
+          ++m_dropped;
+          ++m_processed;
+        }
+        break;
+      }
+      case AsyncOverflowPolicy::Block:
+      {
+        // Sleep until the background thread processes a message
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_num_blocked;
+        m_cv.notify_all();
+        m_space_cv.wait(lock,[&]() {
+          return m_processed.load()!=processed;
+        });
+        --m_num_blocked;
+        break;
+      }
+    }
+  }
+}
+
+void AsyncSink::flush ()
+{
+  if (std::this_thread::get_id()==m_thread.get_id()) {
+    // Called from the background thread, which writes everything anyways
+    return;
+  }
+
+  const auto target = m_queued.load();
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_processed.load()<target) {
+      m_cv.notify_all();
+      m_cv.wait_for(lock,std::chrono::milliseconds(1));
+    }
+  }
+  m_target->flush();
+}
+
+void AsyncSink::set_pattern (const std::string& pattern)
+{
+  m_target->set_pattern(pattern);
+}
+
+void AsyncSink::set_formatter (std::unique_ptr<spdlog::formatter> formatter)
+{
+  m_target->set_formatter(std::move(formatter));
+}
+
+void AsyncSink::run ()
+{
+  spdlog::details::log_msg_buffer msg;
+  bool written_since_flush = false;
+  while (true) {
+    if (m_queue.try_pop(msg)) {
+      try {
+        m_target->log(msg);
+      } catch (...) {
+        // E.g., a failed write. Do not kill the program for a lost log message.
+      }
+      ++m_processed;
+      written_since_flush = true;
+      if (m_num_blocked.load()>0) {
+        // Lock, so that the notification is not lost by a thread about to wait
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_space_cv.notify_all();
+      }
+      continue;
+    }
+
+    // The queue is (momentarily) empty: flush the target, so that the logs
+    // are not left in some buffer for long
+    if (written_since_flush) {
+      try {
+        m_target->flush();
+      } catch (...) {
+        // Nothing we can do
+      }
+      written_since_flush = false;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.notify_all();  // Wake up threads waiting in flush
+    if (m_stop && m_queue.empty()) {
+      break;
+    }
+    m_cv.wait_for(lock,std::chrono::milliseconds(10),[&]{
+      return m_stop || not m_queue.empty();
+    });
+  }
+}
+
+} // namespace logger
+} // namespace ekat
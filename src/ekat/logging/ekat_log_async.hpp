@@ -0,0 +1,246 @@
+#ifndef EKAT_LOG_ASYNC_HPP
+#define EKAT_LOG_ASYNC_HPP
+
+#include <spdlog/spdlog.h>
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// This file contains an asynchronous sink, and the corresponding LogFilePolicy,
+// which moves the formatting and writing of log messages to a background thread.
+
+namespace ekat {
+namespace logger {
+
+// What to do with a message when the queue of an AsyncSink is full
+enum class AsyncOverflowPolicy {
+  Block,        // Wait until the background thread frees a slot
+  DropOldest,   // Discard the oldest queued message, to make room
+  DropNew       // Discard the new message
+};
+
+namespace impl {
+
+// A bounded, lock-free, multi-producer multi-consumer queue. Each slot has a
+// sequence number, which tells whether the slot is ready to be written or
+// read at a given position, so that producers and consumers only contend on
+// the atomic position counters.
+template<typename T>
+class BoundedQueue
+{
+public:
+  // The capacity is rounded up to a power of 2
+  explicit BoundedQueue (const std::size_t capacity);
+
+  BoundedQueue (const BoundedQueue&) = delete;
+  BoundedQueue& operator= (const BoundedQueue&) = delete;
+
+  std::size_t capacity () const { return m_mask+1; }
+
+  // Return false if the queue is full (empty), without blocking
+  bool try_push (T&& val);
+  bool try_pop (T& val);
+
+  // Only approximate, if other threads push/pop concurrently
+  bool empty () const;
+
+private:
+  struct Slot {
+    std::atomic<std::size_t> seq;
+    T                        val;
+  };
+
+  std::unique_ptr<Slot[]>   m_slots;
+  std::size_t               m_mask;
+
+  // On separate cache lines, to avoid false sharing between producers and consumers
+  alignas(64) std::atomic<std::size_t> m_push_pos;
+  alignas(64) std::atomic<std::size_t> m_pop_pos;
+};
+
+} // namespace impl
+
+/*
+ * A sink that queues copies of the messages, and has a background thread
+ * log them into a target sink. Logging calls only pay for a copy of the
+ * message in the queue, while the background thread does the formatting
+ * and the writing. When the queue is empty, the background thread also
+ * flushes the target sink, so that logs are written out even if the
+ * program is later killed.
+ *
+ * flush() waits until all the messages queued so far are written, and
+ * flushes the target sink. All AsyncSink's are also flushed when the ekat
+ * session is finalized or aborted, and on std::terminate (see
+ * ekat::error::add_flush_callback).
+ *
+ * Create with AsyncSink::create, so that the sink can register itself.
+ */
+class AsyncSink : public spdlog::sinks::sink
+{
+public:
+  using sink_t = spdlog::sinks::sink;
+
+  static std::shared_ptr<AsyncSink>
+  create (const std::shared_ptr<sink_t>& target,
+          const std::size_t queue_size = 8192,
+          const AsyncOverflowPolicy overflow = AsyncOverflowPolicy::Block);
+
+  // Write out all queued messages, and stop the background thread
+  ~AsyncSink ();
+
+  void log (const spdlog::details::log_msg& msg) override;
+  void flush () override;
+
+  // The formatter is the one of the target sink
+  void set_pattern (const std::string& pattern) override;
+  void set_formatter (std::unique_ptr<spdlog::formatter> formatter) override;
+
+  const std::shared_ptr<sink_t>& get_target () const { return m_target; }
+  AsyncOverflowPolicy overflow_policy () const { return m_overflow; }
+
+  // The number of messages discarded because the queue was full
+  std::uint64_t num_dropped () const { return m_dropped.load(); }
+
+private:
+  AsyncSink (const std::shared_ptr<sink_t>& target,
+             const std::size_t queue_size,
+             const AsyncOverflowPolicy overflow);
+
+  // The body of the background thread
+  void run ();
+
+  std::shared_ptr<sink_t>   m_target;
+  AsyncOverflowPolicy       m_overflow;
+
+  impl::BoundedQueue<spdlog::details::log_msg_buffer> m_queue;
+
+  // Messages that were queued, and that were written (or dropped) after being queued
+  std::atomic<std::uint64_t>  m_queued    {0};
+  std::atomic<std::uint64_t>  m_processed {0};
+  std::atomic<std::uint64_t>  m_dropped   {0};
+
+  // Used by the background thread to sleep when the queue is empty,
+  // and by flush to wait for the queue to be processed
+  std::mutex                m_mutex;
+  std::condition_variable   m_cv;
+  bool                      m_stop = false;
+
+  // Used by producers to wait for a free slot (Block policy)
+  std::condition_variable   m_space_cv;
+  std::atomic<int>          m_num_blocked {0};
+
+  int                       m_flush_callback_id = -1;
+
+  std::thread               m_thread;
+};
+
+// Asynchronous file output: same files as FilePolicy, but messages are written
+// by a background thread (see AsyncSink). The console sink is made asynchronous
+// as well. Messages are queued in a queue with QueueSize slots, and the
+// Overflow policy determines what happens when the queue is full.
+template<typename FilePolicy,
+         AsyncOverflowPolicy Overflow = AsyncOverflowPolicy::Block,
+         int QueueSize = 8192>
+struct LogAsync {
+  using sink_t = spdlog::sinks::sink;
+  using file_sink_t = AsyncSink;
+
+  static std::shared_ptr<sink_t> get_file_sink(const std::string& file_name) {
+    return AsyncSink::create(FilePolicy::get_file_sink(file_name),QueueSize,Overflow);
+  }
+
+  static std::shared_ptr<sink_t> wrap_console_sink(const std::shared_ptr<sink_t>& console_sink) {
+    return AsyncSink::create(console_sink,QueueSize,Overflow);
+  }
+};
+
+// ========================== IMPLEMENTATION ========================== //
+
+namespace impl {
+
+template<typename T>
+BoundedQueue<T>::BoundedQueue (const std::size_t capacity)
+{
+  std::size_t n = 2;
+  while (n<capacity) {
+    n *= 2;
+  }
+  m_slots.reset(new Slot[n]);
+  for (std::size_t i=0; i<n; ++i) {
+    m_slots[i].seq.store(i,std::memory_order_relaxed);
+  }
+  m_mask = n-1;
+  m_push_pos.store(0,std::memory_order_relaxed);
+  m_pop_pos.store(0,std::memory_order_relaxed);
+}
+
+template<typename T>
+bool BoundedQueue<T>::try_push (T&& val)
+{
+  // A slot can be written at position pos if its seq is pos. If the seq is
+  // behind, the slot still holds the value from one lap before (queue full).
+  std::size_t pos = m_push_pos.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true) {
+    slot = &m_slots[pos & m_mask];
+    const std::size_t seq = slot->seq.load(std::memory_order_acquire);
+    const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+    if (diff==0) {
+      if (m_push_pos.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff<0) {
+      return false;
+    } else {
+      pos = m_push_pos.load(std::memory_order_relaxed);
+    }
+  }
+  slot->val = std::move(val);
+  slot->seq.store(pos+1,std::memory_order_release);
+  return true;
+}
+
+template<typename T>
+bool BoundedQueue<T>::try_pop (T& val)
+{
+  // A slot can be read at position pos if its seq is pos+1 (i.e., it was written)
+  std::size_t pos = m_pop_pos.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true) {
+    slot = &m_slots[pos & m_mask];
+    const std::size_t seq = slot->seq.load(std::memory_order_acquire);
+    const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos+1);
+    if (diff==0) {
+      if (m_pop_pos.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff<0) {
+      return false;
+    } else {
+      pos = m_pop_pos.load(std::memory_order_relaxed);
+    }
+  }
+  val = std::move(slot->val);
+  slot->seq.store(pos+m_mask+1,std::memory_order_release);
+  return true;
+}
+
+template<typename T>
+bool BoundedQueue<T>::empty () const
+{
+  return m_push_pos.load(std::memory_order_acquire)==m_pop_pos.load(std::memory_order_acquire);
+}
+
+} // namespace impl
+
+} // namespace logger
+} // namespace ekat
+
+#endif // EKAT_LOG_ASYNC_HPP
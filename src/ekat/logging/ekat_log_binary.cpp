@@ -0,0 +1,366 @@
+#include "ekat/logging/ekat_log_binary.hpp"
+#include "ekat/ekat_assert.hpp"
+
+#include <ctime>
+
+#ifndef SPDLOG_FMT_RUNTIME
+#define SPDLOG_FMT_RUNTIME(format_string) format_string
+#endif
+
+namespace ekat {
+namespace logger {
+
+namespace {
+
+constexpr char          binary_magic[8] = {'E','K','A','T','B','L','O','G'};
+constexpr std::uint32_t binary_version  = 2;
+
+
+std::mutex& formats_mutex () {
+  static std::mutex m;
+  return m;
+}
+std::vector<std::string>& formats () {
+  static std::vector<std::string> f = {"{}"};
+  return f;
+}
+
+std::string csv_quote (const std::string& s) {
+  std::string q = "\"";
+  for (const char c : s) {
+    q += c;
+    if (c=='"') {
+      q += '"';
+    }
+  }
+  return q + "\"";
+}
+
+} // anonymous namespace
+
+namespace impl {
+
+std::uint32_t register_binary_format (const char* fmt)
+{
+  std::lock_guard<std::mutex> lock(formats_mutex());
+  formats().emplace_back(fmt);
+  return formats().size()-1;
+}
+
+std::string get_binary_format (const std::uint32_t id)
+{
+  std::lock_guard<std::mutex> lock(formats_mutex());
+  EKAT_REQUIRE_MSG (id<formats().size(),
+      "Error! Invalid binary log format id.\n"
+      "  - id: " + std::to_string(id) + "\n");
+  return formats()[id];
+}
+
+} // namespace impl
+
+// -------------------------- BinaryFileSink -------------------------- //
+
+BinaryFileSink::BinaryFileSink (const std::string& file_name, const int rank,
+                                const BinaryLogClock clock)
+ : m_file_name (file_name)
+ , m_rank      (rank)
+ , m_clock     (clock)
+{
+  m_file = std::fopen(file_name.c_str(),"wb");
+  EKAT_REQUIRE_MSG (m_file!=nullptr,
+      "Error! Could not open binary log file.\n"
+      "  - file name: " + file_name + "\n");
+
+  m_prev_time = impl::binary_log_time(m_clock);
+
+  m_buf.resize(2*impl::binary_buf_size);
+  char* p = m_buf.data();
+  std::memcpy(p,binary_magic,sizeof(binary_magic));
+  p = impl::put_raw(p+sizeof(binary_magic),binary_version);
+  p = impl::put_raw(p,m_prev_time);
+  m_buf_size = p-m_buf.data();
+}
+
+BinaryFileSink::~BinaryFileSink ()
+{
+  try {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    write_buffer();
+  } catch (...) {
+    // Nothing we can do
+  }
+  std::fclose(m_file);
+}
+
+void BinaryFileSink::sink_it_ (const spdlog::details::log_msg& msg)
+{
+  // Already formatted: store with format "{}". The time of msg comes from
+  // another clock, and was read before taking the lock, so we do not use it.
+  char* p = begin_message(impl::binary_log_time(m_clock),msg.level,0,1,
+                          impl::arg_size(std::string())+msg.payload.size());
+  p = impl::put_raw(p,impl::BinaryArgType::String);
+  p = impl::put_string(p,msg.payload.data(),msg.payload.size());
+  end_message(p);
+}
+
+void BinaryFileSink::flush_ ()
+{
+  write_buffer();
+  std::fflush(m_file);
+}
+
+void BinaryFileSink::write_format (const std::uint32_t fmt_id)
+{
+  const auto fmt = impl::get_binary_format(fmt_id);
+  reserve(1+2*impl::max_varint_size+fmt.size());
+
+  char* p = m_buf.data()+m_buf_size;
+  p = impl::put_raw(p,impl::BinaryRecordKind::Format);
+  p = impl::put_varint(p,fmt_id);
+  p = impl::put_string(p,fmt.data(),fmt.size());
+  m_buf_size = p-m_buf.data();
+
+  if (fmt_id>=m_format_written.size()) {
+    m_format_written.resize(fmt_id+1,0);
+  }
+  m_format_written[fmt_id] = 1;
+}
+
+void BinaryFileSink::reserve (const std::size_t n)
+{
+  if (m_buf_size+n>m_buf.size()) {
+    // Only records with very long strings do not fit after binary_buf_size
+    m_buf.resize(m_buf_size+n);
+  }
+}
+
+void BinaryFileSink::write_buffer ()
+{
+  // A failed write (e.g., full disk) loses these records, but does not stop the run
+  if (m_buf_size>0) {
+    std::fwrite(m_buf.data(),1,m_buf_size,m_file);
+    m_buf_size = 0;
+  }
+}
+
+// -------------------------- BinaryLogRecord -------------------------- //
+
+std::string BinaryLogRecord::Arg::str (const std::string& spec) const
+{
+  using impl::BinaryArgType;
+  if (spec.empty()) {
+    switch (type) {
+      case BinaryArgType::Int:    return std::to_string(i);
+      case BinaryArgType::UInt:   return std::to_string(u);
+      case BinaryArgType::Double: return fmt::format("{}",d);
+      case BinaryArgType::String: return s;
+      case BinaryArgType::Bool:   return u ? "true" : "false";
+      case BinaryArgType::Char:   return std::string(1,static_cast<char>(u));
+    }
+  }
+
+  const std::string f = "{:" + spec + "}";
+  switch (type) {
+    case BinaryArgType::Int:    return fmt::format(SPDLOG_FMT_RUNTIME(f),i);
+    case BinaryArgType::UInt:   return fmt::format(SPDLOG_FMT_RUNTIME(f),u);
+    case BinaryArgType::Double: return fmt::format(SPDLOG_FMT_RUNTIME(f),d);
+    case BinaryArgType::String: return fmt::format(SPDLOG_FMT_RUNTIME(f),s);
+    case BinaryArgType::Bool:   return fmt::format(SPDLOG_FMT_RUNTIME(f),u!=0);
+    case BinaryArgType::Char:   return fmt::format(SPDLOG_FMT_RUNTIME(f),static_cast<char>(u));
+  }
+  return "";
+}
+
+std::string BinaryLogRecord::message () const
+{
+  // Replacement fields are "{}", "{idx}", "{:spec}", or "{idx:spec}"
+  std::string msg;
+  std::size_t next_arg = 0;
+  for (std::size_t pos=0; pos<format.size(); ++pos) {
+    const char c = format[pos];
+    if ((c=='{' || c=='}') && pos+1<format.size() && format[pos+1]==c) {
+      msg += c;
+      ++pos;
+      continue;
+    }
+    const auto end = c=='{' ? format.find('}',pos) : std::string::npos;
+    if (end==std::string::npos) {
+      msg += c;
+      continue;
+    }
+
+    const auto field = format.substr(pos+1,end-pos-1);
+    const auto colon = field.find(':');
+    const auto idx_str = field.substr(0,colon);
+    const auto spec = colon==std::string::npos ? "" : field.substr(colon+1);
+    const std::size_t idx = idx_str.empty() ? next_arg++ : std::stoul(idx_str);
+    if (idx<args.size()) {
+      msg += args[idx].str(spec);
+    } else {
+      msg += format.substr(pos,end-pos+1);
+    }
+    pos = end;
+  }
+  return msg;
+}
+
+std::string BinaryLogRecord::to_text () const
+{
+  const auto secs = static_cast<std::time_t>(time_ns/1000000000);
+  const auto ms   = (time_ns/1000000) % 1000;
+  std::tm tm;
+  localtime_r(&secs,&tm);
+  char date[32];
+  std::strftime(date,sizeof(date),"%Y-%m-%d %H:%M:%S",&tm);
+
+  const auto lvl = spdlog::level::to_string_view(level);
+  return fmt::format("[{}.{:03}] [{}] [{}] {}",date,ms,rank,
+                     std::string(lvl.data(),lvl.size()),message());
+}
+
+std::string BinaryLogRecord::to_csv () const
+{
+  const auto lvl = spdlog::level::to_string_view(level);
+  std::string line = std::to_string(time_ns) + "," + std::to_string(rank) + ","
+                   + std::string(lvl.data(),lvl.size()) + "," + csv_quote(message());
+  for (const auto& a : args) {
+    line += ",";
+    line += a.type==impl::BinaryArgType::String ? csv_quote(a.s) : a.str();
+  }
+  return line;
+}
+
+// -------------------------- BinaryLogReader -------------------------- //
+
+BinaryLogReader::BinaryLogReader (const std::string& file_name)
+ : m_file_name (file_name)
+{
+  m_file = std::fopen(file_name.c_str(),"rb");
+  EKAT_REQUIRE_MSG (m_file!=nullptr,
+      "Error! Could not open binary log file.\n"
+      "  - file name: " + file_name + "\n");
+
+  char magic[sizeof(binary_magic)];
+  std::uint32_t version = 0;
+  const bool valid = std::fread(magic,1,sizeof(magic),m_file)==sizeof(magic) &&
+                     std::memcmp(magic,binary_magic,sizeof(magic))==0 &&
+                     std::fread(&version,sizeof(version),1,m_file)==1 &&
+                     std::fread(&m_prev_time,sizeof(m_prev_time),1,m_file)==1;
+  if (not valid || version!=binary_version) {
+    // The destructor will not run
+    std::fclose(m_file);
+  }
+  EKAT_REQUIRE_MSG (valid,
+      "Error! Not a binary log file.\n"
+      "  - file name: " + file_name + "\n");
+  EKAT_REQUIRE_MSG (version==binary_version,
+      "Error! Unsupported binary log file version.\n"
+      "  - file name: " + file_name + "\n"
+      "  - version  : " + std::to_string(version) + "\n"
+      "  - supported: " + std::to_string(binary_version) + "\n");
+}
+
+BinaryLogReader::~BinaryLogReader ()
+{
+  std::fclose(m_file);
+}
+
+bool BinaryLogReader::next (BinaryLogRecord& rec)
+{
+  using impl::BinaryArgType;
+  using impl::BinaryRecordKind;
+
+  while (true) {
+    BinaryRecordKind kind;
+    if (std::fread(&kind,sizeof(kind),1,m_file)!=1) {
+      return false;
+    }
+
+    if (kind==BinaryRecordKind::Format) {
+      const auto id = read_varint();
+      if (id>=m_formats.size()) {
+        m_formats.resize(id+1);
+      }
+      m_formats[id] = read_string();
+      continue;
+    } else if (kind==BinaryRecordKind::Rank) {
+      m_rank = read<std::int32_t>();
+      continue;
+    }
+    EKAT_REQUIRE_MSG (kind==BinaryRecordKind::Message,
+        "Error! Corrupted binary log file (invalid record kind).\n"
+        "  - file name: " + m_file_name + "\n");
+
+    m_prev_time += read_zigzag();
+    rec.time_ns = m_prev_time;
+    rec.rank    = m_rank;
+    rec.level   = static_cast<spdlog::level::level_enum>(read<std::uint8_t>());
+    const auto fmt_id = read_varint();
+    EKAT_REQUIRE_MSG (fmt_id<m_formats.size(),
+        "Error! Corrupted binary log file (undefined format id).\n"
+        "  - file name: " + m_file_name + "\n"
+        "  - format id: " + std::to_string(fmt_id) + "\n");
+    rec.format = m_formats[fmt_id];
+
+    const int nargs = read<std::uint8_t>();
+    rec.args.resize(nargs);
+    for (auto& a : rec.args) {
+      a.type = read<BinaryArgType>();
+      switch (a.type) {
+        case BinaryArgType::Int:    a.i = read_zigzag();          break;
+        case BinaryArgType::UInt:   a.u = read_varint();          break;
+        case BinaryArgType::Double: a.d = read<double>();         break;
+        case BinaryArgType::String: a.s = read_string();          break;
+        case BinaryArgType::Bool:   a.u = read<std::uint8_t>();   break;
+        case BinaryArgType::Char:   a.u = static_cast<unsigned char>(read<char>()); break;
+        default:
+          EKAT_ERROR_MSG ("Error! Corrupted binary log file (invalid argument type).\n"
+                          "  - file name: " + m_file_name + "\n");
+      }
+    }
+    return true;
+  }
+}
+
+template<typename T>
+T BinaryLogReader::read ()
+{
+  T v;
+  EKAT_REQUIRE_MSG (std::fread(&v,sizeof(T),1,m_file)==1,
+      "Error! Truncated binary log file.\n"
+      "  - file name: " + m_file_name + "\n");
+  return v;
+}
+
+std::uint64_t BinaryLogReader::read_varint ()
+{
+  std::uint64_t v = 0;
+  for (int shift=0; shift<64; shift+=7) {
+    const auto byte = read<std::uint8_t>();
+    v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80)==0) {
+      return v;
+    }
+  }
+  EKAT_ERROR_MSG ("Error! Corrupted binary log file (invalid varint).\n"
+                  "  - file name: " + m_file_name + "\n");
+}
+
+std::int64_t BinaryLogReader::read_zigzag ()
+{
+  const auto v = read_varint();
+  return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+std::string BinaryLogReader::read_string ()
+{
+  const auto len = read_varint();
+  std::string s(len,' ');
+  EKAT_REQUIRE_MSG (len==0 || std::fread(&s[0],1,len,m_file)==len,
+      "Error! Truncated binary log file.\n"
+      "  - file name: " + m_file_name + "\n");
+  return s;
+}
+
+} // namespace logger
+} // namespace ekat
@@ -0,0 +1,376 @@
+#ifndef EKAT_LOG_BINARY_HPP
+#define EKAT_LOG_BINARY_HPP
+
+#include "ekat/logging/ekat_log_macros.hpp"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// This file contains a binary sink, and the corresponding LogFilePolicy, for
+// high-frequency logging of numeric data (timings, counters,...), where the
+// cost of formatting text would exceed the cost of the events themselves.
+// The files are rendered offline, as text or CSV, by the ekat-log-decode tool
+// (or with BinaryLogReader).
+//
+// File layout (native endianness; var = LEB128 varint, zz = zigzag varint):
+//   header : "EKATBLOG", u32 version, i64 base time (ns since epoch)
+//   records: u8 kind, followed by
+//     - kind=Format : var id, var length, chars
+//     - kind=Rank   : i32 rank of the following messages
+//     - kind=Message: zz time (ns since the previous message, or since the
+//                     base time), u8 level, var format id, u8 num args, and,
+//                     for each arg, u8 type, followed by the value: zz (Int),
+//                     var (UInt), 8 bytes (Double), 1 byte (Bool, Char),
+//                     or var length and chars (String)
+// Each format string is written once per file, before the first message
+// that uses it. Records are kept small, since writing them out is a large
+// part of the cost of logging.
+
+namespace ekat {
+namespace logger {
+
+// The clock used to time stamp binary records. Reading a precise clock can
+// cost as much as storing the rest of a record, so by default the time stamps
+// come from a coarse clock (with a resolution of a few ms, on Linux), which
+// is much cheaper. Records of a file are stored in order anyways. All the time
+// stamps of a file (including the base time) come from the same clock, read
+// under the lock of the sink, so they never decrease along the file.
+enum class BinaryLogClock {
+  Coarse,   // CLOCK_REALTIME_COARSE where available, system_clock elsewhere
+  Precise   // system_clock
+};
+
+namespace impl {
+
+// Nanoseconds since epoch, according to the given clock
+inline std::int64_t binary_log_time (const BinaryLogClock clock) {
+#ifdef CLOCK_REALTIME_COARSE
+  if (clock==BinaryLogClock::Coarse) {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE,&ts);
+    return static_cast<std::int64_t>(ts.tv_sec)*1000000000 + ts.tv_nsec;
+  }
+#else
+  (void) clock;
+#endif
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+enum class BinaryRecordKind : std::uint8_t {
+  Format  = 0,
+  Message = 1,
+  Rank    = 2
+};
+
+enum class BinaryArgType : std::uint8_t {
+  Int     = 0,
+  UInt    = 1,
+  Double  = 2,
+  String  = 3,
+  Bool    = 4,
+  Char    = 5
+};
+
+// Global registry of format strings. Id 0 is "{}", used for messages that
+// were already formatted (e.g., by logger.info(...)).
+std::uint32_t register_binary_format (const char* fmt);
+std::string get_binary_format (const std::uint32_t id);
+
+// Encoding of the records: each put_xyz writes at p, and returns the end of
+// what was written. The caller must ensure there is room (see arg_size).
+template<typename T>
+char* put_raw (char* p, const T& v) {
+  std::memcpy(p,&v,sizeof(T));
+  return p+sizeof(T);
+}
+
+inline char* put_varint (char* p, std::uint64_t v) {
+  while (v>=0x80) {
+    *p++ = static_cast<char>(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = static_cast<char>(v);
+  return p;
+}
+
+inline char* put_zigzag (char* p, const std::int64_t v) {
+  return put_varint(p,(static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63));
+}
+
+inline char* put_string (char* p, const char* s, const std::size_t len) {
+  p = put_varint(p,len);
+  std::memcpy(p,s,len);
+  return p+len;
+}
+
+// Write the buffer to file once it reaches this size
+constexpr std::size_t binary_buf_size = 64*1024;
+
+// Upper bounds of the size of an encoded arg (type byte included)
+constexpr std::size_t max_varint_size = 10;
+template<typename T>
+constexpr typename std::enable_if<std::is_arithmetic<T>::value,std::size_t>::type
+arg_size (const T) { return 1+max_varint_size; }
+inline std::size_t arg_size (const char* v) { return 1+max_varint_size+std::strlen(v); }
+inline std::size_t arg_size (const std::string& v) { return 1+max_varint_size+v.size(); }
+
+inline char* put_arg (char* p, const bool v) {
+  p = put_raw(p,BinaryArgType::Bool);
+  return put_raw(p,static_cast<std::uint8_t>(v));
+}
+inline char* put_arg (char* p, const char v) {
+  p = put_raw(p,BinaryArgType::Char);
+  return put_raw(p,v);
+}
+inline char* put_arg (char* p, const char* v) {
+  p = put_raw(p,BinaryArgType::String);
+  return put_string(p,v,std::strlen(v));
+}
+inline char* put_arg (char* p, const std::string& v) {
+  p = put_raw(p,BinaryArgType::String);
+  return put_string(p,v.data(),v.size());
+}
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value,char*>::type
+put_arg (char* p, const T v) {
+  p = put_raw(p,BinaryArgType::Int);
+  return put_zigzag(p,static_cast<std::int64_t>(v));
+}
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value,char*>::type
+put_arg (char* p, const T v) {
+  p = put_raw(p,BinaryArgType::UInt);
+  return put_varint(p,static_cast<std::uint64_t>(v));
+}
+template<typename T>
+typename std::enable_if<std::is_floating_point<T>::value,char*>::type
+put_arg (char* p, const T v) {
+  p = put_raw(p,BinaryArgType::Double);
+  return put_raw(p,static_cast<double>(v));
+}
+
+} // namespace impl
+
+/*
+ * A sink writing binary records (see above). Messages logged through the
+ * regular logger interface are stored as text (formatted by spdlog), while
+ * EKAT_LOG_BINARY stores the raw arguments, and the id of the format string,
+ * skipping formatting altogether. Records are buffered, and written to file
+ * when the buffer is full, on flush, and on destruction.
+ */
+class BinaryFileSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+  explicit BinaryFileSink (const std::string& file_name, const int rank = 0,
+                           const BinaryLogClock clock = BinaryLogClock::Coarse);
+  ~BinaryFileSink ();
+
+  // The rank stored in the records
+  void set_rank (const int rank) { m_rank = rank; }
+  int get_rank () const { return m_rank; }
+
+  // The clock for the time stamps of the records (see BinaryLogClock). It is
+  // set at construction, so that a file does not mix clocks.
+  BinaryLogClock get_clock () const { return m_clock; }
+
+  const std::string& get_file_name () const { return m_file_name; }
+
+  // Store a message with the given (registered) format, and its arguments,
+  // unless the level of the sink filters it
+  template<typename... Args>
+  void write (const spdlog::level::level_enum lvl, const std::uint32_t fmt_id,
+              const Args&... args);
+
+protected:
+  void sink_it_ (const spdlog::details::log_msg& msg) override;
+  void flush_ () override;
+
+private:
+  // These must be called with the mutex locked. begin_message makes room for
+  // a message with (at most) the given size of the arguments, writes its
+  // header, and returns where to write the arguments; end_message marks the end.
+  char* begin_message (const std::int64_t time, const spdlog::level::level_enum lvl,
+                       const std::uint32_t fmt_id, const int nargs, const std::size_t args_size);
+  void end_message (char* end);
+  void write_format (const std::uint32_t fmt_id);
+  void reserve (const std::size_t n);
+  void write_buffer ();
+
+  std::string         m_file_name;
+  std::FILE*          m_file = nullptr;
+  int                 m_rank;
+  BinaryLogClock      m_clock;
+
+  // The rank of the last Rank record (none yet, if negative), and the time of
+  // the last message (or the base time)
+  int                 m_rank_written = -1;
+  std::int64_t        m_prev_time;
+
+  // Records not yet written to file are in the first m_buf_size bytes
+  std::vector<char>   m_buf;
+  std::size_t         m_buf_size = 0;
+
+  // Whether each format id was already written to this file
+  std::vector<char>   m_format_written;
+};
+
+// A message read from a binary log file
+struct BinaryLogRecord {
+  struct Arg {
+    impl::BinaryArgType type;
+    std::int64_t  i = 0;
+    std::uint64_t u = 0;
+    double        d = 0;
+    std::string   s;
+
+    std::string str (const std::string& spec = "") const;
+  };
+
+  std::int64_t                time_ns = 0;
+  int                         rank = 0;
+  spdlog::level::level_enum   level = spdlog::level::info;
+  std::string                 format;
+  std::vector<Arg>            args;
+
+  // The formatted message, with fmt-style replacement fields
+  std::string message () const;
+
+  // As in the default spdlog pattern: "[date time] [rank] [level] message"
+  std::string to_text () const;
+
+  // time_ns,rank,level,message,arg0,arg1,...
+  std::string to_csv () const;
+};
+
+// Sequentially read the messages of a binary log file
+class BinaryLogReader
+{
+public:
+  explicit BinaryLogReader (const std::string& file_name);
+  ~BinaryLogReader ();
+
+  // Read the next message. Returns false at the end of the file.
+  bool next (BinaryLogRecord& rec);
+
+private:
+  template<typename T>
+  T read ();
+  std::uint64_t read_varint ();
+  std::int64_t read_zigzag ();
+  std::string read_string ();
+
+  std::string               m_file_name;
+  std::FILE*                m_file = nullptr;
+  std::vector<std::string>  m_formats;
+
+  // The state that messages are encoded against
+  int                       m_rank = 0;
+  std::int64_t              m_prev_time = 0;
+};
+
+// Binary file output (see BinaryFileSink), time stamped with the given clock.
+// The console sink is unaffected.
+template<BinaryLogClock Clock>
+struct LogBinaryFileWithClock {
+  using sink_t = spdlog::sinks::sink;
+  using file_sink_t = BinaryFileSink;
+
+  static std::shared_ptr<sink_t> get_file_sink(const std::string& file_name) {
+    return std::make_shared<file_sink_t>(file_name,0,Clock);
+  }
+};
+using LogBinaryFile = LogBinaryFileWithClock<BinaryLogClock::Coarse>;
+
+// Log a message with LoggerBase::log_binary, which stores the raw arguments if
+// the file sink is a BinaryFileSink. The format string must be a literal, and
+// is registered once per call site. As with the EKAT_LOG_XYZ macros, the
+// arguments are not evaluated if the runtime level filters the message:
+//   EKAT_LOG_BINARY(logger, LogLevel::trace, "step {}: {} took {} s", step, name, dt);
+#define EKAT_LOG_BINARY_FMT_(fmt,...) fmt
+#define EKAT_LOG_BINARY(lgr,lvl,...)                                                      \
+  do {                                                                                    \
+    auto& ekat_logger_ = ekat::logger::impl::deref_logger(lgr);                           \
+    const auto ekat_lvl_ = (lvl);                                                         \
+    if (ekat_logger_.should_log(ekat_lvl_)) {                                             \
+      static const std::uint32_t ekat_fmt_id_ =                                           \
+        ekat::logger::impl::register_binary_format(EKAT_LOG_BINARY_FMT_(__VA_ARGS__,0));  \
+      ekat_logger_.log_binary(ekat_lvl_,ekat_fmt_id_,__VA_ARGS__);                        \
+    }                                                                                     \
+  } while (false)
+
+// ========================== IMPLEMENTATION ========================== //
+
+// begin_message and end_message run for every message, so they are inline;
+// the rare cases (new format, long strings, full buffer) are not
+inline char* BinaryFileSink::begin_message (const std::int64_t time, const spdlog::level::level_enum lvl,
+                                            const std::uint32_t fmt_id, const int nargs,
+                                            const std::size_t args_size)
+{
+  using impl::max_varint_size;
+
+  if (fmt_id>=m_format_written.size() || not m_format_written[fmt_id]) {
+    write_format(fmt_id);
+  }
+
+  constexpr std::size_t rank_size   = 1+4;
+  constexpr std::size_t header_size = 1+max_varint_size+1+max_varint_size+1;
+  reserve(rank_size+header_size+args_size);
+
+  char* p = m_buf.data()+m_buf_size;
+  if (m_rank!=m_rank_written) {
+    p = impl::put_raw(p,impl::BinaryRecordKind::Rank);
+    p = impl::put_raw(p,static_cast<std::int32_t>(m_rank));
+    m_rank_written = m_rank;
+  }
+  p = impl::put_raw(p,impl::BinaryRecordKind::Message);
+  p = impl::put_zigzag(p,time-m_prev_time);
+  p = impl::put_raw(p,static_cast<std::uint8_t>(lvl));
+  p = impl::put_varint(p,fmt_id);
+  p = impl::put_raw(p,static_cast<std::uint8_t>(nargs));
+  m_prev_time = time;
+  return p;
+}
+
+inline void BinaryFileSink::end_message (char* end)
+{
+  m_buf_size = end-m_buf.data();
+  if (m_buf_size>=impl::binary_buf_size) {
+    write_buffer();
+  }
+}
+
+template<typename... Args>
+void BinaryFileSink::write (const spdlog::level::level_enum lvl, const std::uint32_t fmt_id,
+                            const Args&... args)
+{
+  static_assert (sizeof...(Args)<256, "Error! Too many arguments for a binary log message.\n");
+
+  // Same as should_log, which is not inline when spdlog is a compiled library
+  if (lvl<this->level_.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  const std::size_t args_size = (std::size_t(0) + ... + impl::arg_size(args));
+
+  // Read the time under the lock, so that the records of the file are in order
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  char* p = begin_message(impl::binary_log_time(m_clock),lvl,fmt_id,sizeof...(Args),args_size);
+  ((p = impl::put_arg(p,args)), ...);
+  end_message(p);
+}
+
+} // namespace logger
+} // namespace ekat
+
+#endif // EKAT_LOG_BINARY_HPP
@@ -0,0 +1,90 @@
+#include "ekat/logging/ekat_log_binary.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Render binary log files (see ekat_log_binary.hpp) as text or CSV:
+//
+//   ekat-log-decode [--csv] [--merge] file [file...]
+//
+// Records are printed file by file, in the order they were logged. With
+// --merge, the records of all files (e.g., one per rank) are sorted by time.
+
+namespace {
+
+void usage (const char* exe) {
+  std::cerr << "Usage: " << exe << " [--csv] [--merge] file [file...]\n"
+            << "  --csv  : print time_ns,rank,level,message,arg0,arg1,... lines\n"
+            << "  --merge: sort the records of all files by time\n";
+}
+
+} // anonymous namespace
+
+int main (int argc, char** argv)
+{
+  using namespace ekat::logger;
+
+  bool csv = false;
+  bool merge = false;
+  std::vector<std::string> files;
+  for (int i=1; i<argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg=="--csv") {
+      csv = true;
+    } else if (arg=="--merge") {
+      merge = true;
+    } else if (arg=="-h" || arg=="--help") {
+      usage(argv[0]);
+      return 0;
+    } else {
+      files.push_back(arg);
+    }
+  }
+  if (files.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  auto print = [&](const BinaryLogRecord& rec) {
+    std::cout << (csv ? rec.to_csv() : rec.to_text()) << "\n";
+  };
+
+  if (csv) {
+    std::cout << "time_ns,rank,level,message,args\n";
+  }
+
+  int ret = 0;
+  std::vector<BinaryLogRecord> all;
+  for (const auto& f : files) {
+    // Records read before an error (e.g., a file truncated by a crash) are kept
+    try {
+      BinaryLogReader reader(f);
+      BinaryLogRecord rec;
+      while (reader.next(rec)) {
+        if (merge) {
+          all.push_back(rec);
+        } else {
+          print(rec);
+        }
+      }
+    } catch (std::exception& e) {
+      std::cerr << e.what() << "\n";
+      ret = 1;
+    }
+  }
+
+  if (merge) {
+    std::stable_sort(all.begin(),all.end(),
+                     [](const BinaryLogRecord& a, const BinaryLogRecord& b) {
+                       return a.time_ns<b.time_ns;
+                     });
+    for (const auto& rec : all) {
+      print(rec);
+    }
+  }
+
+  return ret;
+}
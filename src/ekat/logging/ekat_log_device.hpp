@@ -0,0 +1,240 @@
+#ifndef EKAT_LOG_DEVICE_HPP
+#define EKAT_LOG_DEVICE_HPP
+
+#include "ekat/logging/ekat_log_binary.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
+#include "ekat/ekat_assert.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <map>
+#include <string>
+
+namespace ekat {
+namespace logger {
+
+// A fixed-size event logged from device code (see DeviceLogBuffer)
+struct DeviceLogRecord {
+  static constexpr int max_vals = 4;
+
+  int     code;     // User-defined event code
+  int     column;   // Column (or any other index) where the event happened
+  int     level;    // A spdlog::level::level_enum
+  int     nvals;
+  double  vals[max_vals];
+};
+
+/*
+ * DeviceLogBuffer lets kernels log events, without the serialization and
+ * interleaving of printf. Kernels append fixed-size records (an event code,
+ * a column index, a level, and up to DeviceLogRecord::max_vals values) to
+ * a device ring buffer, claiming slots with one atomic add. After the
+ * kernels are done, the host drains the buffer into a logger, rendering
+ * each record with the format string registered for its code:
+ *
+ *   enum : int { NegativeMass, Limiter };
+ *   DeviceLogBuffer<> buf("physics");
+ *   buf.register_code(NegativeMass,"negative mass at column {} (level {}): {:.3e}");
+ *   buf.register_code(Limiter,"limiter active at column {}");
+ *   auto dlog = buf.get_device_logger();
+ *   Kokkos::parallel_for(policy, KOKKOS_LAMBDA(const int icol) {
+ *     ...
+ *     if (q<0) dlog.log(LogLevel::warn,NegativeMass,icol,ilev,q);
+ *   });
+ *   buf.drain(logger);
+ *
+ * The format string gets the column, followed by the values. Codes without a
+ * registered format are rendered as "code <code>: column <col>, values ...".
+ *
+ * Records below the level of the buffer (see set_level) are discarded before
+ * touching memory. If more than capacity records are logged between two calls
+ * to drain, the newest ones are dropped, and drain reports how many.
+ * NOTE: drain must not run concurrently with kernels logging to the buffer.
+ */
+
+// The device side of a DeviceLogBuffer: a cheap copy, to be captured by kernels
+template<typename DeviceT=DefaultDevice>
+class DeviceLogger
+{
+public:
+  using Device = DeviceT;
+
+  using KT = KokkosTypes<Device>;
+  using count_t = unsigned long long;
+
+  template <typename S>
+  using view_1d = typename KT::template view_1d<S>;
+
+  DeviceLogger () = default;
+
+  // Append a record. Values are converted to double.
+  template<typename... Vals>
+  KOKKOS_INLINE_FUNCTION
+  void log (const spdlog::level::level_enum lvl, const int code, const int column,
+            const Vals... vals) const;
+
+private:
+  template<typename> friend class DeviceLogBuffer;
+
+  view_1d<DeviceLogRecord>    m_records;
+
+  // Positions (not modulo capacity) of the next record to append, and of the
+  // first record not yet drained
+  view_1d<count_t>            m_counters;
+
+  spdlog::level::level_enum   m_level = spdlog::level::trace;
+};
+
+template<typename DeviceT=DefaultDevice>
+class DeviceLogBuffer
+{
+public:
+  using Device = DeviceT;
+  using device_logger_t = DeviceLogger<Device>;
+  using count_t = typename device_logger_t::count_t;
+
+  explicit DeviceLogBuffer (const std::string& name, const int capacity = 1024);
+
+  // The format for records with the given code
+  void register_code (const int code, const std::string& format);
+
+  // Records with a lower level are discarded on device. This only affects
+  // device loggers obtained afterwards.
+  void set_level (const spdlog::level::level_enum lvl) { m_dev.m_level = lvl; }
+  spdlog::level::level_enum get_level () const { return m_dev.m_level; }
+
+  const device_logger_t& get_device_logger () const { return m_dev; }
+
+  // Log the records appended since the last call into the logger, and
+  // return how many there were (dropped ones included).
+  count_t drain (spdlog::logger& logger);
+
+  const std::string& name () const { return m_name; }
+  int capacity () const { return m_dev.m_records.extent(0); }
+
+private:
+  std::string                 m_name;
+  device_logger_t             m_dev;
+  std::map<int,std::string>   m_formats;
+};
+
+// ========================== IMPLEMENTATION ========================== //
+
+template<typename DeviceT>
+template<typename... Vals>
+KOKKOS_INLINE_FUNCTION
+void DeviceLogger<DeviceT>::
+log (const spdlog::level::level_enum lvl, const int code, const int column,
+     const Vals... vals) const
+{
+  static_assert (sizeof...(Vals)<=DeviceLogRecord::max_vals,
+      "Error! Too many values for a DeviceLogRecord.\n");
+
+  if (lvl<m_level) {
+    return;
+  }
+
+  const count_t cap = m_records.extent(0);
+  const count_t pos = Kokkos::atomic_fetch_add(&m_counters(0),count_t(1));
+  if (pos-m_counters(1)>=cap) {
+    // Full: drain will count the records that were dropped
+    return;
+  }
+
+  auto& rec = m_records(pos % cap);
+  rec.code   = code;
+  rec.column = column;
+  rec.level  = static_cast<int>(lvl);
+  rec.nvals  = sizeof...(Vals);
+  const double v[] = {0, static_cast<double>(vals)...};
+  for (int i=0; i<rec.nvals; ++i) {
+    rec.vals[i] = v[i+1];
+  }
+}
+
+template<typename DeviceT>
+DeviceLogBuffer<DeviceT>::
+DeviceLogBuffer (const std::string& name, const int capacity)
+ : m_name (name)
+{
+  EKAT_REQUIRE_MSG (capacity>0,
+      "Error! Invalid capacity for DeviceLogBuffer.\n"
+      "  - name    : " + name + "\n"
+      "  - capacity: " + std::to_string(capacity) + "\n");
+
+  using records_t  = typename device_logger_t::template view_1d<DeviceLogRecord>;
+  using counters_t = typename device_logger_t::template view_1d<count_t>;
+  m_dev.m_records  = records_t(name + " records",capacity);
+  m_dev.m_counters = counters_t(name + " counters",2);
+}
+
+template<typename DeviceT>
+void DeviceLogBuffer<DeviceT>::
+register_code (const int code, const std::string& format)
+{
+  m_formats[code] = format;
+}
+
+template<typename DeviceT>
+typename DeviceLogBuffer<DeviceT>::count_t
+DeviceLogBuffer<DeviceT>::drain (spdlog::logger& logger)
+{
+  using impl::BinaryArgType;
+
+  // The copy waits for the kernels that may be logging
+  auto counters = Kokkos::create_mirror_view(m_dev.m_counters);
+  Kokkos::deep_copy(counters,m_dev.m_counters);
+  const count_t head = counters(0);
+  const count_t tail = counters(1);
+  if (head==tail) {
+    return 0;
+  }
+
+  const count_t cap = m_dev.m_records.extent(0);
+  const count_t num_logged  = head-tail;
+  const count_t num_written = num_logged<cap ? num_logged : cap;
+
+  auto records = Kokkos::create_mirror_view(m_dev.m_records);
+  Kokkos::deep_copy(records,m_dev.m_records);
+
+  // Render the records as binary log messages, with the column as first arg
+  BinaryLogRecord msg;
+  for (count_t i=0; i<num_written; ++i) {
+    const auto& rec = records((tail+i) % cap);
+
+    msg.args.resize(1+rec.nvals);
+    msg.args[0].type = BinaryArgType::Int;
+    msg.args[0].i = rec.column;
+    for (int j=0; j<rec.nvals; ++j) {
+      msg.args[j+1].type = BinaryArgType::Double;
+      msg.args[j+1].d = rec.vals[j];
+    }
+
+    auto it = m_formats.find(rec.code);
+    if (it!=m_formats.end()) {
+      msg.format = it->second;
+    } else {
+      msg.format = "code " + std::to_string(rec.code) + ": column {}";
+      for (int j=0; j<rec.nvals; ++j) {
+        msg.format += j==0 ? ", values {}" : ", {}";
+      }
+    }
+    logger.log(static_cast<spdlog::level::level_enum>(rec.level),msg.message());
+  }
+
+  if (num_written<num_logged) {
+    logger.warn("DeviceLogBuffer '" + m_name + "': " + std::to_string(num_logged-num_written)
+                + " records dropped (capacity: " + std::to_string(cap) + ").");
+  }
+
+  // Everything logged so far was drained
+  counters(1) = head;
+  Kokkos::deep_copy(m_dev.m_counters,counters);
+
+  return num_logged;
+}
+
+} // namespace logger
+} // namespace ekat
+
+#endif // EKAT_LOG_DEVICE_HPP
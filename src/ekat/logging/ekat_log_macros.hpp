@@ -0,0 +1,105 @@
+#ifndef EKAT_LOG_MACROS_HPP
+#define EKAT_LOG_MACROS_HPP
+
+#include "ekat/ekat_config.h"
+
+#include <spdlog/spdlog.h>
+
+#include <memory>
+
+// This file contains macros for logging with zero cost for filtered messages:
+//
+//   EKAT_LOG_DEBUG(logger, "column {}: T={}", icol, compute_T(icol));
+//
+// The logger can be a logger object (e.g., ekat::logger::Logger<>), or a
+// (smart) pointer to one. Unlike logger.debug(...), the macros
+//  - do not evaluate the arguments (nor format the message) if the runtime
+//    level of the logger filters the message;
+//  - expand to nothing if the level is below EKAT_LOG_ACTIVE_LEVEL, which is
+//    set at configure time (EKAT_LOG_MIN_LEVEL), and can be overridden by
+//    defining it (as one of the EKAT_LOG_LEVEL_XYZ values) before including
+//    this file, or on the compile line.
+// Hence, debug logging can be left in hot loops, and compiled out, or skipped
+// at the cost of a level check, in production builds.
+// NOTE: since the arguments are not always evaluated, they must not have side
+//       effects that the program relies upon.
+
+// Same values as spdlog::level::level_enum
+#define EKAT_LOG_LEVEL_TRACE    0
+#define EKAT_LOG_LEVEL_DEBUG    1
+#define EKAT_LOG_LEVEL_INFO     2
+#define EKAT_LOG_LEVEL_WARN     3
+#define EKAT_LOG_LEVEL_ERROR    4
+#define EKAT_LOG_LEVEL_CRITICAL 5
+#define EKAT_LOG_LEVEL_OFF      6
+
+#ifndef EKAT_LOG_ACTIVE_LEVEL
+#define EKAT_LOG_ACTIVE_LEVEL EKAT_LOG_LEVEL_TRACE
+#endif
+
+namespace ekat {
+namespace logger {
+namespace impl {
+
+template<typename LoggerT>
+LoggerT& deref_logger (LoggerT& l) { return l; }
+template<typename LoggerT>
+LoggerT& deref_logger (LoggerT* l) { return *l; }
+template<typename LoggerT>
+LoggerT& deref_logger (std::shared_ptr<LoggerT>& l) { return *l; }
+template<typename LoggerT>
+LoggerT& deref_logger (const std::shared_ptr<LoggerT>& l) { return *l; }
+
+} // namespace impl
+} // namespace logger
+} // namespace ekat
+
+// Log at the given runtime level (an ekat::logger::LogLevel). Only the runtime
+// level of the logger is checked.
+#define EKAT_LOG(lgr,lvl,...)                                                 \
+  do {                                                                        \
+    auto& ekat_logger_ = ekat::logger::impl::deref_logger(lgr);               \
+    const auto ekat_lvl_ = (lvl);                                             \
+    if (ekat_logger_.should_log(ekat_lvl_)) {                                 \
+      ekat_logger_.log(spdlog::source_loc{__FILE__,__LINE__,SPDLOG_FUNCTION}, \
+                       ekat_lvl_,__VA_ARGS__);                                \
+    }                                                                         \
+  } while (false)
+
+#if EKAT_LOG_ACTIVE_LEVEL <= EKAT_LOG_LEVEL_TRACE
+#define EKAT_LOG_TRACE(lgr,...) EKAT_LOG(lgr,spdlog::level::trace,__VA_ARGS__)
+#else
+#define EKAT_LOG_TRACE(lgr,...) (void)0
+#endif
+
+#if EKAT_LOG_ACTIVE_LEVEL <= EKAT_LOG_LEVEL_DEBUG
+#define EKAT_LOG_DEBUG(lgr,...) EKAT_LOG(lgr,spdlog::level::debug,__VA_ARGS__)
+#else
+#define EKAT_LOG_DEBUG(lgr,...) (void)0
+#endif
+
+#if EKAT_LOG_ACTIVE_LEVEL <= EKAT_LOG_LEVEL_INFO
+#define EKAT_LOG_INFO(lgr,...) EKAT_LOG(lgr,spdlog::level::info,__VA_ARGS__)
+#else
+#define EKAT_LOG_INFO(lgr,...) (void)0
+#endif
+
+#if EKAT_LOG_ACTIVE_LEVEL <= EKAT_LOG_LEVEL_WARN
+#define EKAT_LOG_WARN(lgr,...) EKAT_LOG(lgr,spdlog::level::warn,__VA_ARGS__)
+#else
+#define EKAT_LOG_WARN(lgr,...) (void)0
+#endif
+
+#if EKAT_LOG_ACTIVE_LEVEL <= EKAT_LOG_LEVEL_ERROR
+#define EKAT_LOG_ERROR(lgr,...) EKAT_LOG(lgr,spdlog::level::err,__VA_ARGS__)
+#else
+#define EKAT_LOG_ERROR(lgr,...) (void)0
+#endif
+
+#if EKAT_LOG_ACTIVE_LEVEL <= EKAT_LOG_LEVEL_CRITICAL
+#define EKAT_LOG_CRITICAL(lgr,...) EKAT_LOG(lgr,spdlog::level::critical,__VA_ARGS__)
+#else
+#define EKAT_LOG_CRITICAL(lgr,...) (void)0
+#endif
+
+#endif // EKAT_LOG_MACROS_HPP
@@ -1,6 +1,7 @@
 #ifndef EKAT_LOG_MPI_POLICY_HPP
 #define EKAT_LOG_MPI_POLICY_HPP
 
+#include "ekat/logging/ekat_log_aggregate.hpp"
 #include "ekat/mpi/ekat_comm.hpp"
 
 // This file contains policy classes for choosing the behavior of the ekat
@@ -30,6 +31,23 @@ struct LogRootRank {
   }
 };
 
+// All ranks produce output, which is collected on root (see AggregatingSink).
+// Root writes each distinct message once, with the list of ranks that logged
+// it. Messages are exchanged by LoggerBase::sync, which is collective.
+struct LogAggregated {
+  using sink_t = spdlog::sinks::sink;
+
+  static bool should_log (const Comm& comm) {
+    return comm.am_i_root();
+  }
+  static std::string get_log_name (const std::string& prefix, const Comm& /* comm */) {
+    return prefix;
+  }
+  static std::shared_ptr<sink_t> aggregate_sink (const std::shared_ptr<sink_t>& s, const Comm& comm) {
+    return AggregatingSink::create(comm,s);
+  }
+};
+
 }// namespace logger
 }//  namespace ekat
 
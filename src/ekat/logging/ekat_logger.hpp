@@ -1,7 +1,10 @@
 #ifndef EKAT_LOGGER_HPP
 #define EKAT_LOGGER_HPP
 
+#include "ekat/logging/ekat_log_async.hpp"
+#include "ekat/logging/ekat_log_binary.hpp"
 #include "ekat/logging/ekat_log_file_policy.hpp"
+#include "ekat/logging/ekat_log_macros.hpp"
 #include "ekat/logging/ekat_log_mpi_policy.hpp"
 #include "ekat/mpi/ekat_comm.hpp"
 #include "ekat/ekat_assert.hpp"
@@ -10,12 +13,54 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/null_sink.h>
 
+#include <type_traits>
+
 namespace ekat {
 namespace logger {
 
 // Some common types from spdlog
 using LogLevel = spdlog::level::level_enum;
 
+namespace impl {
+// A LogFilePolicy can optionally wrap the console sink as well (e.g., to make
+// it asynchronous), by implementing wrap_console_sink(shared_ptr<sink>)
+template<typename P, typename = void>
+struct has_console_sink_wrapper : std::false_type {};
+template<typename P>
+struct has_console_sink_wrapper<P,decltype(void(P::wrap_console_sink(std::shared_ptr<spdlog::sinks::sink>())))>
+  : std::true_type {};
+
+template<typename P>
+std::shared_ptr<spdlog::sinks::sink>
+wrap_console_sink (const std::shared_ptr<spdlog::sinks::sink>& s, std::true_type) {
+  return P::wrap_console_sink(s);
+}
+template<typename P>
+std::shared_ptr<spdlog::sinks::sink>
+wrap_console_sink (const std::shared_ptr<spdlog::sinks::sink>& s, std::false_type) {
+  return s;
+}
+
+// A MpiOutputPolicy can optionally collect the output of all ranks on the
+// ranks that should log, by implementing aggregate_sink(shared_ptr<sink>,comm)
+template<typename P, typename = void>
+struct has_sink_aggregator : std::false_type {};
+template<typename P>
+struct has_sink_aggregator<P,decltype(void(P::aggregate_sink(std::shared_ptr<spdlog::sinks::sink>(),std::declval<const Comm&>())))>
+  : std::true_type {};
+
+template<typename P>
+std::shared_ptr<spdlog::sinks::sink>
+aggregate_sink (const std::shared_ptr<spdlog::sinks::sink>& s, const Comm& comm, std::true_type) {
+  return P::aggregate_sink(s,comm);
+}
+template<typename P>
+std::shared_ptr<spdlog::sinks::sink>
+aggregate_sink (const std::shared_ptr<spdlog::sinks::sink>& s, const Comm& /* comm */, std::false_type) {
+  return s;
+}
+} // namespace impl
+
 /* A Logger class customized for console and file output.
 
   Each log has two "sinks" for output: one for the console, and one for file(s).
@@ -23,8 +68,11 @@ using LogLevel = spdlog::level::level_enum;
 
   The Logger class is templated on three policies, that regulate how the two
   sinks behave: LogFilePolicy, MpiOutputPolicy, and LogNamePolicy:
-   - LogFilePolicy: determines what kind of file sink to create
-   - MpiOutputPolicy: determines which ranks can produce output
+   - LogFilePolicy: determines what kind of file sink to create (with
+     LogAsync<P>, the sinks of P are written from a background thread; with
+     LogBinaryFile, see EKAT_LOG_BINARY, the file is written in binary form)
+   - MpiOutputPolicy: determines which ranks can produce output (with
+     LogAggregated, all ranks do, but only root writes, see sync below)
    - LogNamePolicy: determines if MPI rank info enters the file name
 
   Logs have a logging level. Messages with priorities below this level will
@@ -54,6 +102,13 @@ using LogLevel = spdlog::level::level_enum;
   log. Furthermore, if one of the two sinks had level "warn", the first call would
   also not produce any log *in that sink*.
 
+  Notice that the arguments of logger.debug(...) are evaluated even if the message
+  is then filtered. In performance-critical code, use the EKAT_LOG_XYZ macros
+  instead (see ekat_log_macros.hpp), which skip filtered messages entirely:
+    EKAT_LOG_DEBUG(logger, "column {}: T={}", icol, compute_T(icol));
+  Loggers cannot be used inside kernels. To log from device code, use a
+  DeviceLogBuffer (see ekat_log_device.hpp), and drain it into a logger afterwards.
+
   In principle, separate modules, classes, etc. could have their own logger.
   These loggers can share output files; see tests/logger/logger_tests.cpp.
 
@@ -76,6 +131,9 @@ protected:
   std::shared_ptr<sink_t> csink;
   std::shared_ptr<sink_t> fsink;
 
+  // Not null if fsink stores binary records (see log_binary)
+  std::shared_ptr<BinaryFileSink> bsink;
+
   std::string logfile_name;
 
   LoggerBase (const std::string& log_name)
@@ -125,8 +183,56 @@ public:
 
   // The string "%v" is corresponds to "<msg>" only.
   void set_no_format () { set_format("%v"); }
+
+  // Log a message with a format registered with impl::register_binary_format
+  // (use the EKAT_LOG_BINARY macro). If the file sink is a BinaryFileSink, the
+  // message is stored there without formatting. The message is formatted only
+  // if the console sink (or a non-binary file sink) will log it.
+  template<typename... Args>
+  void log_binary (const LogLevel lvl, const std::uint32_t fmt_id,
+                   const char* fmt, const Args&... args);
+
+  // Collective. Send the messages buffered so far to the writing rank, for
+  // sinks that aggregate the output of all ranks (see AggregatingSink).
+  // A no-op for other sinks.
+  void sync (const bool wait_all = false) {
+    for (const auto& s : {csink,fsink}) {
+      if (auto as = std::dynamic_pointer_cast<AggregatingSink>(s)) {
+        as->sync(wait_all);
+      }
+    }
+  }
 };
 
+template<typename... Args>
+void LoggerBase::log_binary (const LogLevel lvl, const std::uint32_t fmt_id,
+                             const char* fmt, const Args&... args)
+{
+  if (not this->should_log(lvl)) {
+    return;
+  }
+  if (bsink) {
+    bsink->write(lvl,fmt_id,args...);
+  }
+
+  const bool to_console = csink->should_log(lvl);
+  const bool to_file    = not bsink && fsink->should_log(lvl);
+  if (to_console || to_file) {
+#ifdef SPDLOG_FMT_RUNTIME
+    const auto payload = fmt::format(SPDLOG_FMT_RUNTIME(fmt),args...);
+#else
+    const auto payload = fmt::format(fmt,args...);
+#endif
+    const spdlog::details::log_msg msg(this->name(),lvl,payload);
+    if (to_console) {
+      csink->log(msg);
+    }
+    if (to_file) {
+      fsink->log(msg);
+    }
+  }
+}
+
 // Concrete class, based on file and mpi policies
 template<typename LogFilePolicy   = LogNoFile,
          typename MpiOutputPolicy = LogRootRank>
@@ -141,7 +247,9 @@ public:
    : LoggerBase(log_name)
   {
     // make the console sink; default console level = log level
-    csink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    csink = impl::wrap_console_sink<LogFilePolicy>(
+                std::make_shared<spdlog::sinks::stdout_color_sink_mt>(),
+                impl::has_console_sink_wrapper<LogFilePolicy>());
 
     // Retrieve log file name (if a file is generated at all) even if
     // this rank should not log, since we might still need to know the
@@ -159,11 +267,23 @@ public:
       // we'd have to cast fsink to LogNoFile::file_sink_t every time.
       fsink->set_level(LogLevel::off);
     }
+
+    // With an aggregating policy, all ranks produce output, which
+    // the sinks collect on the ranks that should log
+    using aggregate = impl::has_sink_aggregator<MpiOutputPolicy>;
+    csink = impl::aggregate_sink<MpiOutputPolicy>(csink,comm,aggregate());
+    fsink = impl::aggregate_sink<MpiOutputPolicy>(fsink,comm,aggregate());
+
     this->sinks().push_back(csink);
     this->sinks().push_back(fsink);
 
+    bsink = std::dynamic_pointer_cast<BinaryFileSink>(fsink);
+    if (bsink) {
+      bsink->set_rank(comm.rank());
+    }
+
     // Set the log level of logger as well as the sinks
-    if (not MpiOutputPolicy::should_log(comm)) {
+    if (not aggregate::value && not MpiOutputPolicy::should_log(comm)) {
       this->set_level(LogLevel::off);
     } else {
       this->set_level(log_level);
@@ -182,12 +302,14 @@ public:
   {
     csink = src.get_console_sink();
     fsink = src.get_file_sink();
+    bsink = std::dynamic_pointer_cast<BinaryFileSink>(fsink);
     this->sinks().push_back(csink);
     this->sinks().push_back(fsink);
 
     // Only set the level of the logger. Do *not* alter the sinks levels,
     // since you are "borrowing" them from another logger
-    if (not MpiOutputPolicy::should_log(comm)) {
+    using aggregate = impl::has_sink_aggregator<MpiOutputPolicy>;
+    if (not aggregate::value && not MpiOutputPolicy::should_log(comm)) {
       this->set_level(LogLevel::off);
     } else {
       this->set_level(log_level);
@@ -0,0 +1,253 @@
+#ifndef EKAT_BATCHED_REDUCTION_HPP
+#define EKAT_BATCHED_REDUCTION_HPP
+
+#include "ekat/mpi/ekat_comm.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
+#include "ekat/ekat_assert.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ekat {
+
+/*
+ * BatchedReduction computes many global reductions (e.g., diagnostics) at once.
+ *
+ * A parallel_reduce into a host scalar fences the device and copies the result
+ * to host, and the following Comm::all_reduce is one more collective. With
+ * dozens of small diagnostics per step, these add up. Instead, kernels store
+ * their local results in one device buffer, without fencing. At the sync point,
+ * reduce copies the whole buffer to host (a single fence and copy), and reduces
+ * it across ranks with one all_reduce per distinct op (entries are grouped by
+ * op in the buffer).
+ *
+ *   BatchedReduction<Real> br(comm);
+ *   const int mass = br.add("mass",MPI_SUM);   // once per entry
+ *   const int tmax = br.add("T max",MPI_MAX);
+ *   br.setup();
+ *   for (int step=0; step<nsteps; ++step) {
+ *     ...
+ *     br.parallel_reduce("mass",policy,mass_functor,mass);   // does not fence
+ *     br.parallel_reduce("T max",policy,tmax_functor,tmax);
+ *     br.reduce();
+ *     print(br.value(mass), br.value(tmax));
+ *   }
+ *
+ * Each entry must be computed on every rank before each call to reduce, either
+ * with parallel_reduce, or by writing the device view returned by entry.
+ * Supported ops are MPI_SUM, MPI_PROD, MPI_MAX, and MPI_MIN.
+ */
+
+template<typename ScalarT, typename DeviceT=DefaultDevice>
+class BatchedReduction
+{
+public:
+  using Scalar = ScalarT;
+  using Device = DeviceT;
+
+  using KT = KokkosTypes<Device>;
+  using MemSpace = typename KT::MemSpace;
+
+  template <typename S>
+  using view_1d = typename KT::template view_1d<S>;
+
+  // A single (device) value, as accepted by the Kokkos reducers
+  using entry_view_t = Kokkos::View<Scalar,MemSpace>;
+
+  explicit BatchedReduction (const Comm& comm);
+
+  BatchedReduction (const BatchedReduction&) = delete;
+  BatchedReduction& operator= (const BatchedReduction&) = delete;
+
+  // Register an entry, reduced across ranks with the given op. All calls must
+  // happen before setup. Returns the id of the entry.
+  int add (const std::string& name, const MPI_Op op);
+
+  // Allocate the buffers
+  void setup ();
+
+  // Launch a Kokkos parallel_reduce of f over the given policy, with the op
+  // of the entry as reducer, storing the local result in the device buffer.
+  // Like any reduction into a view, the call does not fence.
+  template<typename PolicyT, typename FunctorT>
+  void parallel_reduce (const std::string& label, const PolicyT& policy,
+                        const FunctorT& f, const int id) const;
+
+  // The device location of the local value of an entry, for kernels that
+  // compute it in other ways
+  entry_view_t entry (const int id) const;
+
+  // Copy the local values to host, and reduce them across ranks
+  void reduce ();
+
+  // The global value of an entry, as of the last call to reduce
+  Scalar value (const int id) const;
+
+  int num_entries () const { return m_names.size(); }
+  const std::string& name (const int id) const;
+
+  const Comm& get_comm () const { return m_comm; }
+
+private:
+  void check_id (const int id) const;
+
+  Comm    m_comm;
+
+  // Registered entries
+  std::vector<std::string>  m_names;
+  std::vector<MPI_Op>       m_ops;
+
+  // Position of each entry in the buffers
+  std::vector<int>          m_pos;
+
+  // Contiguous ranges of the buffer with the same op
+  struct OpRange {
+    MPI_Op  op;
+    int     begin;
+    int     count;
+  };
+  std::vector<OpRange>      m_op_ranges;
+
+  view_1d<Scalar>                           m_values;
+  typename view_1d<Scalar>::HostMirror      m_values_h;
+
+  bool m_setup_done = false;
+  bool m_reduced    = false;
+};
+
+// ========================== IMPLEMENTATION ========================== //
+
+template<typename ScalarT, typename DeviceT>
+BatchedReduction<ScalarT,DeviceT>::
+BatchedReduction (const Comm& comm)
+ : m_comm (comm)
+{
+  // Nothing to do here
+}
+
+template<typename ScalarT, typename DeviceT>
+int BatchedReduction<ScalarT,DeviceT>::
+add (const std::string& name, const MPI_Op op)
+{
+  EKAT_REQUIRE_MSG (not m_setup_done,
+      "Error! Cannot add entries to a BatchedReduction after setup.\n"
+      "  - entry name: " + name + "\n");
+  EKAT_REQUIRE_MSG (op==MPI_SUM || op==MPI_PROD || op==MPI_MAX || op==MPI_MIN,
+      "Error! Unsupported op in BatchedReduction (must be MPI_SUM, MPI_PROD, MPI_MAX, or MPI_MIN).\n"
+      "  - entry name: " + name + "\n");
+
+  m_names.push_back(name);
+  m_ops.push_back(op);
+  return m_names.size()-1;
+}
+
+template<typename ScalarT, typename DeviceT>
+void BatchedReduction<ScalarT,DeviceT>::setup ()
+{
+  EKAT_REQUIRE_MSG (not m_setup_done,
+      "Error! BatchedReduction::setup was already called.\n");
+
+  // Group the entries by op (in order of first appearance), keeping the
+  // registration order within each op
+  const int n = m_names.size();
+  std::vector<std::vector<int>> ids_by_op;
+  for (int id=0; id<n; ++id) {
+    auto it = std::find_if(m_op_ranges.begin(),m_op_ranges.end(),
+                           [&](const OpRange& r) { return r.op==m_ops[id]; });
+    if (it==m_op_ranges.end()) {
+      m_op_ranges.push_back(OpRange{m_ops[id],0,0});
+      ids_by_op.emplace_back();
+      it = m_op_ranges.end()-1;
+    }
+    ++it->count;
+    ids_by_op[it-m_op_ranges.begin()].push_back(id);
+  }
+  m_pos.resize(n);
+  int pos = 0;
+  for (std::size_t i=0; i<m_op_ranges.size(); ++i) {
+    m_op_ranges[i].begin = pos;
+    for (const int id : ids_by_op[i]) {
+      m_pos[id] = pos++;
+    }
+  }
+
+  m_values   = view_1d<Scalar>("BatchedReduction values",n);
+  m_values_h = Kokkos::create_mirror_view(m_values);
+
+  m_setup_done = true;
+}
+
+template<typename ScalarT, typename DeviceT>
+template<typename PolicyT, typename FunctorT>
+void BatchedReduction<ScalarT,DeviceT>::
+parallel_reduce (const std::string& label, const PolicyT& policy,
+                 const FunctorT& f, const int id) const
+{
+  // MPI_Op is not an integral type in all MPI implementations
+  const auto result = entry(id);
+  const auto op = m_ops[id];
+  if (op==MPI_SUM) {
+    Kokkos::parallel_reduce(label,policy,f,Kokkos::Sum<Scalar,MemSpace>(result));
+  } else if (op==MPI_PROD) {
+    Kokkos::parallel_reduce(label,policy,f,Kokkos::Prod<Scalar,MemSpace>(result));
+  } else if (op==MPI_MAX) {
+    Kokkos::parallel_reduce(label,policy,f,Kokkos::Max<Scalar,MemSpace>(result));
+  } else {
+    Kokkos::parallel_reduce(label,policy,f,Kokkos::Min<Scalar,MemSpace>(result));
+  }
+}
+
+template<typename ScalarT, typename DeviceT>
+typename BatchedReduction<ScalarT,DeviceT>::entry_view_t
+BatchedReduction<ScalarT,DeviceT>::entry (const int id) const
+{
+  EKAT_REQUIRE_MSG (m_setup_done,
+      "Error! BatchedReduction::setup must be called before computing entries.\n");
+  check_id(id);
+  return entry_view_t(m_values.data()+m_pos[id]);
+}
+
+template<typename ScalarT, typename DeviceT>
+void BatchedReduction<ScalarT,DeviceT>::reduce ()
+{
+  EKAT_REQUIRE_MSG (m_setup_done,
+      "Error! BatchedReduction::setup must be called before reduce.\n");
+
+  // The copy waits for all the kernels computing the entries
+  Kokkos::deep_copy(m_values_h,m_values);
+  for (const auto& r : m_op_ranges) {
+    m_comm.all_reduce(m_values_h.data()+r.begin,r.count,r.op);
+  }
+  m_reduced = true;
+}
+
+template<typename ScalarT, typename DeviceT>
+ScalarT BatchedReduction<ScalarT,DeviceT>::value (const int id) const
+{
+  check_id(id);
+  EKAT_REQUIRE_MSG (m_reduced,
+      "Error! BatchedReduction::reduce must be called before accessing values.\n"
+      "  - entry name: " + m_names[id] + "\n");
+  return m_values_h(m_pos[id]);
+}
+
+template<typename ScalarT, typename DeviceT>
+const std::string& BatchedReduction<ScalarT,DeviceT>::name (const int id) const
+{
+  check_id(id);
+  return m_names[id];
+}
+
+template<typename ScalarT, typename DeviceT>
+void BatchedReduction<ScalarT,DeviceT>::check_id (const int id) const
+{
+  EKAT_REQUIRE_MSG (id>=0 && id<num_entries(),
+      "Error! Invalid BatchedReduction entry id.\n"
+      "  - id         : " + std::to_string(id) + "\n"
+      "  - num entries: " + std::to_string(num_entries()) + "\n");
+}
+
+} // namespace ekat
+
+#endif // EKAT_BATCHED_REDUCTION_HPP
@@ -37,12 +37,14 @@ void Comm::reset_mpi_comm (MPI_Comm new_mpi_comm)
 
 void Comm::barrier () const
 {
+  EKAT_COMM_PROFILE_OP(this,"barrier",0,false);
   check_mpi_inited();
   MPI_Barrier(m_mpi_comm);
 }
 
 Comm Comm::split (const int color) const
 {
+  EKAT_COMM_PROFILE_OP(this,"split",0,true);
   check_mpi_inited ();
 
   MPI_Comm new_comm;
@@ -51,6 +53,41 @@ Comm Comm::split (const int color) const
   return Comm(new_comm);
 }
 
+Comm Comm::split_shared () const
+{
+  EKAT_COMM_PROFILE_OP(this,"split_shared",0,true);
+  check_mpi_inited ();
+
+  MPI_Comm new_comm;
+  MPI_Comm_split_type(m_mpi_comm,MPI_COMM_TYPE_SHARED,m_rank,MPI_INFO_NULL,&new_comm);
+
+  return Comm(new_comm);
+}
+
+void Comm::free_mpi_comm ()
+{
+  if (m_mpi_comm==MPI_COMM_WORLD || m_mpi_comm==MPI_COMM_SELF) {
+    return;
+  }
+  int finalized;
+  MPI_Finalized(&finalized);
+  if (not finalized) {
+    MPI_Comm_free(&m_mpi_comm);
+  }
+  m_mpi_comm = MPI_COMM_SELF;
+  m_size = 1;
+  m_rank = 0;
+}
+
+Comm::Request Comm::ibarrier () const
+{
+  EKAT_COMM_PROFILE_OP(this,"ibarrier",0,false);
+  check_mpi_inited();
+  Request req;
+  MPI_Ibarrier(m_mpi_comm,&req.m_mpi_request);
+  return req;
+}
+
 void Comm::check_mpi_inited () const
 {
   int flag;
@@ -58,6 +95,81 @@ void Comm::check_mpi_inited () const
   assert (flag!=0);
 }
 
+// ========================= Comm::Request =========================== //
+
+namespace {
+// After MPI_Finalize, requests can no longer be completed: they are just dropped
+bool mpi_finalized ()
+{
+  int finalized;
+  MPI_Finalized(&finalized);
+  return finalized!=0;
+}
+} // anonymous namespace
+
+Comm::Request::~Request ()
+{
+  if (is_pending()) {
+    wait();
+  }
+}
+
+Comm::Request::Request (Request&& src)
+  : m_mpi_request(src.m_mpi_request)
+{
+  src.m_mpi_request = MPI_REQUEST_NULL;
+}
+
+Comm::Request& Comm::Request::operator= (Request&& src)
+{
+  if (this!=&src) {
+    if (is_pending()) {
+      wait();
+    }
+    m_mpi_request = src.m_mpi_request;
+    src.m_mpi_request = MPI_REQUEST_NULL;
+  }
+  return *this;
+}
+
+void Comm::Request::wait ()
+{
+  EKAT_COMM_PROFILE_OP(nullptr,"wait",0,false);
+  if (mpi_finalized()) {
+    m_mpi_request = MPI_REQUEST_NULL;
+    return;
+  }
+  MPI_Wait(&m_mpi_request,MPI_STATUS_IGNORE);
+}
+
+bool Comm::Request::test ()
+{
+  EKAT_COMM_PROFILE_OP(nullptr,"test",0,false);
+  if (mpi_finalized()) {
+    m_mpi_request = MPI_REQUEST_NULL;
+    return true;
+  }
+  int flag;
+  MPI_Test(&m_mpi_request,&flag,MPI_STATUS_IGNORE);
+  return flag!=0;
+}
+
+void Comm::Request::wait_all (std::vector<Request>& requests)
+{
+  EKAT_COMM_PROFILE_OP(nullptr,"wait_all",0,false);
+  if (not mpi_finalized()) {
+    std::vector<MPI_Request> mpi_requests;
+    mpi_requests.reserve(requests.size());
+    for (const auto& r : requests) {
+      mpi_requests.push_back(r.m_mpi_request);
+    }
+    MPI_Waitall(mpi_requests.size(),mpi_requests.data(),MPI_STATUSES_IGNORE);
+  }
+  for (auto& r : requests) {
+    r.m_mpi_request = MPI_REQUEST_NULL;
+  }
+}
+
 template<>
 MPI_Datatype get_mpi_type <char> () {
   return MPI_CHAR;
@@ -2,8 +2,18 @@
 #define EKAT_COMM_HPP
 
 #include <ekat/ekat_config.h>
+#include "ekat/mpi/ekat_comm_profiler.hpp"
+#include "ekat/io/ekat_serialize.hpp"
+#include "ekat/ekat_scalar_traits.hpp"
+#include "ekat/ekat_assert.hpp"
 
+#include <Kokkos_Core.hpp>
+
+#include <limits>
+#include <mutex>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #ifdef EKAT_ENABLE_MPI
 #include <mpi.h>
@@ -43,11 +53,26 @@ enum MPI_Op {
   MPI_MAXLOC,
   MPI_REPLACE,
 };
+enum MPI_Request {
+  MPI_REQUEST_NULL
+};
+#include "ekat/mpi/ekat_thread_group.hpp"
 #endif
 
 namespace ekat
 {
 
+namespace impl {
+template<typename ViewT, typename T = void>
+using enable_if_view_t = typename std::enable_if<Kokkos::is_view<ViewT>::value,T>::type;
+
+// A contiguous view with the same data type and device as ViewT
+template<typename ViewT>
+using contiguous_view_t = Kokkos::View<typename ViewT::non_const_data_type,
+                                       Kokkos::LayoutRight,
+                                       typename ViewT::device_type>;
+} // namespace impl
+
 // A small wrapper around an MPI_Comm, together with its rank/size
 
 // NOTE: this class checks that MPI is already init-ed, and errors out
@@ -58,6 +83,53 @@ class Comm
 {
 public:
 
+  // A handle to a pending nonblocking operation. The operation is completed
+  // (and the handle becomes null) by a successful call to wait or test.
+  // Requests cannot be copied, and the destructor waits on pending requests,
+  // so that the buffers passed to the nonblocking call can be safely released
+  // once the request goes out of scope.
+  // NOTE: the buffers passed to the nonblocking call must NOT be read or
+  //       modified until the operation is completed.
+  class Request
+  {
+  public:
+    Request () = default;
+    ~Request ();
+
+    Request (const Request&) = delete;
+    Request& operator= (const Request&) = delete;
+
+    Request (Request&& src);
+    Request& operator= (Request&& src);
+
+    // Block until the operation is completed. After MPI_Finalize, pending
+    // requests are dropped instead (by these, and by the destructor).
+    void wait ();
+
+    // Check if the operation is completed, without blocking
+    bool test ();
+
+    bool is_pending () const {
+#ifdef EKAT_ENABLE_MPI
+      return m_mpi_request!=MPI_REQUEST_NULL;
+#else
+      return m_recv!=nullptr;
+#endif
+    }
+
+    // Wait on all the given requests
+    static void wait_all (std::vector<Request>& requests);
+
+  private:
+    friend class Comm;
+
+    MPI_Request m_mpi_request = MPI_REQUEST_NULL;
+#ifndef EKAT_ENABLE_MPI
+    // With thread ranks, only receives and collectives can be pending
+    std::shared_ptr<impl::ThreadRecv> m_recv;
+#endif
+  };
+
   // The default comm creates a wrapper to MPI_COMM_SELF, rather than MPI_COMM_WORLD,
   // because it is safer to assume I'm the only proc in the comm rather than assuming
   // that the whole world is in my group.
@@ -110,57 +182,282 @@ public:
 
   void barrier () const;
 
+  // Reproducible sums: sums[j] is the sum, over all ranks, of the count values
+  // my_vals[j*count+i], i=0,...,count-1 (count can differ across ranks). The
+  // result is bitwise identical for any number of ranks, and any distribution
+  // or ordering of the summands. Summands are converted to fixed point numbers
+  // (relative to the largest summand), which are added exactly as integers.
+  // The error is below 2^-127 times the largest summand, times the number of
+  // summands, and the cost is two all_reduce's of a few values per sum (plus
+  // a third one, of one value per sum, if any summand is not finite).
+  void reproducible_sum (const double* my_vals, double* sums,
+                         const int count, const int nsums = 1) const;
+
+  // Overloads of the collectives above for Kokkos views, of any rank and
+  // layout. Values can be arithmetic types or ekat::Pack's; a pack is
+  // communicated as its N scalars, so reductions act on each entry.
+  // Views that are host-accessible and contiguous are handed to MPI as they
+  // are, while all others are staged through contiguous host buffers.
+  template<typename ViewT>
+  impl::enable_if_view_t<ViewT>
+  broadcast (const ViewT& vals, const int root) const;
+
+  // Overload for objects supported by serialize/deserialize (see ekat_serialize.hpp),
+  // such as strings, STL containers, or ParameterList's (e.g., root can parse an
+  // input file, and broadcast the result). The object is serialized on root,
+  // and its bytes are sent with two broadcasts (the size, then the data).
+  template<typename T>
+  typename std::enable_if<impl::is_serializable<T>::value>::type
+  broadcast (T& obj, const int root) const;
+
+  template<typename SrcView, typename DstView>
+  impl::enable_if_view_t<SrcView>
+  scan (const SrcView& my_vals, const DstView& result, const MPI_Op op) const;
+
+  template<typename SrcView, typename DstView>
+  impl::enable_if_view_t<SrcView>
+  all_reduce (const SrcView& my_vals, const DstView& result, const MPI_Op op) const;
+
+  // The entries of all_vals are those of my_vals from rank 0, then from rank 1,
+  // and so on (e.g., all_vals can have one more leading dimension than my_vals)
+  template<typename SrcView, typename DstView>
+  impl::enable_if_view_t<SrcView>
+  all_gather (const SrcView& my_vals, const DstView& all_vals) const;
+
+  template<typename ViewT>
+  impl::enable_if_view_t<ViewT>
+  scan (const ViewT& inout_vals, const MPI_Op op) const;
+
+  template<typename ViewT>
+  impl::enable_if_view_t<ViewT>
+  all_reduce (const ViewT& inout_vals, const MPI_Op op) const;
+
+  // Variable-count collectives. Each rank only provides its own counts: the
+  // other counts, and all displacements, are computed internally (with one
+  // more collective, on the counts). The values from/to the different ranks
+  // are contiguous, in rank order. If counts (or recv_counts) is not null, it
+  // is filled with the number of values from each rank, on receiving ranks.
+
+  // Root gets the values of all ranks (the other ranks get nothing)
+  template<typename T>
+  std::vector<T> gatherv (const T* my_vals, const int my_count, const int root,
+                          std::vector<int>* counts = nullptr) const;
+
+  // All ranks get the values of all ranks
+  template<typename T>
+  std::vector<T> all_gatherv (const T* my_vals, const int my_count,
+                              std::vector<int>* counts = nullptr) const;
+
+  // Root sends counts[r] of all_vals to rank r (inputs are only used on root)
+  template<typename T>
+  std::vector<T> scatterv (const T* all_vals, const std::vector<int>& counts,
+                           const int root) const;
+
+  // Each rank sends send_counts[r] of send_vals to rank r
+  template<typename T>
+  std::vector<T> all_to_allv (const T* send_vals, const std::vector<int>& send_counts,
+                              std::vector<int>* recv_counts = nullptr) const;
+
+  // Front ends of the above for std::vector
+  template<typename T>
+  std::vector<T> gatherv (const std::vector<T>& my_vals, const int root,
+                          std::vector<int>* counts = nullptr) const {
+    return gatherv(my_vals.data(),my_vals.size(),root,counts);
+  }
+
+  template<typename T>
+  std::vector<T> all_gatherv (const std::vector<T>& my_vals,
+                              std::vector<int>* counts = nullptr) const {
+    return all_gatherv(my_vals.data(),my_vals.size(),counts);
+  }
+
+  template<typename T>
+  std::vector<T> scatterv (const std::vector<T>& all_vals, const std::vector<int>& counts,
+                           const int root) const {
+    return scatterv(all_vals.data(),counts,root);
+  }
+
+  template<typename T>
+  std::vector<T> all_to_allv (const std::vector<T>& send_vals, const std::vector<int>& send_counts,
+                              std::vector<int>* recv_counts = nullptr) const {
+    return all_to_allv(send_vals.data(),send_counts,recv_counts);
+  }
+
+  // Front ends of the above for Kokkos views (any rank and layout, values of
+  // arithmetic or Pack type). The variable count is the leading extent, while
+  // the other extents must be the same on all ranks, and counts are in units
+  // of the leading index. The output is a contiguous view on the same device.
+  // For scatterv, the input on non-root ranks is only used for its extents.
+  template<typename ViewT>
+  impl::enable_if_view_t<ViewT,impl::contiguous_view_t<ViewT>>
+  gatherv (const ViewT& my_vals, const int root, std::vector<int>* counts = nullptr) const;
+
+  template<typename ViewT>
+  impl::enable_if_view_t<ViewT,impl::contiguous_view_t<ViewT>>
+  all_gatherv (const ViewT& my_vals, std::vector<int>* counts = nullptr) const;
+
+  template<typename ViewT>
+  impl::enable_if_view_t<ViewT,impl::contiguous_view_t<ViewT>>
+  scatterv (const ViewT& all_vals, const std::vector<int>& counts, const int root) const;
+
+  template<typename ViewT>
+  impl::enable_if_view_t<ViewT,impl::contiguous_view_t<ViewT>>
+  all_to_allv (const ViewT& send_vals, const std::vector<int>& send_counts,
+               std::vector<int>* recv_counts = nullptr) const;
+
+  // Nonblocking versions of the collectives above. See Request for the rules
+  // on the lifetime of the buffers.
+  template<typename T>
+  Request ibroadcast (T* vals, const int count, const int root) const;
+
+  template<typename T>
+  Request iall_reduce (const T* my_vals, T* result, const int count, const MPI_Op op) const;
+
+  template<typename T>
+  Request iall_reduce (T* inout_vals, const int count, const MPI_Op op) const;
+
+  template<typename T>
+  Request iall_gather (const T* my_vals, T* all_vals, const int count) const;
+
+  template<typename T>
+  Request iall_gather (T* all_vals, const int count) const;
+
+  Request ibarrier () const;
+
+  // Point-to-point communication with another rank of this comm. Messages
+  // from the same rank with the same tag are received in the order they
+  // were sent. These require MPI support (or thread ranks, see run_on_thread_ranks),
+  // even on a single rank.
+  template<typename T>
+  void send (const T* vals, const int count, const int dest, const int tag = 0) const;
+
+  template<typename T>
+  void recv (T* vals, const int count, const int src, const int tag = 0) const;
+
+  // Nonblocking versions of send/recv. See Request for the rules on the
+  // lifetime of the buffers.
+  template<typename T>
+  Request isend (const T* vals, const int count, const int dest, const int tag = 0) const;
+
+  template<typename T>
+  Request irecv (T* vals, const int count, const int src, const int tag = 0) const;
+
   Comm split (const int color) const;
+
+  // Split this comm in groups of ranks that can share memory (i.e., one
+  // group per node). Within each group, ranks keep their relative order.
+  Comm split_shared () const;
+
+  // Free the MPI comm, which must have been created by split/split_shared
+  // (comms are not reference counted: copies of this comm become invalid too).
+  // Does nothing for MPI_COMM_WORLD/MPI_COMM_SELF, or if MPI is finalized.
+  // Afterwards, this comm wraps MPI_COMM_SELF.
+  void free_mpi_comm ();
 private:
 
   // Checks (with an assert) that MPI is already init-ed.
   void check_mpi_inited () const;
 
+  // Implementation of the variable-count collectives. Counts are in units of
+  // T, and alloc(n) must return a buffer for the n values to be received.
+  template<typename T, typename Alloc>
+  void gatherv_impl (const T* my_vals, const int my_count, const int root,
+                     std::vector<int>& counts, const Alloc& alloc) const;
+  template<typename T, typename Alloc>
+  void all_gatherv_impl (const T* my_vals, const int my_count,
+                         std::vector<int>& counts, const Alloc& alloc) const;
+  template<typename T, typename Alloc>
+  void scatterv_impl (const T* all_vals, const std::vector<int>& counts,
+                      const int root, const Alloc& alloc) const;
+  template<typename T, typename Alloc>
+  void all_to_allv_impl (const T* send_vals, const std::vector<int>& send_counts,
+                         std::vector<int>& recv_counts, const Alloc& alloc) const;
+
   MPI_Comm  m_mpi_comm;
 
   int       m_size;
   int       m_rank;
+
+#ifndef EKAT_ENABLE_MPI
+  // The ranks of this comm, if they run as threads (see run_on_thread_ranks).
+  // It is null if the comm has a single rank.
+  std::shared_ptr<impl::ThreadGroup> m_group;
+#endif
 };
 
 template<typename T>
 MPI_Datatype get_mpi_type ();
 
+#ifndef EKAT_ENABLE_MPI
+// Run f on nranks concurrent threads of this process, each acting as one rank
+// of MPI_COMM_WORLD: the comm passed to f, as well as any Comm(MPI_COMM_WORLD)
+// created by f, spans all the threads. This allows running multi-rank code
+// without MPI (e.g., in unit tests). Comm operations are done via shared
+// memory. As with MPI, nonblocking collectives do not wait for the other ranks,
+// and complete (on wait/test) once all ranks posted them.
+// If f throws on some rank, the other ranks throw at their next communication,
+// and the first exception is rethrown once all threads are joined.
+// NOTE: mpi_comm() is not meaningful for comms obtained by splitting a comm
+//       of thread ranks, and should not be used to build other comms.
+// NOTE: Kokkos does not support launching work from several threads at once.
+//       The view overloads of Comm take care of this for the copies they do,
+//       but any other Kokkos call that f makes must not run concurrently on
+//       several ranks (e.g., guard it with impl::thread_kokkos_mutex()).
+void run_on_thread_ranks (const int nranks, const std::function<void(const Comm&)>& f);
+#endif
+
 // ========================= IMPLEMENTATION =========================== //
 
 template<typename T>
 void Comm::broadcast (T* vals, const int count, const int root) const
 {
+  EKAT_COMM_PROFILE_OP(this,"broadcast",count*sizeof(T),true);
 #ifdef EKAT_ENABLE_MPI
   check_mpi_inited();
   MPI_Bcast(vals,count,get_mpi_type<T>(),root,m_mpi_comm);
+#else
+  if (m_group) {
+    m_group->broadcast(m_rank,vals,count,root);
+  }
 #endif
 }
 
 template<typename T>
 void Comm::scan (const T* my_vals, T* result, const int count, const MPI_Op op) const
 {
+  EKAT_COMM_PROFILE_OP(this,"scan",count*sizeof(T),true);
 #ifdef EKAT_ENABLE_MPI
   check_mpi_inited();
   MPI_Scan(my_vals,result,count,get_mpi_type<T>(),op,m_mpi_comm);
 #else
-  std::copy(my_vals, my_vals + count, result);
+  if (m_group) {
+    m_group->reduce(m_rank,my_vals,result,count,op,true);
+  } else {
+    std::copy(my_vals, my_vals + count, result);
+  }
 #endif
 }
 
 template<typename T>
 void Comm::all_reduce (const T* my_vals, T* result, const int count, const MPI_Op op) const
 {
+  EKAT_COMM_PROFILE_OP(this,"all_reduce",count*sizeof(T),true);
 #ifdef EKAT_ENABLE_MPI
   check_mpi_inited();
   MPI_Allreduce(my_vals,result,count,get_mpi_type<T>(),op,m_mpi_comm);
 #else
-  std::copy(my_vals, my_vals + count, result);
+  if (m_group) {
+    m_group->reduce(m_rank,my_vals,result,count,op,false);
+  } else {
+    std::copy(my_vals, my_vals + count, result);
+  }
 #endif
 }
 
 template<typename T>
 void Comm::all_gather (const T* my_vals, T* all_vals, const int count) const
 {
+  EKAT_COMM_PROFILE_OP(this,"all_gather",count*sizeof(T),true);
 #ifdef EKAT_ENABLE_MPI
   check_mpi_inited();
   auto mpi_type = get_mpi_type<T>();
@@ -168,40 +465,735 @@ void Comm::all_gather (const T* my_vals, T* all_vals, const int count) const
                 all_vals,count,mpi_type,
                 m_mpi_comm);
 #else
-  std::copy(my_vals, my_vals + count, all_vals);
+  if (m_group) {
+    m_group->all_gather(m_rank,my_vals,all_vals,count);
+  } else {
+    std::copy(my_vals, my_vals + count, all_vals);
+  }
 #endif
 }
 
 template<typename T>
 void Comm::scan (T* inout_vals, const int count, const MPI_Op op) const
 {
+  EKAT_COMM_PROFILE_OP(this,"scan",count*sizeof(T),true);
 #ifdef EKAT_ENABLE_MPI
   check_mpi_inited();
   MPI_Scan(MPI_IN_PLACE,inout_vals,count,get_mpi_type<T>(),op,m_mpi_comm);
+#else
+  if (m_group) {
+    m_group->reduce(m_rank,inout_vals,inout_vals,count,op,true);
+  }
 #endif
 }
 
 template<typename T>
 void Comm::all_reduce (T* inout_vals, const int count, const MPI_Op op) const
 {
+  EKAT_COMM_PROFILE_OP(this,"all_reduce",count*sizeof(T),true);
 #ifdef EKAT_ENABLE_MPI
   check_mpi_inited();
   MPI_Allreduce(MPI_IN_PLACE,inout_vals,count,get_mpi_type<T>(),op,m_mpi_comm);
+#else
+  if (m_group) {
+    m_group->reduce(m_rank,inout_vals,inout_vals,count,op,false);
+  }
 #endif
 }
 
 template<typename T>
 void Comm::all_gather (T* inout_vals, const int count) const
 {
+  EKAT_COMM_PROFILE_OP(this,"all_gather",count*sizeof(T),true);
 #ifdef EKAT_ENABLE_MPI
   check_mpi_inited();
   auto mpi_type = get_mpi_type<T>();
   MPI_Allgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
                 inout_vals,count,mpi_type,
                 m_mpi_comm);
+#else
+  if (m_group) {
+    m_group->all_gather(m_rank,inout_vals+m_rank*count,inout_vals,count);
+  }
+#endif
+}
+
+namespace impl {
+
+// The scalar type making up the values of a view, and the number of scalars in it
+template<typename ViewT>
+using comm_scalar_t = typename ScalarTraits<typename ViewT::non_const_value_type>::scalar_type;
+
+template<typename ViewT>
+int comm_count (const ViewT& v) {
+  using value_t = typename ViewT::non_const_value_type;
+  static_assert (sizeof(value_t) % sizeof(comm_scalar_t<ViewT>) == 0,
+      "Error! View values must be made of a whole number of scalars.\n");
+  return v.size() * (sizeof(value_t) / sizeof(comm_scalar_t<ViewT>));
+}
+
+// The Kokkos calls of the view overloads (allocations and copies) must not run
+// concurrently on thread ranks (see thread_kokkos_mutex). The returned lock is
+// only engaged on thread ranks, and must never be held during communication.
+inline std::unique_lock<std::mutex> lock_kokkos_for_comm ()
+{
+#ifndef EKAT_ENABLE_MPI
+  if (thread_world().group) {
+    return std::unique_lock<std::mutex>(thread_kokkos_mutex());
+  }
+#endif
+  return std::unique_lock<std::mutex>();
+}
+
+template<typename ViewT, typename ContigT>
+void copy_back (const ViewT& v, const ContigT& contig, std::false_type /* const values */) {
+  Kokkos::deep_copy(v,contig);
+}
+template<typename ViewT, typename ContigT>
+void copy_back (const ViewT&, const ContigT&, std::true_type /* const values */) {
+  // Read-only views are never written back
+}
+
+// Call f with a pointer to the scalars of v, in contiguous host memory. If v
+// does not qualify, its entries are staged through a contiguous host copy,
+// copied from v before the call if copy_in=true, and back into v after the
+// call if copy_out=true.
+template<typename ViewT, typename F>
+void with_host_data (const ViewT& v, const bool copy_in, const bool copy_out, const F& f)
+{
+  using value_t  = typename ViewT::value_type;
+  using scalar_t = comm_scalar_t<ViewT>;
+
+  constexpr bool host_accessible =
+    Kokkos::SpaceAccessibility<Kokkos::HostSpace,typename ViewT::memory_space>::accessible;
+  if (host_accessible && v.span_is_contiguous()) {
+    // MPI does not write into buffers that are only read, so casting away const is safe
+    f(reinterpret_cast<scalar_t*>(const_cast<typename ViewT::non_const_value_type*>(v.data())));
+    return;
+  }
+
+  // Get a contiguous copy in v's own space first, since copies between spaces
+  // require views with the same (contiguous) layout
+  using contig_t = contiguous_view_t<ViewT>;
+  const Kokkos::LayoutRight layout (v.extent(0),v.extent(1),v.extent(2),v.extent(3),
+                                    v.extent(4),v.extent(5),v.extent(6),v.extent(7));
+  contig_t contig;
+  typename contig_t::HostMirror host;
+  {
+    const auto lock = lock_kokkos_for_comm();
+    contig = contig_t(Kokkos::view_alloc("ekat::Comm staging",Kokkos::WithoutInitializing),layout);
+    host = Kokkos::create_mirror_view(Kokkos::WithoutInitializing,contig);
+    if (copy_in) {
+      Kokkos::deep_copy(contig,v);
+      Kokkos::deep_copy(host,contig);
+    }
+  }
+
+  f(reinterpret_cast<scalar_t*>(host.data()));
+
+  if (copy_out) {
+    const auto lock = lock_kokkos_for_comm();
+    Kokkos::deep_copy(contig,host);
+    copy_back(v,contig,std::is_const<value_t>());
+  }
+}
+
+// Number of scalars in a slice v(i,...) of v
+template<typename ViewT>
+int comm_row_count (const ViewT& v) {
+  using value_t = typename ViewT::non_const_value_type;
+  int n = sizeof(value_t) / sizeof(comm_scalar_t<ViewT>);
+  for (int i=1; i<ViewT::rank; ++i) {
+    n *= v.extent_int(i);
+  }
+  return n;
+}
+
+// Displacements of contiguous chunks with the given counts. Returns the total count.
+inline int displacements (const std::vector<int>& counts, std::vector<int>& displs)
+{
+  displs.resize(counts.size());
+  long long total = 0;
+  for (size_t i=0; i<counts.size(); ++i) {
+    EKAT_REQUIRE_MSG (counts[i]>=0,
+        "Error! Invalid (negative) count in variable-count collective.\n");
+    displs[i] = total;
+    total += counts[i];
+  }
+  EKAT_REQUIRE_MSG (total<=std::numeric_limits<int>::max(),
+      "Error! Total count of variable-count collective does not fit in an int.\n");
+  return total;
+}
+
+// The sum of the counts (for profiling, before counts are checked)
+inline long long total_count (const std::vector<int>& counts)
+{
+  long long total = 0;
+  for (auto c : counts) {
+    total += c;
+  }
+  return total;
+}
+
+// A contiguous view with the same trailing extents as v, and extent n along
+// the first index, together with its host mirror. Both are left uninitialized,
+// since they are always filled with the received values.
+template<typename ViewT>
+std::pair<contiguous_view_t<ViewT>,typename contiguous_view_t<ViewT>::HostMirror>
+alloc_like (const ViewT& v, const int n)
+{
+  static_assert (ViewT::rank_dynamic>0,
+      "Error! Variable-count collectives require a runtime leading extent.\n");
+  const Kokkos::LayoutRight layout (n,v.extent(1),v.extent(2),v.extent(3),
+                                    v.extent(4),v.extent(5),v.extent(6),v.extent(7));
+  const auto lock = lock_kokkos_for_comm();
+  contiguous_view_t<ViewT> out (Kokkos::view_alloc(v.label(),Kokkos::WithoutInitializing),layout);
+  return std::make_pair(out,Kokkos::create_mirror_view(Kokkos::WithoutInitializing,out));
+}
+
+// Copy the received values to the output of a view front end
+template<typename ViewT>
+void copy_to_output (const std::pair<ViewT,typename ViewT::HostMirror>& out)
+{
+  const auto lock = lock_kokkos_for_comm();
+  Kokkos::deep_copy(out.first,out.second);
+}
+
+} // namespace impl
+
+template<typename ViewT>
+impl::enable_if_view_t<ViewT>
+Comm::broadcast (const ViewT& vals, const int root) const
+{
+  using scalar_t = impl::comm_scalar_t<ViewT>;
+  const bool am_root = m_rank==root;
+  impl::with_host_data(vals,am_root,not am_root,[&](scalar_t* data) {
+    broadcast(data,impl::comm_count(vals),root);
+  });
+}
+
+template<typename T>
+typename std::enable_if<impl::is_serializable<T>::value>::type
+Comm::broadcast (T& obj, const int root) const
+{
+  if (m_size==1) {
+    return;
+  }
+
+  std::vector<char> buf;
+  if (m_rank==root) {
+    serialize(obj,buf);
+  }
+  long long size = buf.size();
+  broadcast(&size,1,root);
+  EKAT_REQUIRE_MSG (size<=std::numeric_limits<int>::max(),
+      "Error! Serialized object too large to be broadcast.\n"
+      "  - size (bytes): " + std::to_string(size) + "\n");
+  buf.resize(size);
+  broadcast(buf.data(),static_cast<int>(size),root);
+  if (m_rank!=root) {
+    std::size_t pos = 0;
+    deserialize(obj,buf,pos);
+  }
+}
+
+template<typename SrcView, typename DstView>
+impl::enable_if_view_t<SrcView>
+Comm::scan (const SrcView& my_vals, const DstView& result, const MPI_Op op) const
+{
+  using scalar_t = impl::comm_scalar_t<SrcView>;
+  static_assert (std::is_same<scalar_t,impl::comm_scalar_t<DstView>>::value,
+      "Error! Input and output views must have the same scalar type.\n");
+  const int count = impl::comm_count(my_vals);
+  EKAT_REQUIRE_MSG (impl::comm_count(result)==count,
+      "Error! Input and output views of Comm::scan have different sizes.\n");
+  impl::with_host_data(my_vals,true,false,[&](scalar_t* src) {
+    impl::with_host_data(result,false,true,[&](scalar_t* dst) {
+      scan(src,dst,count,op);
+    });
+  });
+}
+
+template<typename SrcView, typename DstView>
+impl::enable_if_view_t<SrcView>
+Comm::all_reduce (const SrcView& my_vals, const DstView& result, const MPI_Op op) const
+{
+  using scalar_t = impl::comm_scalar_t<SrcView>;
+  static_assert (std::is_same<scalar_t,impl::comm_scalar_t<DstView>>::value,
+      "Error! Input and output views must have the same scalar type.\n");
+  const int count = impl::comm_count(my_vals);
+  EKAT_REQUIRE_MSG (impl::comm_count(result)==count,
+      "Error! Input and output views of Comm::all_reduce have different sizes.\n");
+  impl::with_host_data(my_vals,true,false,[&](scalar_t* src) {
+    impl::with_host_data(result,false,true,[&](scalar_t* dst) {
+      all_reduce(src,dst,count,op);
+    });
+  });
+}
+
+template<typename SrcView, typename DstView>
+impl::enable_if_view_t<SrcView>
+Comm::all_gather (const SrcView& my_vals, const DstView& all_vals) const
+{
+  using scalar_t = impl::comm_scalar_t<SrcView>;
+  static_assert (std::is_same<scalar_t,impl::comm_scalar_t<DstView>>::value,
+      "Error! Input and output views must have the same scalar type.\n");
+  const int count = impl::comm_count(my_vals);
+  EKAT_REQUIRE_MSG (impl::comm_count(all_vals)==count*m_size,
+      "Error! Output view of Comm::all_gather must be comm.size() times larger than the input one.\n");
+  impl::with_host_data(my_vals,true,false,[&](scalar_t* src) {
+    impl::with_host_data(all_vals,false,true,[&](scalar_t* dst) {
+      all_gather(src,dst,count);
+    });
+  });
+}
+
+template<typename ViewT>
+impl::enable_if_view_t<ViewT>
+Comm::scan (const ViewT& inout_vals, const MPI_Op op) const
+{
+  using scalar_t = impl::comm_scalar_t<ViewT>;
+  impl::with_host_data(inout_vals,true,true,[&](scalar_t* data) {
+    scan(data,impl::comm_count(inout_vals),op);
+  });
+}
+
+template<typename ViewT>
+impl::enable_if_view_t<ViewT>
+Comm::all_reduce (const ViewT& inout_vals, const MPI_Op op) const
+{
+  using scalar_t = impl::comm_scalar_t<ViewT>;
+  impl::with_host_data(inout_vals,true,true,[&](scalar_t* data) {
+    all_reduce(data,impl::comm_count(inout_vals),op);
+  });
+}
+
+template<typename T>
+Comm::Request Comm::ibroadcast (T* vals, const int count, const int root) const
+{
+  EKAT_COMM_PROFILE_OP(this,"ibroadcast",count*sizeof(T),true);
+  Request req;
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  MPI_Ibcast(vals,count,get_mpi_type<T>(),root,m_mpi_comm,&req.m_mpi_request);
+#else
+  if (m_group) {
+    req.m_recv = m_group->ibroadcast(m_rank,vals,count,root);
+  } else {
+    broadcast(vals,count,root);
+  }
+#endif
+  return req;
+}
+
+template<typename T>
+Comm::Request Comm::iall_reduce (const T* my_vals, T* result, const int count, const MPI_Op op) const
+{
+  EKAT_COMM_PROFILE_OP(this,"iall_reduce",count*sizeof(T),true);
+  Request req;
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  MPI_Iallreduce(my_vals,result,count,get_mpi_type<T>(),op,m_mpi_comm,&req.m_mpi_request);
+#else
+  if (m_group) {
+    req.m_recv = m_group->iall_reduce(m_rank,my_vals,result,count,op);
+  } else {
+    all_reduce(my_vals,result,count,op);
+  }
+#endif
+  return req;
+}
+
+template<typename T>
+Comm::Request Comm::iall_reduce (T* inout_vals, const int count, const MPI_Op op) const
+{
+  EKAT_COMM_PROFILE_OP(this,"iall_reduce",count*sizeof(T),true);
+  Request req;
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  MPI_Iallreduce(MPI_IN_PLACE,inout_vals,count,get_mpi_type<T>(),op,m_mpi_comm,&req.m_mpi_request);
+#else
+  if (m_group) {
+    req.m_recv = m_group->iall_reduce(m_rank,inout_vals,inout_vals,count,op);
+  } else {
+    all_reduce(inout_vals,count,op);
+  }
+#endif
+  return req;
+}
+
+template<typename T>
+Comm::Request Comm::iall_gather (const T* my_vals, T* all_vals, const int count) const
+{
+  EKAT_COMM_PROFILE_OP(this,"iall_gather",count*sizeof(T),true);
+  Request req;
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  auto mpi_type = get_mpi_type<T>();
+  MPI_Iallgather(my_vals, count,mpi_type,
+                 all_vals,count,mpi_type,
+                 m_mpi_comm,&req.m_mpi_request);
+#else
+  if (m_group) {
+    req.m_recv = m_group->iall_gather(m_rank,my_vals,all_vals,count);
+  } else {
+    all_gather(my_vals,all_vals,count);
+  }
+#endif
+  return req;
+}
+
+template<typename T>
+Comm::Request Comm::iall_gather (T* inout_vals, const int count) const
+{
+  EKAT_COMM_PROFILE_OP(this,"iall_gather",count*sizeof(T),true);
+  Request req;
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  auto mpi_type = get_mpi_type<T>();
+  MPI_Iallgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                 inout_vals,count,mpi_type,
+                 m_mpi_comm,&req.m_mpi_request);
+#else
+  if (m_group) {
+    req.m_recv = m_group->iall_gather(m_rank,inout_vals+m_rank*count,inout_vals,count);
+  } else {
+    all_gather(inout_vals,count);
+  }
+#endif
+  return req;
+}
+
+template<typename T>
+void Comm::send (const T* vals, const int count, const int dest, const int tag) const
+{
+  EKAT_COMM_PROFILE_OP(this,"send",count*sizeof(T),false);
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  MPI_Send(vals,count,get_mpi_type<T>(),dest,tag,m_mpi_comm);
+#else
+  EKAT_REQUIRE_MSG (m_group,
+      "Error! Comm::send requires MPI support, or thread ranks.\n");
+  m_group->send(m_rank,dest,tag,vals,count*sizeof(T));
+#endif
+}
+
+template<typename T>
+void Comm::recv (T* vals, const int count, const int src, const int tag) const
+{
+  EKAT_COMM_PROFILE_OP(this,"recv",count*sizeof(T),false);
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  MPI_Recv(vals,count,get_mpi_type<T>(),src,tag,m_mpi_comm,MPI_STATUS_IGNORE);
+#else
+  EKAT_REQUIRE_MSG (m_group,
+      "Error! Comm::recv requires MPI support, or thread ranks.\n");
+  m_group->post_recv(src,m_rank,tag,vals,count*sizeof(T))->wait();
+#endif
+}
+
+template<typename T>
+Comm::Request Comm::isend (const T* vals, const int count, const int dest, const int tag) const
+{
+  EKAT_COMM_PROFILE_OP(this,"isend",count*sizeof(T),false);
+  Request req;
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  MPI_Isend(vals,count,get_mpi_type<T>(),dest,tag,m_mpi_comm,&req.m_mpi_request);
+#else
+  EKAT_REQUIRE_MSG (m_group,
+      "Error! Comm::isend requires MPI support, or thread ranks.\n");
+  m_group->send(m_rank,dest,tag,vals,count*sizeof(T));
+#endif
+  return req;
+}
+
+template<typename T>
+Comm::Request Comm::irecv (T* vals, const int count, const int src, const int tag) const
+{
+  EKAT_COMM_PROFILE_OP(this,"irecv",count*sizeof(T),false);
+  Request req;
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  MPI_Irecv(vals,count,get_mpi_type<T>(),src,tag,m_mpi_comm,&req.m_mpi_request);
+#else
+  EKAT_REQUIRE_MSG (m_group,
+      "Error! Comm::irecv requires MPI support, or thread ranks.\n");
+  req.m_recv = m_group->post_recv(src,m_rank,tag,vals,count*sizeof(T));
+#endif
+  return req;
+}
+
+
+template<typename T, typename Alloc>
+void Comm::gatherv_impl (const T* my_vals, const int my_count, const int root,
+                         std::vector<int>& counts, const Alloc& alloc) const
+{
+  EKAT_COMM_PROFILE_OP(this,"gatherv",my_count*sizeof(T),true);
+  counts.resize(m_size);
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  MPI_Gather(&my_count,1,MPI_INT,counts.data(),1,MPI_INT,root,m_mpi_comm);
+  std::vector<int> displs;
+  T* all_vals = nullptr;
+  if (m_rank==root) {
+    all_vals = alloc(impl::displacements(counts,displs));
+  }
+  const auto mpi_type = get_mpi_type<T>();
+  MPI_Gatherv(my_vals,my_count,mpi_type,
+              all_vals,counts.data(),displs.data(),mpi_type,
+              root,m_mpi_comm);
+  if (m_rank!=root) {
+    counts.clear();
+  }
+#else
+  if (m_group) {
+    m_group->gatherv(m_rank,my_vals,my_count,root,counts,alloc);
+  } else {
+    counts[0] = my_count;
+    std::copy(my_vals, my_vals + my_count, alloc(my_count));
+  }
+#endif
+}
+
+template<typename T, typename Alloc>
+void Comm::all_gatherv_impl (const T* my_vals, const int my_count,
+                             std::vector<int>& counts, const Alloc& alloc) const
+{
+  EKAT_COMM_PROFILE_OP(this,"all_gatherv",my_count*sizeof(T),true);
+  counts.resize(m_size);
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  MPI_Allgather(&my_count,1,MPI_INT,counts.data(),1,MPI_INT,m_mpi_comm);
+  std::vector<int> displs;
+  T* all_vals = alloc(impl::displacements(counts,displs));
+  const auto mpi_type = get_mpi_type<T>();
+  MPI_Allgatherv(my_vals,my_count,mpi_type,
+                 all_vals,counts.data(),displs.data(),mpi_type,
+                 m_mpi_comm);
+#else
+  if (m_group) {
+    m_group->all_gatherv(m_rank,my_vals,my_count,counts,alloc);
+  } else {
+    counts[0] = my_count;
+    std::copy(my_vals, my_vals + my_count, alloc(my_count));
+  }
+#endif
+}
+
+template<typename T, typename Alloc>
+void Comm::scatterv_impl (const T* all_vals, const std::vector<int>& counts,
+                          const int root, const Alloc& alloc) const
+{
+  EKAT_COMM_PROFILE_OP(this,"scatterv",m_rank==root ? impl::total_count(counts)*sizeof(T) : 0,true);
+  EKAT_REQUIRE_MSG (m_rank!=root || static_cast<int>(counts.size())==m_size,
+      "Error! Comm::scatterv requires one count per rank on root.\n"
+      "  - counts size: " + std::to_string(counts.size()) + "\n"
+      "  - comm size  : " + std::to_string(m_size) + "\n");
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  int my_count;
+  MPI_Scatter(counts.data(),1,MPI_INT,&my_count,1,MPI_INT,root,m_mpi_comm);
+  std::vector<int> displs;
+  if (m_rank==root) {
+    impl::displacements(counts,displs);
+  }
+  const auto mpi_type = get_mpi_type<T>();
+  MPI_Scatterv(all_vals,counts.data(),displs.data(),mpi_type,
+               alloc(my_count),my_count,mpi_type,
+               root,m_mpi_comm);
+#else
+  if (m_group) {
+    m_group->scatterv(m_rank,all_vals,counts,root,alloc);
+  } else {
+    std::copy(all_vals, all_vals + counts[0], alloc(counts[0]));
+  }
+#endif
+}
+
+template<typename T, typename Alloc>
+void Comm::all_to_allv_impl (const T* send_vals, const std::vector<int>& send_counts,
+                             std::vector<int>& recv_counts, const Alloc& alloc) const
+{
+  EKAT_COMM_PROFILE_OP(this,"all_to_allv",impl::total_count(send_counts)*sizeof(T),true);
+  EKAT_REQUIRE_MSG (static_cast<int>(send_counts.size())==m_size,
+      "Error! Comm::all_to_allv requires one send count per rank.\n"
+      "  - send counts size: " + std::to_string(send_counts.size()) + "\n"
+      "  - comm size       : " + std::to_string(m_size) + "\n");
+  recv_counts.resize(m_size);
+#ifdef EKAT_ENABLE_MPI
+  check_mpi_inited();
+  MPI_Alltoall(send_counts.data(),1,MPI_INT,recv_counts.data(),1,MPI_INT,m_mpi_comm);
+  std::vector<int> send_displs, recv_displs;
+  impl::displacements(send_counts,send_displs);
+  T* recv_vals = alloc(impl::displacements(recv_counts,recv_displs));
+  const auto mpi_type = get_mpi_type<T>();
+  MPI_Alltoallv(send_vals,send_counts.data(),send_displs.data(),mpi_type,
+                recv_vals,recv_counts.data(),recv_displs.data(),mpi_type,
+                m_mpi_comm);
+#else
+  if (m_group) {
+    m_group->all_to_allv(m_rank,send_vals,send_counts,recv_counts,alloc);
+  } else {
+    recv_counts[0] = send_counts[0];
+    std::copy(send_vals, send_vals + send_counts[0], alloc(send_counts[0]));
+  }
 #endif
 }
 
+template<typename T>
+std::vector<T> Comm::gatherv (const T* my_vals, const int my_count, const int root,
+                              std::vector<int>* counts) const
+{
+  std::vector<T> all_vals;
+  std::vector<int> all_counts;
+  gatherv_impl(my_vals,my_count,root,all_counts,
+               [&](const int n) { all_vals.resize(n); return all_vals.data(); });
+  if (counts) {
+    *counts = std::move(all_counts);
+  }
+  return all_vals;
+}
+
+template<typename T>
+std::vector<T> Comm::all_gatherv (const T* my_vals, const int my_count,
+                                  std::vector<int>* counts) const
+{
+  std::vector<T> all_vals;
+  std::vector<int> all_counts;
+  all_gatherv_impl(my_vals,my_count,all_counts,
+                   [&](const int n) { all_vals.resize(n); return all_vals.data(); });
+  if (counts) {
+    *counts = std::move(all_counts);
+  }
+  return all_vals;
+}
+
+template<typename T>
+std::vector<T> Comm::scatterv (const T* all_vals, const std::vector<int>& counts,
+                               const int root) const
+{
+  std::vector<T> my_vals;
+  scatterv_impl(all_vals,counts,root,
+                [&](const int n) { my_vals.resize(n); return my_vals.data(); });
+  return my_vals;
+}
+
+template<typename T>
+std::vector<T> Comm::all_to_allv (const T* send_vals, const std::vector<int>& send_counts,
+                                  std::vector<int>* recv_counts) const
+{
+  std::vector<T> recv_vals;
+  std::vector<int> counts;
+  all_to_allv_impl(send_vals,send_counts,counts,
+                   [&](const int n) { recv_vals.resize(n); return recv_vals.data(); });
+  if (recv_counts) {
+    *recv_counts = std::move(counts);
+  }
+  return recv_vals;
+}
+
+// The view versions receive directly in the host mirror of the output, which
+// is then copied to the output (a no-op if the output is host-accessible)
+
+template<typename ViewT>
+impl::enable_if_view_t<ViewT,impl::contiguous_view_t<ViewT>>
+Comm::gatherv (const ViewT& my_vals, const int root, std::vector<int>* counts) const
+{
+  using scalar_t = impl::comm_scalar_t<ViewT>;
+  const int row = impl::comm_row_count(my_vals);
+  auto out = impl::alloc_like(my_vals,0);
+  std::vector<int> all_counts;
+  impl::with_host_data(my_vals,true,false,[&](scalar_t* data) {
+    gatherv_impl(data,my_vals.extent_int(0)*row,root,all_counts,[&](const int n) {
+      out = impl::alloc_like(my_vals,row>0 ? n/row : 0);
+      return reinterpret_cast<scalar_t*>(out.second.data());
+    });
+  });
+  impl::copy_to_output(out);
+  if (counts) {
+    for (auto& c : all_counts) {
+      c = row>0 ? c/row : 0;
+    }
+    *counts = std::move(all_counts);
+  }
+  return out.first;
+}
+
+template<typename ViewT>
+impl::enable_if_view_t<ViewT,impl::contiguous_view_t<ViewT>>
+Comm::all_gatherv (const ViewT& my_vals, std::vector<int>* counts) const
+{
+  using scalar_t = impl::comm_scalar_t<ViewT>;
+  const int row = impl::comm_row_count(my_vals);
+  auto out = impl::alloc_like(my_vals,0);
+  std::vector<int> all_counts;
+  impl::with_host_data(my_vals,true,false,[&](scalar_t* data) {
+    all_gatherv_impl(data,my_vals.extent_int(0)*row,all_counts,[&](const int n) {
+      out = impl::alloc_like(my_vals,row>0 ? n/row : 0);
+      return reinterpret_cast<scalar_t*>(out.second.data());
+    });
+  });
+  impl::copy_to_output(out);
+  if (counts) {
+    for (auto& c : all_counts) {
+      c = row>0 ? c/row : 0;
+    }
+    *counts = std::move(all_counts);
+  }
+  return out.first;
+}
+
+template<typename ViewT>
+impl::enable_if_view_t<ViewT,impl::contiguous_view_t<ViewT>>
+Comm::scatterv (const ViewT& all_vals, const std::vector<int>& counts, const int root) const
+{
+  using scalar_t = impl::comm_scalar_t<ViewT>;
+  const int row = impl::comm_row_count(all_vals);
+  std::vector<int> scalar_counts(counts);
+  for (auto& c : scalar_counts) {
+    c *= row;
+  }
+  auto out = impl::alloc_like(all_vals,0);
+  impl::with_host_data(all_vals,m_rank==root,false,[&](scalar_t* data) {
+    scatterv_impl(data,scalar_counts,root,[&](const int n) {
+      out = impl::alloc_like(all_vals,row>0 ? n/row : 0);
+      return reinterpret_cast<scalar_t*>(out.second.data());
+    });
+  });
+  impl::copy_to_output(out);
+  return out.first;
+}
+
+template<typename ViewT>
+impl::enable_if_view_t<ViewT,impl::contiguous_view_t<ViewT>>
+Comm::all_to_allv (const ViewT& send_vals, const std::vector<int>& send_counts,
+                   std::vector<int>* recv_counts) const
+{
+  using scalar_t = impl::comm_scalar_t<ViewT>;
+  const int row = impl::comm_row_count(send_vals);
+  std::vector<int> scalar_counts(send_counts);
+  for (auto& c : scalar_counts) {
+    c *= row;
+  }
+  auto out = impl::alloc_like(send_vals,0);
+  std::vector<int> counts;
+  impl::with_host_data(send_vals,true,false,[&](scalar_t* data) {
+    all_to_allv_impl(data,scalar_counts,counts,[&](const int n) {
+      out = impl::alloc_like(send_vals,row>0 ? n/row : 0);
+      return reinterpret_cast<scalar_t*>(out.second.data());
+    });
+  });
+  impl::copy_to_output(out);
+  if (recv_counts) {
+    for (auto& c : counts) {
+      c = row>0 ? c/row : 0;
+    }
+    *recv_counts = std::move(counts);
+  }
+  return out.first;
+}
+
 } // namespace ekat
 
 #endif // EKAT_COMM_HPP
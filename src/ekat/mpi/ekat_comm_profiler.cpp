@@ -0,0 +1,213 @@
+#include "ekat/mpi/ekat_comm_profiler.hpp"
+#include "ekat/mpi/ekat_comm.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <utility>
+
+// This file is compiled with and without MPI support, and with or without
+// EKAT_ENABLE_COMM_PROFILING (in which case nothing is ever recorded).
+
+namespace ekat
+{
+
+namespace {
+
+struct ProfilerState {
+  // Regions are stored as full labels, e.g., "outer/inner"
+  std::vector<std::string> regions;
+
+  // Depth of the Comm operations currently being recorded on this thread,
+  // so that nested operations are only recorded by the outermost one
+  int depth = 0;
+
+  std::map<std::pair<std::string,std::string>,CommProfileEntry> entries;
+};
+
+ProfilerState& state () {
+  thread_local ProfilerState s;
+  return s;
+}
+
+// The barrier setting is common to all threads
+std::atomic<bool>& barrier_before_collectives () {
+  static std::atomic<bool> b(false);
+  return b;
+}
+
+double now () {
+  using clock = std::chrono::steady_clock;
+  return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
+
+} // anonymous namespace
+
+CommProfilingRegion::CommProfilingRegion (const std::string& name)
+{
+  auto& regions = state().regions;
+  regions.push_back(regions.empty() ? name : regions.back() + "/" + name);
+}
+
+CommProfilingRegion::~CommProfilingRegion ()
+{
+  state().regions.pop_back();
+}
+
+void set_comm_profiling_barrier (const bool barrier_before)
+{
+  barrier_before_collectives() = barrier_before;
+}
+
+std::vector<CommProfileEntry> get_comm_profile ()
+{
+  std::vector<CommProfileEntry> entries;
+  for (const auto& it : state().entries) {
+    entries.push_back(it.second);
+  }
+  return entries;
+}
+
+void reset_comm_profile ()
+{
+  state().entries.clear();
+}
+
+void print_comm_profile (const Comm& comm, std::ostream& out)
+{
+  // The reduction itself is not recorded
+  auto& s = state();
+  ++s.depth;
+
+  // Each rank sends one line per entry to root
+  std::ostringstream ss;
+  ss.precision(17);
+  for (const auto& it : s.entries) {
+    const auto& e = it.second;
+    ss << e.region << '\t' << e.op << '\t' << e.calls << '\t' << e.bytes << '\t'
+       << e.time << '\t' << e.imbalance << '\n';
+  }
+  const std::string mine = ss.str();
+  const auto all = comm.gatherv(std::vector<char>(mine.begin(),mine.end()),comm.root_rank());
+  --s.depth;
+
+  if (not comm.am_i_root()) {
+    return;
+  }
+
+  struct Stats {
+    long long calls = 0;
+    long long bytes = 0;
+    double time_min = 0, time_max = 0, time_sum = 0;
+    double imb_max = 0, imb_sum = 0;
+    int nranks = 0;
+  };
+  std::map<std::pair<std::string,std::string>,Stats> stats;
+  std::istringstream lines(std::string(all.begin(),all.end()));
+  std::string line;
+  while (std::getline(lines,line)) {
+    std::istringstream fields(line);
+    std::string region, op;
+    CommProfileEntry e;
+    std::getline(fields,region,'\t');
+    std::getline(fields,op,'\t');
+    fields >> e.calls >> e.bytes >> e.time >> e.imbalance;
+
+    auto& st = stats[std::make_pair(region,op)];
+    st.time_min = st.nranks==0 ? e.time : std::min(st.time_min,e.time);
+    st.time_max = std::max(st.time_max,e.time);
+    st.time_sum += e.time;
+    st.imb_max = std::max(st.imb_max,e.imbalance);
+    st.imb_sum += e.imbalance;
+    st.calls += e.calls;
+    st.bytes += e.bytes;
+    ++st.nranks;
+  }
+  if (stats.empty()) {
+    return;
+  }
+
+  // Ranks that never issued an op spent no time in it
+  const int size = comm.size();
+  std::vector<std::pair<std::pair<std::string,std::string>,Stats>> sorted(stats.begin(),stats.end());
+  for (auto& it : sorted) {
+    if (it.second.nranks<size) {
+      it.second.time_min = 0;
+    }
+  }
+  std::sort(sorted.begin(),sorted.end(),[](const auto& a, const auto& b) {
+    return a.second.time_max>b.second.time_max;
+  });
+
+  char buf[256];
+  out << "================== ekat::Comm profile (" << size << " ranks) ==================\n";
+  std::snprintf(buf,sizeof(buf),"%-32s %-18s %10s %12s %30s %21s\n",
+                "region","op","calls/rank","MB (total)",
+                "time min/avg/max [s]","imbalance avg/max [s]");
+  out << buf;
+  for (const auto& it : sorted) {
+    const auto& st = it.second;
+    const auto& region = it.first.first;
+    std::snprintf(buf,sizeof(buf),"%-32s %-18s %10.1f %12.3f %9.3e %9.3e %9.3e %10.3e %10.3e\n",
+                  region.empty() ? "-" : region.c_str(), it.first.second.c_str(),
+                  double(st.calls)/size, st.bytes/1048576.0,
+                  st.time_min, st.time_sum/size, st.time_max,
+                  st.imb_sum/size, st.imb_max);
+    out << buf;
+  }
+  out << std::flush;
+}
+
+namespace impl
+{
+
+CommOpTimer::CommOpTimer (const Comm* comm, const char* op, const long long bytes, const bool collective)
+ : m_op (op)
+ , m_bytes (bytes)
+{
+  auto& s = state();
+  m_active = s.depth==0;
+  ++s.depth;
+  if (not m_active) {
+    return;
+  }
+  if (collective && comm!=nullptr && barrier_before_collectives()) {
+    const double start = now();
+    try {
+      comm->barrier();
+    } catch (...) {
+      --s.depth;
+      throw;
+    }
+    m_imbalance = now() - start;
+  }
+  m_start = now();
+}
+
+CommOpTimer::~CommOpTimer ()
+{
+  auto& s = state();
+  --s.depth;
+  if (not m_active) {
+    return;
+  }
+  const double time = now() - m_start;
+  const auto& region = s.regions.empty() ? std::string() : s.regions.back();
+  auto& e = s.entries[std::make_pair(region,std::string(m_op))];
+  if (e.calls==0) {
+    e.region = region;
+    e.op = m_op;
+  }
+  ++e.calls;
+  e.bytes += m_bytes;
+  e.time += time;
+  e.imbalance += m_imbalance;
+}
+
+} // namespace impl
+
+} // namespace ekat
@@ -0,0 +1,118 @@
+#ifndef EKAT_COMM_PROFILER_HPP
+#define EKAT_COMM_PROFILER_HPP
+
+#include <ekat/ekat_config.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace ekat
+{
+
+class Comm;
+
+/*
+ * Profiling of the traffic through ekat::Comm
+ *
+ * If EKAT is configured with EKAT_ENABLE_COMM_PROFILING=ON, every Comm operation
+ * records its number of calls, bytes (contributed by the calling rank) and
+ * time, for each region where it is issued (see EKAT_COMM_PROFILING_REGION).
+ * Operations issued from within other operations (e.g., the all_reduce calls
+ * within reproducible_sum) are accounted for in the outer one only.
+ *
+ * Optionally, collectives can be preceded by a barrier, whose duration is
+ * recorded separately, as load imbalance. This separates the time spent
+ * waiting for other ranks to reach the collective from the time spent in
+ * the collective itself, at the price of perturbing the timings.
+ *
+ * The statistics are kept per thread, so that each thread rank (see
+ * run_on_thread_ranks) has its own. finalize_ekat_session prints the summary
+ * of all ranks of MPI_COMM_WORLD.
+ *
+ * Without EKAT_ENABLE_COMM_PROFILING, Comm operations record nothing, and
+ * EKAT_COMM_PROFILING_REGION expands to nothing.
+ */
+
+struct CommProfileEntry
+{
+  std::string region;
+  std::string op;
+  long long   calls     = 0;
+  long long   bytes     = 0;
+  double      time      = 0;  // Seconds spent in the operation
+  double      imbalance = 0;  // Seconds spent in the barrier before the operation
+};
+
+// Label the Comm operations issued on this thread within the current scope.
+// Nested regions are labeled as "outer/inner".
+class CommProfilingRegion
+{
+public:
+  explicit CommProfilingRegion (const std::string& name);
+  ~CommProfilingRegion ();
+
+  CommProfilingRegion (const CommProfilingRegion&) = delete;
+  CommProfilingRegion& operator= (const CommProfilingRegion&) = delete;
+};
+
+constexpr bool comm_profiling_enabled () {
+#ifdef EKAT_ENABLE_COMM_PROFILING
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Whether collectives are preceded by a barrier (default: false)
+void set_comm_profiling_barrier (const bool barrier_before_collectives);
+
+// The statistics of the calling thread, sorted by region and op
+std::vector<CommProfileEntry> get_comm_profile ();
+
+void reset_comm_profile ();
+
+// Collective on comm. Reduces the statistics of all ranks to the root of comm,
+// which prints them, sorted by decreasing max time across ranks.
+void print_comm_profile (const Comm& comm, std::ostream& out);
+
+namespace impl
+{
+
+// Records one operation, from construction to destruction. Collective ops are
+// preceded by a barrier on comm, if requested.
+class CommOpTimer
+{
+public:
+  CommOpTimer (const Comm* comm, const char* op, const long long bytes, const bool collective);
+  ~CommOpTimer ();
+
+  CommOpTimer (const CommOpTimer&) = delete;
+  CommOpTimer& operator= (const CommOpTimer&) = delete;
+
+private:
+  const char* m_op;
+  long long   m_bytes;
+  bool        m_active;
+  double      m_imbalance = 0;
+  double      m_start     = 0;
+};
+
+} // namespace impl
+
+} // namespace ekat
+
+#define EKAT_COMM_PROFILING_CONCAT_IMPL(a,b) a##b
+#define EKAT_COMM_PROFILING_CONCAT(a,b) EKAT_COMM_PROFILING_CONCAT_IMPL(a,b)
+
+#ifdef EKAT_ENABLE_COMM_PROFILING
+#define EKAT_COMM_PROFILING_REGION(name) \
+  ::ekat::CommProfilingRegion EKAT_COMM_PROFILING_CONCAT(ekat_comm_region_,__LINE__) (name)
+#define EKAT_COMM_PROFILE_OP(comm,op,bytes,collective) \
+  ::ekat::impl::CommOpTimer ekat_comm_op_timer_ (comm,op,static_cast<long long>(bytes),collective)
+#else
+#define EKAT_COMM_PROFILING_REGION(name)
+#define EKAT_COMM_PROFILE_OP(comm,op,bytes,collective)
+#endif
+
+#endif // EKAT_COMM_PROFILER_HPP
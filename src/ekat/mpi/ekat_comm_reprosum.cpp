@@ -0,0 +1,145 @@
+#include "ekat/mpi/ekat_comm.hpp"
+#include "ekat/ekat_assert.hpp"
+
+#include <climits>
+#include <cmath>
+#include <vector>
+
+// This file is compiled with and without MPI support: the reproducible sum
+// must give the same bits in a serial build as on any number of MPI ranks.
+
+namespace ekat
+{
+
+namespace {
+
+// Each summand x, with |x|<2^E, is split into nwords integers a_k, with |a_k|<2^bits,
+// such that x = sum_k a_k*2^(E-(k+1)*bits), up to truncation of the bits
+// below 2^(E-nwords*bits). Accumulators have one more (leading) word, which
+// collects the carries of the others.
+constexpr int bits   = 32;
+constexpr int nwords = 4;
+constexpr int nacc   = nwords+1;
+
+constexpr long long base = 1LL << bits;
+
+// Max number of additions of a_k's in a word before it could overflow
+constexpr int max_adds = 1 << (62-bits);
+
+// Move all carries to the leading word, so that all other words are in [0,2^bits).
+// This makes the representation of a given integer unique.
+void normalize (long long* acc) {
+  for (int k=nacc-1; k>0; --k) {
+    const long long low = acc[k] & (base-1);
+    acc[k-1] += (acc[k] - low) / base;
+    acc[k] = low;
+  }
+}
+
+} // anonymous namespace
+
+void Comm::reproducible_sum (const double* my_vals, double* sums,
+                             const int count, const int nsums) const
+{
+  EKAT_COMM_PROFILE_OP(this,"reproducible_sum",count*nsums*sizeof(double),true);
+  EKAT_REQUIRE_MSG (count>=0 && nsums>=0,
+      "Error! Invalid count/nsums in Comm::reproducible_sum.\n"
+      "  - count: " + std::to_string(count) + "\n"
+      "  - nsums: " + std::to_string(nsums) + "\n");
+
+  // Find the exponent E of each sum, with |x|<2^E for all its summands.
+  // Non-finite summands get E=INT_MAX, and sums of zeros E=INT_MIN.
+  std::vector<int> exps(nsums,INT_MIN);
+  for (int j=0; j<nsums; ++j) {
+    for (int i=0; i<count; ++i) {
+      const double x = my_vals[j*count+i];
+      if (not std::isfinite(x)) {
+        exps[j] = INT_MAX;
+        break;
+      } else if (x!=0) {
+        exps[j] = std::max(exps[j],std::ilogb(x)+1);
+      }
+    }
+  }
+  all_reduce(exps.data(),nsums,MPI_MAX);
+
+  // Accumulate the fixed point representation of the summands
+  std::vector<long long> acc(nsums*nacc,0);
+  bool has_non_finite = false;
+  for (int j=0; j<nsums; ++j) {
+    const int E = exps[j];
+    if (E==INT_MIN) {
+      continue;
+    } else if (E==INT_MAX) {
+      has_non_finite = true;
+      continue;
+    }
+    long long* acc_j = acc.data() + j*nacc;
+    for (int i=0; i<count; ++i) {
+      double r = my_vals[j*count+i];
+      for (int k=0; k<nwords; ++k) {
+        // All the operations are exact: a_k*2^e only has bits that r also has
+        const int e = E-(k+1)*bits;
+        const long long a = static_cast<long long>(std::ldexp(r,-e));
+        acc_j[k+1] += a;
+        r -= std::ldexp(static_cast<double>(a),e);
+      }
+      if ((i+1) % max_adds == 0) {
+        normalize(acc_j);
+      }
+    }
+    normalize(acc_j);
+  }
+
+  // Integer sums are exact, hence independent of the order of the summands
+  all_reduce(acc.data(),nsums*nacc,MPI_SUM);
+
+  for (int j=0; j<nsums; ++j) {
+    const int E = exps[j];
+    sums[j] = 0;
+    if (E==INT_MIN || E==INT_MAX) {
+      continue;
+    }
+    long long* acc_j = acc.data() + j*nacc;
+    normalize(acc_j);
+
+    // A negative total has a negative leading word, and non-negative lower words,
+    // which would cancel out below. Convert the magnitude instead.
+    const bool negative = acc_j[0]<0;
+    if (negative) {
+      for (int k=0; k<nacc; ++k) {
+        acc_j[k] = -acc_j[k];
+      }
+      normalize(acc_j);
+    }
+
+    // Add from the least significant word, which is accurate (and deterministic,
+    // since the normalized words only depend on the exact integer sum)
+    for (int k=nacc-1; k>=0; --k) {
+      sums[j] += std::ldexp(static_cast<double>(acc_j[k]),E-k*bits);
+    }
+    if (negative) {
+      sums[j] = -sums[j];
+    }
+  }
+
+  // Non-finite summands make the result non-finite; the order does not matter
+  if (has_non_finite) {
+    std::vector<double> naive(nsums,0);
+    for (int j=0; j<nsums; ++j) {
+      if (exps[j]==INT_MAX) {
+        for (int i=0; i<count; ++i) {
+          naive[j] += my_vals[j*count+i];
+        }
+      }
+    }
+    all_reduce(naive.data(),nsums,MPI_SUM);
+    for (int j=0; j<nsums; ++j) {
+      if (exps[j]==INT_MAX) {
+        sums[j] = naive[j];
+      }
+    }
+  }
+}
+
+} // namespace ekat
@@ -4,7 +4,8 @@
 #include <cassert>
 
 // This file is compiled when EKAT_ENABLE_MPI is not defined. It provides the
-// correct functionality for a single-process configuration.
+// correct functionality for a single-process configuration, where the ranks
+// of a comm (if more than one) are threads (see run_on_thread_ranks).
 
 namespace ekat
 {
@@ -15,27 +16,145 @@ Comm::Comm()
 }
 
 Comm::Comm(MPI_Comm mpi_comm)
-  : m_mpi_comm(mpi_comm), m_size(1), m_rank(0)
 {
+  reset_mpi_comm (mpi_comm);
 }
 
 void Comm::reset_mpi_comm (MPI_Comm new_mpi_comm)
 {
+  m_mpi_comm = new_mpi_comm;
+
+  // Inside run_on_thread_ranks, the world is made of all the thread ranks
+  const auto& world = impl::thread_world();
+  if (new_mpi_comm==MPI_COMM_WORLD && world.group!=nullptr) {
+    m_group = world.group;
+    m_size  = world.group->size();
+    m_rank  = world.rank;
+  } else {
+    m_group = nullptr;
+    m_size  = 1;
+    m_rank  = 0;
+  }
 }
 
 void Comm::barrier () const
 {
+  EKAT_COMM_PROFILE_OP(this,"barrier",0,false);
+  if (m_group) {
+    m_group->barrier();
+  }
 }
 
 Comm Comm::split (const int color) const
 {
-  return Comm(MPI_COMM_SELF);
+  EKAT_COMM_PROFILE_OP(this,"split",0,true);
+  Comm new_comm(MPI_COMM_SELF);
+  if (m_group) {
+    int new_rank;
+    auto group = m_group->split(m_rank,color,m_rank,new_rank);
+    if (group->size()>1) {
+      new_comm.m_mpi_comm = m_mpi_comm;
+      new_comm.m_group = group;
+      new_comm.m_size  = group->size();
+      new_comm.m_rank  = new_rank;
+    }
+  }
+  return new_comm;
+}
+
+Comm Comm::split_shared () const
+{
+  EKAT_COMM_PROFILE_OP(this,"split_shared",0,true);
+  // Thread ranks all share memory
+  return split(0);
+}
+
+void Comm::free_mpi_comm ()
+{
+  // The comms of a split have the group of their thread ranks, and it is
+  // freed with the last comm using it
+  if (m_group==nullptr || m_group==impl::thread_world().group) {
+    return;
+  }
+  m_mpi_comm = MPI_COMM_SELF;
+  m_group = nullptr;
+  m_size  = 1;
+  m_rank  = 0;
+}
+
+Comm::Request Comm::ibarrier () const
+{
+  EKAT_COMM_PROFILE_OP(this,"ibarrier",0,false);
+  Request req;
+  if (m_group) {
+    req.m_recv = m_group->ibarrier(m_rank);
+  }
+  return req;
 }
 
 void Comm::check_mpi_inited () const
 {
 }
 
+// ========================= Comm::Request =========================== //
+
+// With a single process, all nonblocking operations complete immediately,
+// except receives and collectives involving other thread ranks.
+
+Comm::Request::~Request ()
+{
+  if (is_pending()) {
+    // Do not throw if the run of thread ranks was aborted
+    try {
+      wait();
+    } catch (...) {}
+  }
+}
+
+Comm::Request::Request (Request&& src)
+  : m_recv(std::move(src.m_recv))
+{
+  src.m_recv = nullptr;
+}
+
+Comm::Request& Comm::Request::operator= (Request&& src)
+{
+  if (this!=&src) {
+    if (is_pending()) {
+      wait();
+    }
+    m_recv = std::move(src.m_recv);
+    src.m_recv = nullptr;
+  }
+  return *this;
+}
+
+void Comm::Request::wait ()
+{
+  EKAT_COMM_PROFILE_OP(nullptr,"wait",0,false);
+  if (m_recv) {
+    m_recv->wait();
+    m_recv = nullptr;
+  }
+}
+
+bool Comm::Request::test ()
+{
+  EKAT_COMM_PROFILE_OP(nullptr,"test",0,false);
+  if (m_recv && m_recv->test()) {
+    m_recv = nullptr;
+  }
+  return m_recv==nullptr;
+}
+
+void Comm::Request::wait_all (std::vector<Request>& requests)
+{
+  EKAT_COMM_PROFILE_OP(nullptr,"wait_all",0,false);
+  for (auto& r : requests) {
+    r.wait();
+  }
+}
+
 template<>
 MPI_Datatype get_mpi_type <char> () {
   return MPI_CHAR;
@@ -0,0 +1,382 @@
+#ifndef EKAT_HALO_EXCHANGE_HPP
+#define EKAT_HALO_EXCHANGE_HPP
+
+#include "ekat/mpi/ekat_comm.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
+#include "ekat/ekat_assert.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ekat {
+
+/*
+ * HaloExchange fills the halo (ghost) entries of a distributed field with
+ * the values owned by the neighboring ranks.
+ *
+ * The communication pattern is registered once, and reused at every step.
+ * For each neighbor rank, one registers the local entries to send to it,
+ * and the local (halo) entries to fill with what it sends back, listed in
+ * the same order as the neighbor lists its own send entries. Then, setup
+ * allocates the buffers and creates persistent MPI requests, so that each
+ * exchange only has to pack the send buffers, start the requests, and unpack
+ * the received data. Packing and unpacking are parallel kernels.
+ *
+ * Fields are rank-2 views (entry,k) of scalars, where the extent along k
+ * is the one given to setup (use ekat::scalarize for views of packs). An
+ * exchange is split in two phases, so that it can be overlapped with the
+ * computation of the entries that do not need the halo:
+ *
+ *   HaloExchange<Real> he(comm);
+ *   he.add_neighbor(rank, send_ids, recv_ids);  // once per neighbor
+ *   he.setup(nlev);
+ *   for (int step=0; step<nsteps; ++step) {
+ *     he.start(T);            // pack, and start all sends/recvs
+ *     compute_interior(T);    // must not read the halo entries of T
+ *     he.finish(T);           // wait, and unpack into the halo entries
+ *     compute_boundary(T);
+ *   }
+ *
+ * Between start and finish, the field can be modified (the data to send is
+ * already packed), except for the halo entries, which finish overwrites.
+ *
+ * A rank can be its own neighbor (e.g., in a periodic domain). That exchange
+ * is a local copy, and it is the only one allowed in builds without MPI.
+ *
+ * NOTE: MPI only ever sees host buffers. On devices whose memory is not
+ *       host-accessible, packed buffers are staged through host mirrors.
+ */
+
+template<typename ScalarT, typename DeviceT=DefaultDevice>
+class HaloExchange
+{
+public:
+  using Scalar = ScalarT;
+  using Device = DeviceT;
+
+  using KT = KokkosTypes<Device>;
+
+  template <typename S>
+  using view_1d = typename KT::template view_1d<S>;
+
+  using RangePolicy = typename KT::RangePolicy;
+
+  explicit HaloExchange (const Comm& comm, const int tag = 0);
+  ~HaloExchange ();
+
+  HaloExchange (const HaloExchange&) = delete;
+  HaloExchange& operator= (const HaloExchange&) = delete;
+
+  // Register the entries to exchange with the given rank. All calls must
+  // happen before setup, and each rank can only be registered once.
+  void add_neighbor (const int rank,
+                     const std::vector<int>& send_ids,
+                     const std::vector<int>& recv_ids);
+
+  // Allocate buffers and create the persistent requests, for fields with
+  // nvals values per entry.
+  void setup (const int nvals);
+
+  bool is_setup () const { return m_nvals>=0; }
+  int num_neighbors () const { return m_neighbors.size(); }
+  int num_vals () const { return m_nvals; }
+  const Comm& get_comm () const { return m_comm; }
+
+  // Pack the send entries of the field, and start all sends/recvs
+  template<typename ViewT>
+  void start (const ViewT& field);
+
+  // Wait for all recvs, and unpack them into the halo entries of the field
+  template<typename ViewT>
+  void finish (const ViewT& field);
+
+  // Blocking exchange, with nothing to overlap
+  template<typename ViewT>
+  void exchange (const ViewT& field) {
+    start(field);
+    finish(field);
+  }
+
+protected:
+
+  struct Neighbor {
+    int rank;
+    std::vector<int> send_ids;
+    std::vector<int> recv_ids;
+  };
+
+  template<typename ViewT>
+  void check_field (const ViewT& field, const std::string& method) const;
+
+  Comm  m_comm;
+  int   m_tag;
+  int   m_nvals = -1;
+  bool  m_started = false;
+
+  // Remote neighbors come first, and the rank itself (if a neighbor) last,
+  // so that only the first m_num_remote_* entries of the buffers go through MPI
+  std::vector<Neighbor> m_neighbors;
+  int m_num_remote_send = 0;
+  int m_num_remote_recv = 0;
+  int m_max_id = -1;
+
+  view_1d<int>    m_send_ids;
+  view_1d<int>    m_recv_ids;
+  view_1d<Scalar> m_send_buf;
+  view_1d<Scalar> m_recv_buf;
+  typename view_1d<Scalar>::HostMirror m_send_buf_h;
+  typename view_1d<Scalar>::HostMirror m_recv_buf_h;
+
+#ifdef EKAT_ENABLE_MPI
+  std::vector<MPI_Request> m_send_reqs;
+  std::vector<MPI_Request> m_recv_reqs;
+#endif
+};
+
+// ========================= IMPLEMENTATION =========================== //
+
+template<typename ScalarT, typename DeviceT>
+HaloExchange<ScalarT,DeviceT>::
+HaloExchange (const Comm& comm, const int tag)
+ : m_comm (comm)
+ , m_tag  (tag)
+{
+  // Nothing else to do
+}
+
+template<typename ScalarT, typename DeviceT>
+HaloExchange<ScalarT,DeviceT>::~HaloExchange ()
+{
+#ifdef EKAT_ENABLE_MPI
+  int finalized;
+  MPI_Finalized(&finalized);
+  if (finalized) {
+    return;
+  }
+  if (m_started) {
+    MPI_Waitall(m_recv_reqs.size(),m_recv_reqs.data(),MPI_STATUSES_IGNORE);
+    MPI_Waitall(m_send_reqs.size(),m_send_reqs.data(),MPI_STATUSES_IGNORE);
+  }
+  for (auto& req : m_send_reqs) {
+    MPI_Request_free(&req);
+  }
+  for (auto& req : m_recv_reqs) {
+    MPI_Request_free(&req);
+  }
+#endif
+}
+
+template<typename ScalarT, typename DeviceT>
+void HaloExchange<ScalarT,DeviceT>::
+add_neighbor (const int rank,
+              const std::vector<int>& send_ids,
+              const std::vector<int>& recv_ids)
+{
+  EKAT_REQUIRE_MSG (not is_setup(),
+      "Error! Cannot add neighbors to a HaloExchange after setup.\n");
+  EKAT_REQUIRE_MSG (rank>=0 && rank<m_comm.size(),
+      "Error! Invalid neighbor rank.\n"
+      "  - rank: " + std::to_string(rank) + "\n"
+      "  - comm size: " + std::to_string(m_comm.size()) + "\n");
+  for (const auto& n : m_neighbors) {
+    EKAT_REQUIRE_MSG (n.rank!=rank,
+        "Error! Neighbor rank " + std::to_string(rank) + " was already registered.\n"
+        "  Merge all the entries to exchange with a rank in a single call.\n");
+  }
+#ifndef EKAT_ENABLE_MPI
+  EKAT_REQUIRE_MSG (rank==m_comm.rank(),
+      "Error! Without MPI support, a rank can only exchange with itself.\n");
+#endif
+  if (rank==m_comm.rank()) {
+    EKAT_REQUIRE_MSG (send_ids.size()==recv_ids.size(),
+        "Error! Sizes of send and recv lists differ for the exchange with self.\n"
+        "  - num send: " + std::to_string(send_ids.size()) + "\n"
+        "  - num recv: " + std::to_string(recv_ids.size()) + "\n");
+  }
+  for (const auto* ids : {&send_ids, &recv_ids}) {
+    for (auto id : *ids) {
+      EKAT_REQUIRE_MSG (id>=0, "Error! Invalid (negative) entry id.\n");
+      m_max_id = std::max(m_max_id,id);
+    }
+  }
+
+  Neighbor n {rank, send_ids, recv_ids};
+  if (rank==m_comm.rank()) {
+    m_neighbors.push_back(std::move(n));
+  } else {
+    // Keep the remote neighbors before the rank itself
+    auto pos = std::find_if(m_neighbors.begin(),m_neighbors.end(),
+                            [&](const Neighbor& nb){ return nb.rank==m_comm.rank(); });
+    m_neighbors.insert(pos,std::move(n));
+  }
+}
+
+template<typename ScalarT, typename DeviceT>
+void HaloExchange<ScalarT,DeviceT>::setup (const int nvals)
+{
+  EKAT_REQUIRE_MSG (not is_setup(),
+      "Error! HaloExchange::setup was already called.\n");
+  EKAT_REQUIRE_MSG (nvals>0,
+      "Error! Invalid number of values per entry: " + std::to_string(nvals) + "\n");
+
+  // Concatenate the lists of all neighbors
+  std::vector<int> send_ids, recv_ids;
+  for (const auto& n : m_neighbors) {
+    send_ids.insert(send_ids.end(),n.send_ids.begin(),n.send_ids.end());
+    recv_ids.insert(recv_ids.end(),n.recv_ids.begin(),n.recv_ids.end());
+    if (n.rank!=m_comm.rank()) {
+      m_num_remote_send += n.send_ids.size();
+      m_num_remote_recv += n.recv_ids.size();
+    }
+  }
+
+  const int nsend = send_ids.size();
+  const int nrecv = recv_ids.size();
+  m_send_ids = view_1d<int>("HaloExchange::send_ids",nsend);
+  m_recv_ids = view_1d<int>("HaloExchange::recv_ids",nrecv);
+  auto send_ids_h = Kokkos::create_mirror_view(m_send_ids);
+  auto recv_ids_h = Kokkos::create_mirror_view(m_recv_ids);
+  std::copy(send_ids.begin(),send_ids.end(),send_ids_h.data());
+  std::copy(recv_ids.begin(),recv_ids.end(),recv_ids_h.data());
+  Kokkos::deep_copy(m_send_ids,send_ids_h);
+  Kokkos::deep_copy(m_recv_ids,recv_ids_h);
+
+  m_send_buf = view_1d<Scalar>("HaloExchange::send_buf",nsend*nvals);
+  m_recv_buf = view_1d<Scalar>("HaloExchange::recv_buf",nrecv*nvals);
+  m_send_buf_h = Kokkos::create_mirror_view(m_send_buf);
+  m_recv_buf_h = Kokkos::create_mirror_view(m_recv_buf);
+
+#ifdef EKAT_ENABLE_MPI
+  // The host buffers never move, so the requests can be created once for all
+  const auto mpi_type = get_mpi_type<Scalar>();
+  int send_offset = 0;
+  int recv_offset = 0;
+  for (const auto& n : m_neighbors) {
+    if (n.rank==m_comm.rank()) {
+      continue;
+    }
+    const int scount = n.send_ids.size()*nvals;
+    const int rcount = n.recv_ids.size()*nvals;
+    m_send_reqs.emplace_back();
+    m_recv_reqs.emplace_back();
+    MPI_Send_init(m_send_buf_h.data()+send_offset,scount,mpi_type,
+                  n.rank,m_tag,m_comm.mpi_comm(),&m_send_reqs.back());
+    MPI_Recv_init(m_recv_buf_h.data()+recv_offset,rcount,mpi_type,
+                  n.rank,m_tag,m_comm.mpi_comm(),&m_recv_reqs.back());
+    send_offset += scount;
+    recv_offset += rcount;
+  }
+#endif
+
+  m_nvals = nvals;
+}
+
+template<typename ScalarT, typename DeviceT>
+template<typename ViewT>
+void HaloExchange<ScalarT,DeviceT>::start (const ViewT& field)
+{
+  check_field(field,"start");
+  EKAT_REQUIRE_MSG (not m_started,
+      "Error! HaloExchange::start called twice without calling finish.\n");
+
+  const int nvals = m_nvals;
+  const auto ids = m_send_ids;
+  const auto buf = m_send_buf;
+  Kokkos::parallel_for("HaloExchange::pack",
+                       RangePolicy(0,ids.extent_int(0)*nvals),
+                       KOKKOS_LAMBDA(const int idx) {
+    const int i = idx / nvals;
+    const int k = idx % nvals;
+    buf(idx) = field(ids(i),k);
+  });
+
+#ifdef EKAT_ENABLE_MPI
+  // Wait for the pack kernel (and the unpack kernel of the previous exchange,
+  // which, on host devices, reads the same buffer the recvs write into)
+  Kokkos::fence();
+  if (m_num_remote_send>0) {
+    const Kokkos::pair<int,int> remote(0,m_num_remote_send*nvals);
+    Kokkos::deep_copy(Kokkos::subview(m_send_buf_h,remote),
+                      Kokkos::subview(m_send_buf,remote));
+  }
+  // Some MPI implementations reject a null array of requests, even if empty
+  if (m_recv_reqs.size()>0) {
+    MPI_Startall(m_recv_reqs.size(),m_recv_reqs.data());
+    MPI_Startall(m_send_reqs.size(),m_send_reqs.data());
+  }
+#endif
+
+  m_started = true;
+}
+
+template<typename ScalarT, typename DeviceT>
+template<typename ViewT>
+void HaloExchange<ScalarT,DeviceT>::finish (const ViewT& field)
+{
+  check_field(field,"finish");
+  EKAT_REQUIRE_MSG (m_started,
+      "Error! HaloExchange::finish called without calling start first.\n");
+
+  const int nvals = m_nvals;
+
+#ifdef EKAT_ENABLE_MPI
+  MPI_Waitall(m_recv_reqs.size(),m_recv_reqs.data(),MPI_STATUSES_IGNORE);
+  if (m_num_remote_recv>0) {
+    const Kokkos::pair<int,int> remote(0,m_num_remote_recv*nvals);
+    Kokkos::deep_copy(Kokkos::subview(m_recv_buf,remote),
+                      Kokkos::subview(m_recv_buf_h,remote));
+  }
+#endif
+
+  // The exchange with self (if any) is the last chunk of both buffers
+  const int nself = m_recv_ids.extent_int(0) - m_num_remote_recv;
+  if (nself>0) {
+    const Kokkos::pair<int,int> self_send(m_num_remote_send*nvals,
+                                          m_send_buf.extent_int(0));
+    const Kokkos::pair<int,int> self_recv(m_num_remote_recv*nvals,
+                                          m_recv_buf.extent_int(0));
+    Kokkos::deep_copy(Kokkos::subview(m_recv_buf,self_recv),
+                      Kokkos::subview(m_send_buf,self_send));
+  }
+
+  const auto ids = m_recv_ids;
+  const auto buf = m_recv_buf;
+  Kokkos::parallel_for("HaloExchange::unpack",
+                       RangePolicy(0,ids.extent_int(0)*nvals),
+                       KOKKOS_LAMBDA(const int idx) {
+    const int i = idx / nvals;
+    const int k = idx % nvals;
+    field(ids(i),k) = buf(idx);
+  });
+
+#ifdef EKAT_ENABLE_MPI
+  // The send buffer is rewritten by the next start, so sends must be completed
+  MPI_Waitall(m_send_reqs.size(),m_send_reqs.data(),MPI_STATUSES_IGNORE);
+#endif
+
+  m_started = false;
+}
+
+template<typename ScalarT, typename DeviceT>
+template<typename ViewT>
+void HaloExchange<ScalarT,DeviceT>::
+check_field (const ViewT& field, const std::string& method) const
+{
+  static_assert (ViewT::rank==2,
+      "Error! HaloExchange only supports rank-2 fields (entry,k).\n");
+  EKAT_REQUIRE_MSG (is_setup(),
+      "Error! HaloExchange::" + method + " called before setup.\n");
+  EKAT_REQUIRE_MSG (field.extent_int(1)==m_nvals,
+      "Error! Field has the wrong number of values per entry.\n"
+      "  - expected: " + std::to_string(m_nvals) + "\n"
+      "  - field extent(1): " + std::to_string(field.extent_int(1)) + "\n");
+  EKAT_REQUIRE_MSG (field.extent_int(0)>m_max_id,
+      "Error! Field is too small for the registered entries.\n"
+      "  - max entry id: " + std::to_string(m_max_id) + "\n"
+      "  - field extent(0): " + std::to_string(field.extent_int(0)) + "\n");
+}
+
+} // namespace ekat
+
+#endif // EKAT_HALO_EXCHANGE_HPP
@@ -0,0 +1,103 @@
+#include "ekat/mpi/ekat_hierarchical_comm.hpp"
+
+// This file is compiled with and without MPI support. In the latter case,
+// ranks (if more than one) are threads, so collectives need not be staged.
+
+namespace ekat
+{
+
+HierarchicalComm::HierarchicalComm (const Comm& comm)
+ : HierarchicalComm(comm,comm.split_shared(),true)
+{
+  // Nothing to do here
+}
+
+HierarchicalComm::HierarchicalComm (const Comm& comm, const Comm& node_comm)
+ : HierarchicalComm(comm,node_comm,false)
+{
+  // Nothing to do here
+}
+
+HierarchicalComm::HierarchicalComm (const Comm& comm, const Comm& node_comm,
+                                    const bool owns_node_comm)
+ : m_comm(comm)
+ , m_node_comm(node_comm)
+ , m_owns_node_comm(owns_node_comm)
+{
+  setup();
+}
+
+HierarchicalComm::~HierarchicalComm ()
+{
+  m_leaders_comm.free_mpi_comm();
+  if (m_owns_node_comm) {
+    m_node_comm.free_mpi_comm();
+  }
+}
+
+const Comm& HierarchicalComm::leaders_comm () const
+{
+  EKAT_REQUIRE_MSG (am_i_leader(),
+      "Error! The leaders comm is only available on the node leaders.\n");
+  return m_leaders_comm;
+}
+
+int HierarchicalComm::node_id (const int rank) const
+{
+  check_rank(rank);
+  return m_node_ids[rank];
+}
+
+int HierarchicalComm::node_rank (const int rank) const
+{
+  check_rank(rank);
+  return m_node_ranks[rank];
+}
+
+void HierarchicalComm::setup ()
+{
+  // Leaders are ordered as in the original comm, and non-leaders are left out
+#ifdef EKAT_ENABLE_MPI
+  MPI_Comm leaders;
+  MPI_Comm_split(m_comm.mpi_comm(),am_i_leader() ? 0 : MPI_UNDEFINED,
+                 m_comm.rank(),&leaders);
+  if (am_i_leader()) {
+    m_leaders_comm.reset_mpi_comm(leaders);
+  }
+#else
+  // Non-leaders get a comm too, but never use it
+  m_leaders_comm = m_comm.split(am_i_leader() ? 0 : 1);
+#endif
+
+  // Only the leaders know the node id and number of nodes
+  int node_info[2] = {m_leaders_comm.rank(), m_leaders_comm.size()};
+  m_node_comm.broadcast(node_info,2,0);
+  m_node_id   = node_info[0];
+  m_num_nodes = node_info[1];
+
+  std::vector<int> all_info(2*m_comm.size());
+  const int my_info[2] = {m_node_id, m_node_comm.rank()};
+  m_comm.all_gather(my_info,all_info.data(),2);
+  m_node_ids.resize(m_comm.size());
+  m_node_ranks.resize(m_comm.size());
+  for (int pid=0; pid<m_comm.size(); ++pid) {
+    m_node_ids[pid]   = all_info[2*pid];
+    m_node_ranks[pid] = all_info[2*pid+1];
+  }
+
+  // Make sure the node comm was indeed a split of the comm
+  int num_ranks_on_nodes = am_i_leader() ? m_node_comm.size() : 0;
+  m_comm.all_reduce(&num_ranks_on_nodes,1,MPI_SUM);
+  EKAT_REQUIRE_MSG (num_ranks_on_nodes==m_comm.size(),
+      "Error! The node comms do not partition the comm.\n");
+}
+
+void HierarchicalComm::check_rank (const int rank) const
+{
+  EKAT_REQUIRE_MSG (rank>=0 && rank<m_comm.size(),
+      "Error! Invalid rank.\n"
+      "  - rank     : " + std::to_string(rank) + "\n"
+      "  - comm size: " + std::to_string(m_comm.size()) + "\n");
+}
+
+} // namespace ekat
@@ -0,0 +1,176 @@
+#ifndef EKAT_HIERARCHICAL_COMM_HPP
+#define EKAT_HIERARCHICAL_COMM_HPP
+
+#include "ekat/mpi/ekat_comm.hpp"
+#include "ekat/ekat_assert.hpp"
+
+#include <string>
+#include <vector>
+
+namespace ekat
+{
+
+/*
+ * A node-aware view of a Comm
+ *
+ * The ranks of the comm are grouped in nodes (by default, the groups of ranks
+ * that can share memory, see Comm::split_shared). The first rank of each node
+ * is the node leader, and the leaders form their own comm, where the rank of
+ * each leader is the id of its node.
+ *
+ * Collectives are done in stages: within the node, among the leaders, and
+ * within the node again. With many ranks per node, only one message per node
+ * goes through the network, which reduces the latency of small collectives.
+ * With a single node, or a single rank per node, there is nothing to stage,
+ * and collectives are done directly on the node comm or on the comm.
+ *
+ * The comms created by a HierarchicalComm (the leaders comm, and the node comm
+ * if not given) are freed on destruction, so it cannot be copied.
+ *
+ * Note: the intra-node stage changes the order in which the reduction op is
+ * applied, so it must be associative and commutative, and floating point
+ * results may differ (in the last bits) from Comm::all_reduce.
+ */
+
+class HierarchicalComm
+{
+public:
+  // Group ranks by shared-memory node
+  explicit HierarchicalComm (const Comm& comm);
+
+  // Group ranks according to the given node comm, which must be a split of
+  // comm (e.g., to emulate nodes of a given size).
+  HierarchicalComm (const Comm& comm, const Comm& node_comm);
+
+  HierarchicalComm (const HierarchicalComm&) = delete;
+  HierarchicalComm& operator= (const HierarchicalComm&) = delete;
+
+  ~HierarchicalComm ();
+
+  const Comm& comm () const { return m_comm; }
+  const Comm& node_comm () const { return m_node_comm; }
+
+  // The comm of the node leaders. Only available on the leaders.
+  const Comm& leaders_comm () const;
+
+  bool am_i_leader () const { return m_node_comm.rank()==0; }
+  int num_nodes () const { return m_num_nodes; }
+  int node_id () const { return m_node_id; }
+
+  // Node id and rank within the node of a rank of comm()
+  int node_id (const int rank) const;
+  int node_rank (const int rank) const;
+
+  // Same semantics as the corresponding Comm methods
+  template<typename T>
+  void all_reduce (const T* my_vals, T* result, const int count, const MPI_Op op) const;
+  template<typename T>
+  void all_reduce (T* inout_vals, const int count, const MPI_Op op) const;
+
+  template<typename T>
+  void broadcast (T* vals, const int count, const int root) const;
+
+private:
+  HierarchicalComm (const Comm& comm, const Comm& node_comm, const bool owns_node_comm);
+
+  void setup ();
+  void check_rank (const int rank) const;
+
+  Comm  m_comm;
+  Comm  m_node_comm;
+  Comm  m_leaders_comm;
+
+  int   m_num_nodes;
+  int   m_node_id;
+
+  // Whether m_node_comm was created here (rather than given by the user)
+  bool  m_owns_node_comm;
+
+  // For each rank of m_comm, its node id and rank within the node
+  std::vector<int>  m_node_ids;
+  std::vector<int>  m_node_ranks;
+};
+
+// ========================== IMPLEMENTATION ========================== //
+
+template<typename T>
+void HierarchicalComm::all_reduce (const T* my_vals, T* result, const int count, const MPI_Op op) const
+{
+#ifdef EKAT_ENABLE_MPI
+  if (m_num_nodes==1) {
+    m_node_comm.all_reduce(my_vals,result,count,op);
+  } else if (m_num_nodes==m_comm.size()) {
+    m_comm.all_reduce(my_vals,result,count,op);
+  } else {
+    MPI_Reduce(my_vals,result,count,get_mpi_type<T>(),op,0,m_node_comm.mpi_comm());
+    if (am_i_leader()) {
+      m_leaders_comm.all_reduce(result,count,op);
+    }
+    m_node_comm.broadcast(result,count,0);
+  }
+#else
+  m_comm.all_reduce(my_vals,result,count,op);
+#endif
+}
+
+template<typename T>
+void HierarchicalComm::all_reduce (T* inout_vals, const int count, const MPI_Op op) const
+{
+#ifdef EKAT_ENABLE_MPI
+  if (m_num_nodes==1) {
+    m_node_comm.all_reduce(inout_vals,count,op);
+  } else if (m_num_nodes==m_comm.size()) {
+    m_comm.all_reduce(inout_vals,count,op);
+  } else {
+    const auto type = get_mpi_type<T>();
+    const auto node = m_node_comm.mpi_comm();
+    if (am_i_leader()) {
+      MPI_Reduce(MPI_IN_PLACE,inout_vals,count,type,op,0,node);
+      m_leaders_comm.all_reduce(inout_vals,count,op);
+    } else {
+      MPI_Reduce(inout_vals,nullptr,count,type,op,0,node);
+    }
+    m_node_comm.broadcast(inout_vals,count,0);
+  }
+#else
+  m_comm.all_reduce(inout_vals,count,op);
+#endif
+}
+
+template<typename T>
+void HierarchicalComm::broadcast (T* vals, const int count, const int root) const
+{
+  check_rank(root);
+
+#ifdef EKAT_ENABLE_MPI
+  if (m_num_nodes==1) {
+    // The node comm may order the ranks differently
+    m_node_comm.broadcast(vals,count,m_node_ranks[root]);
+  } else if (m_num_nodes==m_comm.size()) {
+    m_comm.broadcast(vals,count,root);
+  } else {
+    // If the root is not the leader of its node, first send the data to its leader
+    const int root_node = m_node_ids[root];
+    const int root_node_rank = m_node_ranks[root];
+    const bool on_root_node = m_node_id==root_node;
+    if (on_root_node && root_node_rank!=0) {
+      m_node_comm.broadcast(vals,count,root_node_rank);
+    }
+
+    if (am_i_leader()) {
+      m_leaders_comm.broadcast(vals,count,root_node);
+    }
+
+    // The root node is already done, unless the root was its leader
+    if (not on_root_node || root_node_rank==0) {
+      m_node_comm.broadcast(vals,count,0);
+    }
+  }
+#else
+  m_comm.broadcast(vals,count,root);
+#endif
+}
+
+} // namespace ekat
+
+#endif // EKAT_HIERARCHICAL_COMM_HPP
@@ -0,0 +1,147 @@
+#ifndef EKAT_NODE_SHARED_ARRAY_HPP
+#define EKAT_NODE_SHARED_ARRAY_HPP
+
+#include "ekat/mpi/ekat_comm.hpp"
+#include "ekat/ekat_assert.hpp"
+
+#include <Kokkos_Core.hpp>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ekat
+{
+
+/*
+ * A host array stored once per node, and shared by all ranks of the node
+ *
+ * This is meant for read-only data (e.g., lookup tables), which would otherwise
+ * be replicated on every rank. The array is allocated in an MPI shared-memory
+ * window on a node comm (see Comm::split_shared and HierarchicalComm::node_comm).
+ * The first rank of the node comm (the writer) fills the array, then all ranks
+ * call sync, after which all of them can read it. E.g.,
+ *
+ *   NodeSharedArray<double> table(hcomm.node_comm(),n);
+ *   if (table.am_i_writer()) {
+ *     read_table(filename,table.data());
+ *   }
+ *   table.sync();
+ *
+ * Without MPI support, the writer allocates the array on the host, and shares
+ * it with the other thread ranks, if any (see run_on_thread_ranks).
+ */
+
+template<typename T>
+class NodeSharedArray
+{
+public:
+  static_assert (std::is_trivially_copyable<T>::value,
+      "Error! NodeSharedArray requires a trivially copyable type.\n");
+
+  using host_view = Kokkos::View<T*,Kokkos::HostSpace,Kokkos::MemoryUnmanaged>;
+
+  // Collective on node_comm, which must contain only ranks that can share memory
+  NodeSharedArray (const Comm& node_comm, const int size);
+
+  NodeSharedArray (const NodeSharedArray&) = delete;
+  NodeSharedArray& operator= (const NodeSharedArray&) = delete;
+
+  // Collective on the node comm
+  ~NodeSharedArray ();
+
+  const Comm& get_comm () const { return m_comm; }
+
+  bool am_i_writer () const { return m_comm.rank()==0; }
+
+  int size () const { return m_size; }
+
+  // Only the writer should modify the data, and only before calling sync
+  T* data () const { return m_data; }
+
+  host_view view () const { return host_view(m_data,m_size); }
+
+  // Collective on the node comm. Makes the writes of the writer visible to all
+  // ranks, and must be called before other ranks read the data.
+  void sync () const;
+
+private:
+  Comm  m_comm;
+  int   m_size;
+  T*    m_data = nullptr;
+
+#ifdef EKAT_ENABLE_MPI
+  MPI_Win m_win;
+#else
+  std::vector<T> m_storage;
+#endif
+};
+
+// ========================== IMPLEMENTATION ========================== //
+
+template<typename T>
+NodeSharedArray<T>::
+NodeSharedArray (const Comm& node_comm, const int size)
+ : m_comm (node_comm)
+ , m_size (size)
+{
+  EKAT_REQUIRE_MSG (size>=0,
+      "Error! Invalid size for NodeSharedArray.\n"
+      "  - size: " + std::to_string(size) + "\n");
+
+#ifdef EKAT_ENABLE_MPI
+  // Only the writer allocates memory. The other ranks get a pointer to it.
+  const MPI_Aint my_bytes = am_i_writer() ? MPI_Aint(size)*sizeof(T) : 0;
+  MPI_Win_allocate_shared(my_bytes,sizeof(T),MPI_INFO_NULL,m_comm.mpi_comm(),&m_data,&m_win);
+  if (not am_i_writer()) {
+    MPI_Aint bytes;
+    int disp_unit;
+    MPI_Win_shared_query(m_win,0,&bytes,&disp_unit,&m_data);
+  }
+
+  // Keep a passive target epoch open for the whole lifetime of the window,
+  // so that sync only needs memory barriers and a barrier.
+  MPI_Win_lock_all(MPI_MODE_NOCHECK,m_win);
+#else
+  if (am_i_writer()) {
+    m_storage.resize(size);
+    m_data = m_storage.data();
+  }
+  m_comm.broadcast(reinterpret_cast<char*>(&m_data),sizeof(T*),0);
+#endif
+}
+
+template<typename T>
+NodeSharedArray<T>::~NodeSharedArray ()
+{
+#ifdef EKAT_ENABLE_MPI
+  // Windows can't be freed after MPI_Finalize
+  int finalized;
+  MPI_Finalized(&finalized);
+  if (not finalized) {
+    MPI_Win_unlock_all(m_win);
+    MPI_Win_free(&m_win);
+  }
+#else
+  // The writer must not release the array while other ranks may read it
+  try {
+    m_comm.barrier();
+  } catch (...) {}
+#endif
+}
+
+template<typename T>
+void NodeSharedArray<T>::sync () const
+{
+#ifdef EKAT_ENABLE_MPI
+  MPI_Win_sync(m_win);
+  m_comm.barrier();
+  MPI_Win_sync(m_win);
+#else
+  m_comm.barrier();
+#endif
+}
+
+} // namespace ekat
+
+#endif // EKAT_NODE_SHARED_ARRAY_HPP
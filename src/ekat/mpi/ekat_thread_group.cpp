@@ -0,0 +1,307 @@
+#include "ekat/mpi/ekat_comm.hpp"
+#include "ekat/ekat_assert.hpp"
+
+#include <exception>
+#include <thread>
+
+// This file is compiled when EKAT_ENABLE_MPI is not defined. It implements
+// the thread ranks backend of ekat::Comm.
+
+namespace ekat
+{
+
+namespace impl
+{
+
+void ThreadContext::check_aborted () const
+{
+  EKAT_REQUIRE_MSG (not aborted,
+      "Error! Another thread rank failed, interrupting this one.\n");
+}
+
+void ThreadRecv::wait ()
+{
+  std::unique_lock<std::mutex> lock(ctx->mutex);
+  ctx->cv.wait(lock,[&]{ return done || ctx->aborted; });
+  if (not done) {
+    ctx->check_aborted();
+  }
+}
+
+bool ThreadRecv::test ()
+{
+  std::lock_guard<std::mutex> lock(ctx->mutex);
+  return done;
+}
+
+ThreadGroup::ThreadGroup (const std::shared_ptr<ThreadContext>& ctx, const int size)
+ : m_ctx  (ctx)
+ , m_size (size)
+ , m_slots(size,nullptr)
+ , m_collectives_posted(size,0)
+{
+  // Nothing to do here
+}
+
+void ThreadGroup::barrier ()
+{
+  std::unique_lock<std::mutex> lock(m_ctx->mutex);
+  m_ctx->check_aborted();
+  const auto generation = m_generation;
+  if (++m_arrived==m_size) {
+    m_arrived = 0;
+    ++m_generation;
+    m_ctx->cv.notify_all();
+  } else {
+    m_ctx->cv.wait(lock,[&]{ return m_generation!=generation || m_ctx->aborted; });
+    if (m_generation==generation) {
+      m_ctx->check_aborted();
+    }
+  }
+}
+
+void ThreadGroup::exchange (const int rank, const void* mine,
+                            const std::function<void(const slots_t&)>& f)
+{
+  // The first barrier publishes the slots, and the second one keeps them valid
+  // (and prevents the next exchange from overwriting them) while ranks read them.
+  m_slots[rank] = mine;
+  barrier();
+  f(m_slots);
+  barrier();
+}
+
+std::shared_ptr<ThreadGroup>
+ThreadGroup::split (const int rank, const int color, const int key, int& new_rank)
+{
+  struct Entry {
+    int color;
+    int key;
+    std::shared_ptr<ThreadGroup> group;
+  };
+  Entry mine {color,key,nullptr};
+
+  // The first rank of each color creates the new group...
+  int new_size = 0;
+  bool first = true;
+  new_rank = 0;
+  exchange(rank,&mine,[&](const slots_t& all) {
+    for (int r=0; r<m_size; ++r) {
+      const auto& e = *static_cast<const Entry*>(all[r]);
+      if (e.color==color) {
+        ++new_size;
+        new_rank += e.key<key || (e.key==key && r<rank);
+        first &= r>=rank;
+      }
+    }
+  });
+  if (first) {
+    mine.group = std::make_shared<ThreadGroup>(m_ctx,new_size);
+  }
+
+  // ...and the other ranks of that color get it from there
+  std::shared_ptr<ThreadGroup> group;
+  exchange(rank,&mine,[&](const slots_t& all) {
+    for (int r=0; r<m_size && group==nullptr; ++r) {
+      const auto& e = *static_cast<const Entry*>(all[r]);
+      if (e.color==color) {
+        group = e.group;
+      }
+    }
+  });
+  return group;
+}
+
+void ThreadGroup::send (const int src, const int dst, const int tag,
+                        const void* data, const std::size_t bytes)
+{
+  EKAT_REQUIRE_MSG (dst>=0 && dst<m_size,
+      "Error! Invalid destination rank.\n"
+      "  - dest     : " + std::to_string(dst) + "\n"
+      "  - comm size: " + std::to_string(m_size) + "\n");
+
+  std::lock_guard<std::mutex> lock(m_ctx->mutex);
+  const key_t k (src,dst,tag);
+  auto& recvs = m_recvs[k];
+  if (recvs.empty()) {
+    const char* begin = static_cast<const char*>(data);
+    m_messages[k].emplace_back(begin,begin+bytes);
+    return;
+  }
+
+  auto recv = recvs.front();
+  recvs.pop_front();
+  EKAT_REQUIRE_MSG (bytes<=recv->bytes,
+      "Error! Message larger than the receive buffer.\n"
+      "  - message bytes: " + std::to_string(bytes) + "\n"
+      "  - buffer bytes : " + std::to_string(recv->bytes) + "\n");
+  std::memcpy(recv->buf,data,bytes);
+  recv->done = true;
+  m_ctx->cv.notify_all();
+}
+
+std::shared_ptr<ThreadRecv>
+ThreadGroup::post_recv (const int src, const int dst, const int tag,
+                        void* buf, const std::size_t bytes)
+{
+  EKAT_REQUIRE_MSG (src>=0 && src<m_size,
+      "Error! Invalid source rank.\n"
+      "  - src      : " + std::to_string(src) + "\n"
+      "  - comm size: " + std::to_string(m_size) + "\n");
+
+  auto recv = std::make_shared<ThreadRecv>();
+  recv->ctx = m_ctx;
+  recv->buf = buf;
+  recv->bytes = bytes;
+
+  std::lock_guard<std::mutex> lock(m_ctx->mutex);
+  const key_t k (src,dst,tag);
+  auto& msgs = m_messages[k];
+  if (msgs.empty()) {
+    m_recvs[k].push_back(recv);
+    return recv;
+  }
+
+  const auto& msg = msgs.front();
+  EKAT_REQUIRE_MSG (msg.size()<=bytes,
+      "Error! Message larger than the receive buffer.\n"
+      "  - message bytes: " + std::to_string(msg.size()) + "\n"
+      "  - buffer bytes : " + std::to_string(bytes) + "\n");
+  std::memcpy(buf,msg.data(),msg.size());
+  msgs.pop_front();
+  recv->done = true;
+  return recv;
+}
+
+std::shared_ptr<ThreadRecv> ThreadGroup::ibarrier (const int rank)
+{
+  return post_collective(rank,nullptr,[](const slots_t&){},nullptr);
+}
+
+std::shared_ptr<ThreadRecv>
+ThreadGroup::post_collective (const int rank, const void* mine,
+                              const read_t& read, const write_t& write)
+{
+  auto req = std::make_shared<ThreadRecv>();
+  req->ctx = m_ctx;
+  req->buf = nullptr;
+  req->bytes = 0;
+
+  std::lock_guard<std::mutex> lock(m_ctx->mutex);
+  m_ctx->check_aborted();
+  const auto it = m_collectives.emplace(m_collectives_posted[rank]++,PostedCollective()).first;
+  auto& c = it->second;
+  if (c.posted==0) {
+    c.slots.resize(m_size,nullptr);
+    c.reads.resize(m_size);
+    c.writes.resize(m_size);
+    c.requests.resize(m_size);
+  }
+  c.slots[rank] = mine;
+  c.reads[rank] = read;
+  c.writes[rank] = write;
+  c.requests[rank] = req;
+  if (++c.posted<m_size) {
+    return req;
+  }
+
+  // All ranks posted: run the collective for all of them
+  for (const auto& f : c.reads) {
+    f(c.slots);
+  }
+  for (const auto& f : c.writes) {
+    if (f) {
+      f();
+    }
+  }
+  for (auto& r : c.requests) {
+    r->done = true;
+  }
+  m_collectives.erase(it);
+  m_ctx->cv.notify_all();
+  return nullptr;
+}
+
+void ThreadGroup::abort ()
+{
+  std::lock_guard<std::mutex> lock(m_ctx->mutex);
+  m_ctx->aborted = true;
+  m_ctx->cv.notify_all();
+}
+
+int ThreadGroup::total_count (const std::vector<int>& counts, const int end)
+{
+  long long total = 0;
+  for (int r=0; r<end; ++r) {
+    total += counts[r];
+  }
+  EKAT_REQUIRE_MSG (total<=std::numeric_limits<int>::max(),
+      "Error! Total count exceeds the int range.\n"
+      "  - total count: " + std::to_string(total) + "\n");
+  return static_cast<int>(total);
+}
+
+ThreadWorld& thread_world ()
+{
+  thread_local ThreadWorld world;
+  return world;
+}
+
+std::mutex& thread_kokkos_mutex ()
+{
+  static std::mutex m;
+  return m;
+}
+
+} // namespace impl
+
+void run_on_thread_ranks (const int nranks, const std::function<void(const Comm&)>& f)
+{
+  EKAT_REQUIRE_MSG (nranks>0,
+      "Error! Invalid number of thread ranks.\n"
+      "  - nranks: " + std::to_string(nranks) + "\n");
+  EKAT_REQUIRE_MSG (impl::thread_world().group==nullptr,
+      "Error! Thread ranks cannot be nested.\n");
+
+  auto ctx = std::make_shared<impl::ThreadContext>();
+  auto world = std::make_shared<impl::ThreadGroup>(ctx,nranks);
+
+  // Keep the first exception, which is the original failure: the others
+  // are thrown by ranks interrupted by the abort.
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto run_rank = [&](const int rank) {
+    auto& my_world = impl::thread_world();
+    my_world.group = world;
+    my_world.rank = rank;
+    try {
+      f(Comm(MPI_COMM_WORLD));
+    } catch (...) {
+      {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (not error) {
+          error = std::current_exception();
+        }
+      }
+      world->abort();
+    }
+    my_world = impl::ThreadWorld();
+  };
+
+  // The calling thread acts as rank 0
+  std::vector<std::thread> threads;
+  for (int rank=1; rank<nranks; ++rank) {
+    threads.emplace_back(run_rank,rank);
+  }
+  run_rank(0);
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace ekat
@@ -0,0 +1,395 @@
+#ifndef EKAT_THREAD_GROUP_HPP
+#define EKAT_THREAD_GROUP_HPP
+
+// This header is included by ekat_comm.hpp when EKAT_ENABLE_MPI is not defined,
+// and relies on the MPI stand-ins defined there. It implements the Comm
+// operations for ranks that run as threads of the same process (see
+// run_on_thread_ranks), using shared memory and barriers.
+
+#include "ekat/ekat_assert.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace ekat
+{
+
+namespace impl
+{
+
+// The state shared by all the groups created within one run of thread ranks.
+// A single lock guards all of it, so that aborting the run can wake up all
+// the ranks, regardless of which group they are waiting on.
+struct ThreadContext
+{
+  std::mutex              mutex;
+  std::condition_variable cv;
+  bool                    aborted = false;
+
+  // Throws if the run was aborted. Must be called with the lock held.
+  void check_aborted () const;
+};
+
+// A posted receive, completed when a matching message is sent. Also used for
+// nonblocking collectives, completed when all ranks posted their contribution.
+struct ThreadRecv
+{
+  std::shared_ptr<ThreadContext> ctx;
+  void*       buf;
+  std::size_t bytes;
+  bool        done = false;
+
+  void wait ();
+  bool test ();
+};
+
+// Apply a reduction op to two values
+template<typename T>
+T thread_reduce_op (const T& a, const T& b, const MPI_Op op, std::false_type /* is_integral */)
+{
+  switch (op) {
+    case MPI_SUM:  return a + b;
+    case MPI_PROD: return a * b;
+    case MPI_MAX:  return std::max(a,b);
+    case MPI_MIN:  return std::min(a,b);
+    case MPI_LAND: return static_cast<T>(a && b);
+    case MPI_LOR:  return static_cast<T>(a || b);
+    case MPI_LXOR: return static_cast<T>(!a != !b);
+    default: break;
+  }
+  EKAT_ERROR_MSG ("Error! Reduction op not supported by thread ranks.\n"
+                  "  - op: " + std::to_string(static_cast<int>(op)) + "\n");
+  return a;
+}
+
+template<typename T>
+T thread_reduce_op (const T& a, const T& b, const MPI_Op op, std::true_type /* is_integral */)
+{
+  switch (op) {
+    case MPI_BAND: return static_cast<T>(a & b);
+    case MPI_BOR:  return static_cast<T>(a | b);
+    case MPI_BXOR: return static_cast<T>(a ^ b);
+    default:       return thread_reduce_op(a,b,op,std::false_type());
+  }
+}
+
+class ThreadGroup
+{
+public:
+  using slots_t = std::vector<const void*>;
+
+  ThreadGroup (const std::shared_ptr<ThreadContext>& ctx, const int size);
+
+  ThreadGroup (const ThreadGroup&) = delete;
+  ThreadGroup& operator= (const ThreadGroup&) = delete;
+
+  int size () const { return m_size; }
+
+  void barrier ();
+
+  // Each rank posts a pointer, then calls f with the pointers posted by all
+  // ranks. The pointed data must remain valid until all ranks returned from f.
+  void exchange (const int rank, const void* mine, const std::function<void(const slots_t&)>& f);
+
+  // Collectives, with the semantics of the corresponding MPI calls. The input
+  // and output buffers can alias each other (as they do for in-place calls).
+  template<typename T>
+  void broadcast (const int rank, T* vals, const int count, const int root);
+
+  // If scan=true, only ranks up to the calling one contribute to the result.
+  // Contributions are always combined in rank order, so all ranks get the
+  // same bits, regardless of the timing of the threads.
+  template<typename T>
+  void reduce (const int rank, const T* my_vals, T* result, const int count,
+               const MPI_Op op, const bool scan);
+
+  template<typename T>
+  void all_gather (const int rank, const T* my_vals, T* all_vals, const int count);
+
+  // Variable-count collectives, with the same semantics as the Comm::*_impl methods
+  template<typename T, typename Alloc>
+  void gatherv (const int rank, const T* my_vals, const int my_count, const int root,
+                std::vector<int>& counts, const Alloc& alloc);
+  template<typename T, typename Alloc>
+  void all_gatherv (const int rank, const T* my_vals, const int my_count,
+                    std::vector<int>& counts, const Alloc& alloc);
+  template<typename T, typename Alloc>
+  void scatterv (const int rank, const T* all_vals, const std::vector<int>& counts,
+                 const int root, const Alloc& alloc);
+  template<typename T, typename Alloc>
+  void all_to_allv (const int rank, const T* send_vals, const std::vector<int>& send_counts,
+                    std::vector<int>& recv_counts, const Alloc& alloc);
+
+  // Nonblocking collectives. They never block: the last rank to post its
+  // contribution runs the operation for all ranks, and completes their requests.
+  // Like in MPI, they are matched in the order each rank posts them. The
+  // returned request is null if the collective completed within the call.
+  template<typename T>
+  std::shared_ptr<ThreadRecv> ibroadcast (const int rank, T* vals, const int count, const int root);
+  template<typename T>
+  std::shared_ptr<ThreadRecv> iall_reduce (const int rank, const T* my_vals, T* result,
+                                           const int count, const MPI_Op op);
+  template<typename T>
+  std::shared_ptr<ThreadRecv> iall_gather (const int rank, const T* my_vals, T* all_vals, const int count);
+  std::shared_ptr<ThreadRecv> ibarrier (const int rank);
+
+  // Collective. Ranks with the same color end up in the same new group, ordered
+  // by key (and by rank, for equal keys).
+  std::shared_ptr<ThreadGroup> split (const int rank, const int color, const int key, int& new_rank);
+
+  // The message is copied, so sends never block. Receives are matched with
+  // messages with the same source and tag in the order they are posted.
+  void send (const int src, const int dst, const int tag,
+             const void* data, const std::size_t bytes);
+  std::shared_ptr<ThreadRecv> post_recv (const int src, const int dst, const int tag,
+                                         void* buf, const std::size_t bytes);
+
+  // Wake up all ranks of the run waiting on any group, and make them throw
+  void abort ();
+
+private:
+  struct Chunk {
+    const void*             vals;
+    int                     count;
+    const std::vector<int>* counts;
+  };
+
+  // The sum of the counts, checking that it fits in an int
+  static int total_count (const std::vector<int>& counts, const int end);
+
+  // Post the contribution of a rank to its next nonblocking collective. Once all
+  // ranks posted, read is called for each rank with the contributions of all
+  // ranks, and then write (if any) is called for each rank. Since read must not
+  // modify any contribution, outputs aliasing them can only be set by write.
+  using read_t  = std::function<void(const slots_t&)>;
+  using write_t = std::function<void()>;
+  std::shared_ptr<ThreadRecv> post_collective (const int rank, const void* mine,
+                                               const read_t& read, const write_t& write);
+
+  struct PostedCollective {
+    slots_t                                  slots;
+    std::vector<read_t>                      reads;
+    std::vector<write_t>                     writes;
+    std::vector<std::shared_ptr<ThreadRecv>> requests;
+    int                                      posted = 0;
+  };
+
+  std::shared_ptr<ThreadContext>  m_ctx;
+
+  int   m_size;
+
+  // Barrier state
+  int   m_arrived    = 0;
+  long  m_generation = 0;
+
+  slots_t m_slots;
+
+  // Pending messages and receives, for each (src,dst,tag)
+  using key_t = std::tuple<int,int,int>;
+  std::map<key_t,std::deque<std::vector<char>>>           m_messages;
+  std::map<key_t,std::deque<std::shared_ptr<ThreadRecv>>> m_recvs;
+
+  // Nonblocking collectives not posted by all ranks yet, by sequence number,
+  // and the number of nonblocking collectives posted by each rank
+  std::map<long,PostedCollective> m_collectives;
+  std::vector<long>               m_collectives_posted;
+};
+
+// The group and rank of the calling thread in MPI_COMM_WORLD. Outside of
+// run_on_thread_ranks, the group is null.
+struct ThreadWorld
+{
+  std::shared_ptr<ThreadGroup> group;
+  int rank = 0;
+};
+ThreadWorld& thread_world ();
+
+// Kokkos does not support launching work (e.g., the copies of deep_copy, or
+// the initialization of views) from several host threads at once. The Comm
+// overloads for views hold this lock around their Kokkos calls, so that thread
+// ranks can call them concurrently (see lock_kokkos_for_comm in ekat_comm.hpp).
+std::mutex& thread_kokkos_mutex ();
+
+// ========================== IMPLEMENTATION ========================== //
+
+template<typename T>
+void ThreadGroup::broadcast (const int rank, T* vals, const int count, const int root)
+{
+  exchange(rank,vals,[&](const slots_t& all) {
+    if (rank!=root) {
+      const T* root_vals = static_cast<const T*>(all[root]);
+      std::copy(root_vals, root_vals + count, vals);
+    }
+  });
+}
+
+template<typename T>
+void ThreadGroup::reduce (const int rank, const T* my_vals, T* result, const int count,
+                          const MPI_Op op, const bool scan)
+{
+  // Reduce in a temporary, since other ranks may still read my_vals==result
+  std::vector<T> tmp(count);
+  exchange(rank,my_vals,[&](const slots_t& all) {
+    const T* vals = static_cast<const T*>(all[0]);
+    std::copy(vals, vals + count, tmp.begin());
+    const int nranks = scan ? rank+1 : m_size;
+    for (int r=1; r<nranks; ++r) {
+      vals = static_cast<const T*>(all[r]);
+      for (int i=0; i<count; ++i) {
+        tmp[i] = thread_reduce_op(tmp[i],vals[i],op,std::is_integral<T>());
+      }
+    }
+  });
+  std::copy(tmp.begin(), tmp.end(), result);
+}
+
+template<typename T>
+void ThreadGroup::all_gather (const int rank, const T* my_vals, T* all_vals, const int count)
+{
+  // Each rank only writes the slices of all_vals that other ranks do not read
+  exchange(rank,my_vals,[&](const slots_t& all) {
+    for (int r=0; r<m_size; ++r) {
+      const T* vals = static_cast<const T*>(all[r]);
+      if (vals!=all_vals + r*count) {
+        std::copy(vals, vals + count, all_vals + r*count);
+      }
+    }
+  });
+}
+
+template<typename T, typename Alloc>
+void ThreadGroup::gatherv (const int rank, const T* my_vals, const int my_count, const int root,
+                           std::vector<int>& counts, const Alloc& alloc)
+{
+  const Chunk mine {my_vals,my_count,nullptr};
+  exchange(rank,&mine,[&](const slots_t& all) {
+    if (rank!=root) {
+      return;
+    }
+    for (int r=0; r<m_size; ++r) {
+      counts[r] = static_cast<const Chunk*>(all[r])->count;
+    }
+    T* all_vals = alloc(total_count(counts,m_size));
+    for (int r=0; r<m_size; ++r) {
+      const T* vals = static_cast<const T*>(static_cast<const Chunk*>(all[r])->vals);
+      all_vals = std::copy(vals, vals + counts[r], all_vals);
+    }
+  });
+  if (rank!=root) {
+    counts.clear();
+  }
+}
+
+template<typename T, typename Alloc>
+void ThreadGroup::all_gatherv (const int rank, const T* my_vals, const int my_count,
+                               std::vector<int>& counts, const Alloc& alloc)
+{
+  const Chunk mine {my_vals,my_count,nullptr};
+  exchange(rank,&mine,[&](const slots_t& all) {
+    for (int r=0; r<m_size; ++r) {
+      counts[r] = static_cast<const Chunk*>(all[r])->count;
+    }
+    T* all_vals = alloc(total_count(counts,m_size));
+    for (int r=0; r<m_size; ++r) {
+      const T* vals = static_cast<const T*>(static_cast<const Chunk*>(all[r])->vals);
+      all_vals = std::copy(vals, vals + counts[r], all_vals);
+    }
+  });
+}
+
+template<typename T, typename Alloc>
+void ThreadGroup::scatterv (const int rank, const T* all_vals, const std::vector<int>& counts,
+                            const int root, const Alloc& alloc)
+{
+  const Chunk mine {all_vals,0,&counts};
+  exchange(rank,&mine,[&](const slots_t& all) {
+    const auto& root_chunk = *static_cast<const Chunk*>(all[root]);
+    const auto& root_counts = *root_chunk.counts;
+    const T* vals = static_cast<const T*>(root_chunk.vals) + total_count(root_counts,rank);
+    std::copy(vals, vals + root_counts[rank], alloc(root_counts[rank]));
+  });
+}
+
+template<typename T, typename Alloc>
+void ThreadGroup::all_to_allv (const int rank, const T* send_vals, const std::vector<int>& send_counts,
+                               std::vector<int>& recv_counts, const Alloc& alloc)
+{
+  const Chunk mine {send_vals,0,&send_counts};
+  exchange(rank,&mine,[&](const slots_t& all) {
+    for (int r=0; r<m_size; ++r) {
+      recv_counts[r] = (*static_cast<const Chunk*>(all[r])->counts)[rank];
+    }
+    T* recv_vals = alloc(total_count(recv_counts,m_size));
+    for (int r=0; r<m_size; ++r) {
+      const auto& chunk = *static_cast<const Chunk*>(all[r]);
+      const T* vals = static_cast<const T*>(chunk.vals) + total_count(*chunk.counts,rank);
+      recv_vals = std::copy(vals, vals + recv_counts[r], recv_vals);
+    }
+  });
+}
+
+template<typename T>
+std::shared_ptr<ThreadRecv>
+ThreadGroup::ibroadcast (const int rank, T* vals, const int count, const int root)
+{
+  return post_collective(rank,vals,[=](const slots_t& all) {
+    if (rank!=root) {
+      const T* root_vals = static_cast<const T*>(all[root]);
+      std::copy(root_vals, root_vals + count, vals);
+    }
+  },nullptr);
+}
+
+template<typename T>
+std::shared_ptr<ThreadRecv>
+ThreadGroup::iall_reduce (const int rank, const T* my_vals, T* result,
+                          const int count, const MPI_Op op)
+{
+  // Reduce in a temporary, since the reads of other ranks may need my_vals==result
+  auto tmp = std::make_shared<std::vector<T>>(count);
+  const int nranks = m_size;
+  return post_collective(rank,my_vals,[=](const slots_t& all) {
+    const T* vals = static_cast<const T*>(all[0]);
+    std::copy(vals, vals + count, tmp->begin());
+    for (int r=1; r<nranks; ++r) {
+      vals = static_cast<const T*>(all[r]);
+      for (int i=0; i<count; ++i) {
+        (*tmp)[i] = thread_reduce_op((*tmp)[i],vals[i],op,std::is_integral<T>());
+      }
+    }
+  },[=]() {
+    std::copy(tmp->begin(), tmp->end(), result);
+  });
+}
+
+template<typename T>
+std::shared_ptr<ThreadRecv>
+ThreadGroup::iall_gather (const int rank, const T* my_vals, T* all_vals, const int count)
+{
+  // Each rank only writes the slices of all_vals that other ranks do not read
+  const int nranks = m_size;
+  return post_collective(rank,my_vals,[=](const slots_t& all) {
+    for (int r=0; r<nranks; ++r) {
+      const T* vals = static_cast<const T*>(all[r]);
+      if (vals!=all_vals + r*count) {
+        std::copy(vals, vals + count, all_vals + r*count);
+      }
+    }
+  },nullptr);
+}
+
+} // namespace impl
+
+} // namespace ekat
+
+#endif // EKAT_THREAD_GROUP_HPP
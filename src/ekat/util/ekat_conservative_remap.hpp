@@ -0,0 +1,188 @@
+#ifndef EKAT_CONSERVATIVE_REMAP_HPP
+#define EKAT_CONSERVATIVE_REMAP_HPP
+
+#include "ekat/util/ekat_upper_bound.hpp"
+#include "ekat/ekat_assert.hpp"
+#include "ekat/kokkos/ekat_kokkos_utils.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
+#include "ekat/kokkos/ekat_subview_utils.hpp"
+#include "ekat/ekat_pack.hpp"
+#include "ekat/ekat_pack_kokkos.hpp"
+
+namespace ekat {
+
+// Reconstruction used within each source layer
+enum class RemapScheme {
+  PiecewiseConstant,          // First order (PCM)
+  PiecewiseParabolic,         // Colella-Woodward PPM, without monotonicity limiter
+  PiecewiseParabolicLimited   // Colella-Woodward PPM, with monotonicity limiter
+};
+
+/*
+ * ConservativeRemap is the integral-preserving counterpart of LinInterp:
+ * it maps layer averages y1, defined on the km1 layers between the km1+1
+ * interfaces xi1, onto the km2 layers between the km2+1 interfaces xi2.
+ * Within each source layer, the field is reconstructed with a constant or a
+ * parabola, and each target layer gets the average of the reconstruction over
+ * its extent. If the first and last interfaces of xi1 and xi2 coincide, the
+ * column integral is preserved exactly (up to round-off).
+ *
+ * Both xi1 and xi2 must be increasing. Portions of target layers that lie
+ * outside of [xi1(0),xi1(km1)] see the value of the closest source layer.
+ *
+ * As with LinInterp, setup computes, for each target interface, the source
+ * layer that contains it. This depends only on the grids, and is reused by all
+ * the calls to remap (for as many fields as needed).
+ *
+ * Example: remap y1a and y1b from layers xi1 to layers xi2
+ *   Kokkos::parallel_for("remap",
+                           cr.policy(),
+                           KOKKOS_LAMBDA(typename CR::MemberType const& team_member) {
+      const int i = team_member.league_rank();
+
+      auto xi1col = subview(xi1, i);
+      auto xi2col = subview(xi2, i);
+
+      cr.setup(team_member, xi1col, xi2col);
+      team_member.team_barrier();
+
+      cr.remap(team_member, xi1col, xi2col, subview(y1a, i), subview(y2a, i));
+      cr.remap(team_member, xi1col, xi2col, subview(y1b, i), subview(y2b, i));
+    });
+ */
+
+template <typename ScalarT, int PackSize, typename DeviceT=DefaultDevice>
+struct ConservativeRemap
+{
+  //
+  // ------- Types --------
+  //
+
+  // Expose input template args
+  using Scalar = ScalarT;
+  using Device = DeviceT;
+  static constexpr int CR_PACKN = PackSize;
+
+  // Other utility types
+  using KT = KokkosTypes<Device>;
+
+  template <typename S>
+  using view_1d = typename KT::template view_1d<S>;
+  template <typename S>
+  using view_2d = typename KT::template view_2d<S>;
+
+  using ExeSpace    = typename KT::ExeSpace;
+  using MemberType  = typename KT::MemberType;
+  using TeamPolicy  = typename KT::TeamPolicy;
+
+  using Pack    = ekat::Pack<Scalar, CR_PACKN>;
+  using IntPack = ekat::Pack<int, CR_PACKN>;
+
+  //
+  // ------ public API -------
+  //
+
+  // km1 and km2 are the number of layers (so there are km1+1 and km2+1 interfaces).
+  // For PPM schemes, ncol*(km1+1) scalars of workspace are allocated, to store
+  // the reconstructed values at the source interfaces.
+  ConservativeRemap(int ncol, int km1, int km2,
+                    RemapScheme scheme = RemapScheme::PiecewiseParabolicLimited);
+
+  // Simple getters
+  KOKKOS_INLINE_FUNCTION
+  int km1() const { return m_km1; }
+  KOKKOS_INLINE_FUNCTION
+  int km2() const { return m_km2; }
+  KOKKOS_INLINE_FUNCTION
+  RemapScheme scheme() const { return m_scheme; }
+
+  const TeamPolicy& policy() const { return m_policy; }
+
+  // Setup the overlap indices. This must be called before remap. By default, will launch a
+  // TeamVectorRange kernel. By default, the column idx will be team.league_rank(); this can be
+  // overridden by the col argument.
+  template<typename V1, typename V2>
+  KOKKOS_INLINE_FUNCTION
+  void setup(
+    const MemberType& team,
+    const V1& xi1,
+    const V2& xi2,
+    const Int col=-1) const;
+
+  // Same as above except uses a user-provided range boundary struct. The range must
+  // span [0,npack(km2+1)), and will likely be a ThreadVectorRange.
+  template<typename V1, typename V2, typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void setup(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const V1& xi1,
+    const V2& xi2,
+    const Int col=-1) const;
+
+  // Remap layer averages y1 (on xi1) onto layer averages y2 (on xi2). The xi1 and xi2
+  // should match what was given to setup. PPM schemes need a team barrier between the
+  // reconstruction and the remap, so there is no version taking a range boundary.
+  template <typename V1, typename V2, typename V3, typename V4>
+  KOKKOS_INLINE_FUNCTION
+  void remap(
+    const MemberType& team,
+    const V1& xi1,
+    const V2& xi2,
+    const V3& y1,
+    const V4& y2,
+    const Int col=-1) const;
+
+  //
+  // -------- Internal API, data ------
+  //
+ protected:
+
+  template <typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void setup_impl(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const view_1d<const Pack>& xi1,
+    const view_1d<const Pack>& xi2,
+    const Int col) const;
+
+  KOKKOS_INLINE_FUNCTION
+  void remap_impl(
+    const MemberType& team,
+    const view_1d<const Pack>& xi1, const view_1d<const Pack>& xi2, const view_1d<const Pack>& y1,
+    const view_1d<Pack>& y2,
+    const Int col) const;
+
+  // Compute the PPM reconstruction at the source interfaces, and store it in m_edges
+  template <typename ScalarView, typename ConstScalarView>
+  KOKKOS_INLINE_FUNCTION
+  void ppm_edges(
+    const MemberType& team,
+    const ConstScalarView& xi1s,
+    const ConstScalarView& y1s,
+    const ScalarView& edges) const;
+
+  // Integral over [a,b] of the reconstruction within source layer j
+  template <typename ScalarView, typename ConstScalarView>
+  KOKKOS_INLINE_FUNCTION
+  Scalar layer_integral(
+    const int j, const Scalar a, const Scalar b,
+    const ConstScalarView& xi1s,
+    const ConstScalarView& y1s,
+    const ScalarView& edges) const;
+
+  int m_km1;
+  int m_km2;
+  int m_ki2_pack;
+  RemapScheme m_scheme;
+  TeamPolicy m_policy;
+  view_2d<IntPack> m_indx_map; // [xi2_idx] -> index of the xi1 layer containing it
+  view_2d<Scalar>  m_edges;    // [xi1_idx] -> reconstructed value at the xi1 interface (PPM only)
+};
+
+} //namespace ekat
+
+#include "ekat_conservative_remap_impl.hpp"
+
+#endif // EKAT_CONSERVATIVE_REMAP_HPP
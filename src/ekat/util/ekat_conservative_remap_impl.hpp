@@ -0,0 +1,270 @@
+#ifndef EKAT_CONSERVATIVE_REMAP_HPP
+#include "ekat_conservative_remap.hpp"
+#endif
+
+namespace ekat {
+
+// Never include this header directly, only ekat_conservative_remap.hpp should include it
+
+namespace impl {
+
+// Limited slope of layer j, given the widths and averages of layers j-1, j, j+1
+// (Colella and Woodward, 1984, eq. 1.7-1.8)
+template <typename Scalar>
+KOKKOS_INLINE_FUNCTION
+Scalar ppm_slope (const Scalar hm, const Scalar h0, const Scalar hp,
+                  const Scalar qm, const Scalar q0, const Scalar qp)
+{
+  const Scalar dl = q0 - qm;
+  const Scalar dr = qp - q0;
+  if (dl*dr <= 0) {
+    return 0;
+  }
+  const Scalar d = h0/(hm+h0+hp) * ((2*hm+h0)/(hp+h0)*dr + (h0+2*hp)/(hm+h0)*dl);
+  const Scalar ad = d>0 ? d : -d;
+  const Scalar adl = dl>0 ? dl : -dl;
+  const Scalar adr = dr>0 ? dr : -dr;
+  const Scalar lim = 2*impl::min(adl, adr);
+  return ad<=lim ? d : (d>0 ? lim : -lim);
+}
+
+} // namespace impl
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+ConservativeRemap<ScalarT, PackSize, DeviceT>::
+ConservativeRemap(int ncol, int km1, int km2, RemapScheme scheme) :
+  m_km1(km1),
+  m_km2(km2),
+  m_ki2_pack(ekat::npack<Pack>(km2+1)),
+  m_scheme(scheme),
+  m_policy(ExeSpaceUtils<ExeSpace>::get_default_team_policy(ncol, m_ki2_pack)),
+  m_indx_map("m_indx_map", ncol, ekat::npack<IntPack>(km2+1))
+{
+  EKAT_REQUIRE_MSG (km1>0 && km2>0,
+      "Error! ConservativeRemap requires at least one source and one target layer.\n");
+
+  if (m_scheme!=RemapScheme::PiecewiseConstant) {
+    m_edges = view_2d<Scalar>("m_edges", ncol, km1+1);
+  }
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template<typename V1, typename V2>
+KOKKOS_INLINE_FUNCTION
+void ConservativeRemap<ScalarT, PackSize, DeviceT>::setup(
+  const MemberType& team,
+  const V1& xi1,
+  const V2& xi2,
+  const Int col) const
+{
+  setup_impl(team, Kokkos::TeamVectorRange(team, m_ki2_pack),
+             ekat::repack<Pack::n>(xi1), ekat::repack<Pack::n>(xi2), col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template<typename V1, typename V2, typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void ConservativeRemap<ScalarT, PackSize, DeviceT>::setup(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const V1& xi1,
+  const V2& xi2,
+  const Int col) const
+{
+  setup_impl(team, range_boundary,
+             ekat::repack<Pack::n>(xi1), ekat::repack<Pack::n>(xi2), col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2, typename V3, typename V4>
+KOKKOS_INLINE_FUNCTION
+void ConservativeRemap<ScalarT, PackSize, DeviceT>::remap(
+  const MemberType& team,
+  const V1& xi1,
+  const V2& xi2,
+  const V3& y1,
+  const V4& y2,
+  const Int col) const
+{
+  remap_impl(team,
+             ekat::repack<Pack::n>(xi1),
+             ekat::repack<Pack::n>(xi2),
+             ekat::repack<Pack::n>(y1),
+             ekat::repack<Pack::n>(y2),
+             col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void ConservativeRemap<ScalarT, PackSize, DeviceT>::setup_impl(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const view_1d<const Pack>& xi1,
+  const view_1d<const Pack>& xi2,
+  const Int col) const
+{
+  auto xi1s = ekat::scalarize(xi1);
+  auto begin_xi1 = xi1s.data();
+  auto end_xi1 = begin_xi1 + m_km1 + 1;
+
+  const int i = col == -1 ? team.league_rank() : col;
+  Kokkos::parallel_for(range_boundary, [&] (Int k2) {
+    // The layer containing xi2(k) is the one starting at the last xi1 interface <= xi2(k),
+    // clamped to the valid layers for the interfaces outside of [xi1(0),xi1(km1)]
+    const auto ub = upper_bound_branchless(begin_xi1, end_xi1, xi2(k2));
+    auto& idx = m_indx_map(i, k2);
+    vector_simd
+    for (int s = 0; s < Pack::n; ++s) {
+      idx[s] = ub[s] > 0 ? (ub[s] > m_km1 ? m_km1-1 : ub[s]-1) : 0;
+    }
+  });
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename ScalarView, typename ConstScalarView>
+KOKKOS_INLINE_FUNCTION
+void ConservativeRemap<ScalarT, PackSize, DeviceT>::ppm_edges(
+  const MemberType& team,
+  const ConstScalarView& xi1s,
+  const ConstScalarView& y1s,
+  const ScalarView& edges) const
+{
+  const int km1 = m_km1;
+  Kokkos::parallel_for(Kokkos::TeamVectorRange(team, km1+1), [&] (Int m) {
+    if (m==0) {
+      edges(m) = y1s(0);
+    } else if (m==km1) {
+      edges(m) = y1s(km1-1);
+    } else {
+      // Interface m is between layers j=m-1 and j+1
+      const int j = m-1;
+      const Scalar h0 = xi1s(j+1) - xi1s(j);
+      const Scalar h1 = xi1s(j+2) - xi1s(j+1);
+      const Scalar q0 = y1s(j);
+      const Scalar q1 = y1s(j+1);
+      Scalar e = q0 + h0/(h0+h1)*(q1-q0);
+      if (j>0 && j+2<km1) {
+        // Full stencil available: Colella and Woodward, 1984, eq. 1.6
+        const Scalar hm = xi1s(j) - xi1s(j-1);
+        const Scalar h2 = xi1s(j+3) - xi1s(j+2);
+        const Scalar qm = y1s(j-1);
+        const Scalar q2 = y1s(j+2);
+        const Scalar dq0 = impl::ppm_slope(hm, h0, h1, qm, q0, q1);
+        const Scalar dq1 = impl::ppm_slope(h0, h1, h2, q0, q1, q2);
+        e += ( 2*h1*h0/(h0+h1)*((hm+h0)/(2*h0+h1) - (h2+h1)/(2*h1+h0))*(q1-q0)
+             - h0*(hm+h0)/(2*h0+h1)*dq1
+             + h1*(h1+h2)/(h0+2*h1)*dq0 ) / (hm+h0+h1+h2);
+      }
+      edges(m) = e;
+    }
+  });
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename ScalarView, typename ConstScalarView>
+KOKKOS_INLINE_FUNCTION
+typename ConservativeRemap<ScalarT, PackSize, DeviceT>::Scalar
+ConservativeRemap<ScalarT, PackSize, DeviceT>::layer_integral(
+  const int j, const Scalar a, const Scalar b,
+  const ConstScalarView& xi1s,
+  const ConstScalarView& y1s,
+  const ScalarView& edges) const
+{
+  const Scalar q = y1s(j);
+  if (m_scheme==RemapScheme::PiecewiseConstant) {
+    return q*(b-a);
+  }
+
+  Scalar qL = edges(j);
+  Scalar qR = edges(j+1);
+  if (m_scheme==RemapScheme::PiecewiseParabolicLimited) {
+    // Colella and Woodward, 1984, eq. 1.10
+    if ((qR-q)*(q-qL) <= 0) {
+      qL = qR = q;
+    } else {
+      const Scalar dq = qR-qL;
+      const Scalar q6 = 6*(q - (qL+qR)/2);
+      if (dq*q6 > dq*dq) {
+        qL = 3*q - 2*qR;
+      } else if (-dq*dq > dq*q6) {
+        qR = 3*q - 2*qL;
+      }
+    }
+  }
+
+  // The parabola is q(s) = qL + s*(dq + q6*(1-s)), with s=(x-xi1(j))/h in [0,1]
+  const Scalar dq = qR-qL;
+  const Scalar q6 = 6*(q - (qL+qR)/2);
+  const Scalar h  = xi1s(j+1) - xi1s(j);
+  const Scalar s0 = (a - xi1s(j)) / h;
+  const Scalar s1 = (b - xi1s(j)) / h;
+  auto primitive = [&] (const Scalar s) -> Scalar {
+    return s*(qL + s*(dq/2 + q6*(Scalar(1)/2 - s/3)));
+  };
+  return h*(primitive(s1) - primitive(s0));
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+KOKKOS_INLINE_FUNCTION
+void ConservativeRemap<ScalarT, PackSize, DeviceT>::remap_impl(
+  const MemberType& team,
+  const view_1d<const Pack>& xi1,
+  const view_1d<const Pack>& xi2,
+  const view_1d<const Pack>& y1,
+  const view_1d<      Pack>& y2,
+  const Int col) const
+{
+  constexpr int N = Pack::n;
+
+  auto xi1s = ekat::scalarize(xi1);
+  auto xi2s = ekat::scalarize(xi2);
+  auto y1s  = ekat::scalarize(y1);
+
+  const int i = col == -1 ? team.league_rank() : col;
+
+  decltype(ekat::subview(m_edges, i)) edges;
+  if (m_scheme!=RemapScheme::PiecewiseConstant) {
+    edges = ekat::subview(m_edges, i);
+    ppm_edges(team, xi1s, y1s, edges);
+    team.team_barrier();
+  }
+
+  const Scalar bot = xi1s(0);
+  const Scalar top = xi1s(m_km1);
+  Kokkos::parallel_for(Kokkos::TeamVectorRange(team, ekat::npack<Pack>(m_km2)), [&] (Int kp) {
+    auto& y2_k = y2(kp);
+    for (int s=0; s<N; ++s) {
+      const int k2 = kp*N + s;
+      if (k2>=m_km2) {
+        break;
+      }
+      const Scalar lo = xi2s(k2);
+      const Scalar hi = xi2s(k2+1);
+      const int j0 = m_indx_map(i, k2/N)[k2%N];
+      const int j1 = m_indx_map(i, (k2+1)/N)[(k2+1)%N];
+
+      // Parts of the target layer outside the source column
+      Scalar sum = 0;
+      if (lo < bot) {
+        sum += ((hi<bot ? hi : bot) - lo)*y1s(0);
+      }
+      if (hi > top) {
+        sum += (hi - (lo>top ? lo : top))*y1s(m_km1-1);
+      }
+
+      // Overlaps with the source layers
+      for (int j=j0; j<=j1; ++j) {
+        const Scalar a = lo > xi1s(j)   ? lo : xi1s(j);
+        const Scalar b = hi < xi1s(j+1) ? hi : xi1s(j+1);
+        if (b > a) {
+          sum += layer_integral(j, a, b, xi1s, y1s, edges);
+        }
+      }
+
+      y2_k[s] = hi > lo ? sum/(hi-lo) : y1s(j0);
+    }
+  });
+}
+
+} // namespace ekat
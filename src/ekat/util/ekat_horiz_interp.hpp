@@ -0,0 +1,181 @@
+#ifndef EKAT_HORIZ_INTERP_HPP
+#define EKAT_HORIZ_INTERP_HPP
+
+#include "ekat/util/ekat_upper_bound.hpp"
+#include "ekat/ekat_assert.hpp"
+#include "ekat/kokkos/ekat_kokkos_utils.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
+#include "ekat/kokkos/ekat_subview_utils.hpp"
+#include "ekat/ekat_pack.hpp"
+#include "ekat/ekat_pack_kokkos.hpp"
+
+namespace ekat {
+
+// How a target point is reconstructed from the source grid
+enum class HorizInterpMethod {
+  Bilinear,   // Bilinear in (lat,lon) within the source cell containing the target
+  Nearest     // Value of the source node closest in (lat,lon)
+};
+
+/*
+ * HorizInterp regrids fields from a rectilinear lat/lon source grid onto
+ * an arbitrary set of ntgt target points (e.g., the nodes of another lat/lon
+ * grid, or the columns of an unstructured grid).
+ *
+ * The source grid is given by the nlat latitudes and nlon longitudes of its
+ * nodes (in degrees), both sorted in increasing order, with the longitudes
+ * spanning less than 360 degrees. Source column j*nlon+i is the node
+ * (src_lat(j),src_lon(i)). Longitudes are periodic, so targets between the
+ * last and first source longitude are interpolated across the seam. Targets
+ * poleward of the first/last source latitude see the closest latitude row.
+ *
+ * As with LinInterp, the work is split in two phases. setup computes, once
+ * for all, the (at most 4) source columns and weights contributing to each
+ * target point. These are stored as a sparse matrix with a fixed number of
+ * nonzeros per row (nnz()), and each call to apply is a sparse matrix-vector
+ * product, which can be reused for as many fields as needed.
+ *
+ * Fields are views with the column index first: either rank-1 views (col) of
+ * scalars, or rank-2 views (col,k) of scalars/packs, where k spans levels or a
+ * set of 2D fields to regrid at once. In the latter case, the products are
+ * vectorized over the packs of the second index.
+ *
+ * Example: regrid the surface field ps and the 3D field T
+ *   HI hi(nlat, nlon, ncol, HorizInterpMethod::Bilinear);
+ *   hi.setup(src_lat, src_lon, tgt_lat, tgt_lon);
+ *   hi.apply(ps_src, ps_tgt);
+ *   hi.apply(T_src, T_tgt);
+ *
+ * A team-level apply is also available, to regrid one target column inside a
+ * user's kernel (e.g., fused with other column work).
+ */
+
+template <typename ScalarT, int PackSize, typename DeviceT=DefaultDevice>
+struct HorizInterp
+{
+  //
+  // ------- Types --------
+  //
+
+  // Expose input template args
+  using Scalar = ScalarT;
+  using Device = DeviceT;
+  static constexpr int HI_PACKN = PackSize;
+
+  // Other utility types
+  using KT = KokkosTypes<Device>;
+
+  template <typename S>
+  using view_1d = typename KT::template view_1d<S>;
+  template <typename S>
+  using view_2d = typename KT::template view_2d<S>;
+
+  using ExeSpace    = typename KT::ExeSpace;
+  using MemberType  = typename KT::MemberType;
+  using TeamPolicy  = typename KT::TeamPolicy;
+  using RangePolicy = typename KT::RangePolicy;
+
+  using Pack = ekat::Pack<Scalar, HI_PACKN>;
+
+  //
+  // ------ public API -------
+  //
+
+  HorizInterp(int nlat, int nlon, int ntgt,
+              HorizInterpMethod method = HorizInterpMethod::Bilinear);
+
+  // Simple getters
+  KOKKOS_INLINE_FUNCTION
+  int nlat() const { return m_nlat; }
+  KOKKOS_INLINE_FUNCTION
+  int nlon() const { return m_nlon; }
+  KOKKOS_INLINE_FUNCTION
+  int nsrc() const { return m_nlat*m_nlon; }
+  KOKKOS_INLINE_FUNCTION
+  int ntgt() const { return m_ntgt; }
+  KOKKOS_INLINE_FUNCTION
+  HorizInterpMethod method() const { return m_method; }
+
+  // Number of nonzeros in each row of the interpolation matrix
+  KOKKOS_INLINE_FUNCTION
+  int nnz() const { return m_method==HorizInterpMethod::Bilinear ? 4 : 1; }
+
+  // The interpolation matrix: target t is the sum over n of
+  // weights()(t,n)*src(indices()(t,n)). Only valid after setup.
+  view_2d<const int>    indices() const { return m_indices; }
+  view_2d<const Scalar> weights() const { return m_weights; }
+
+  // A team policy over the targets, for fields with npacks packs per column
+  TeamPolicy policy(const int npacks) const {
+    return ExeSpaceUtils<ExeSpace>::get_default_team_policy(m_ntgt, npacks);
+  }
+
+  // Compute the interpolation matrix. Launches a kernel over the targets.
+  // src_lat/src_lon are the coordinates of the source grid nodes (nlat and nlon
+  // entries respectively), tgt_lat/tgt_lon those of the ntgt target points.
+  void setup(const view_1d<const Scalar>& src_lat,
+             const view_1d<const Scalar>& src_lon,
+             const view_1d<const Scalar>& tgt_lat,
+             const view_1d<const Scalar>& tgt_lon) const;
+
+  // Regrid y1 (on the source grid) onto y2 (on the target points). Launches a
+  // kernel over the targets. y1/y2 are both rank-1 views (col) or both rank-2
+  // views (col,k) of scalars or packs.
+  template <typename V1, typename V2>
+  void apply(const V1& y1, const V2& y2) const;
+
+  // Team-level version of the above, for rank-2 fields: regrid y1 (source
+  // columns, k) onto the target column y2 (k). By default, will launch a
+  // TeamVectorRange kernel, and the target idx will be team.league_rank(); this
+  // can be overridden by the tgt argument.
+  template <typename V1, typename V2>
+  KOKKOS_INLINE_FUNCTION
+  void apply(
+    const MemberType& team,
+    const V1& y1,
+    const V2& y2,
+    const Int tgt=-1) const;
+
+  // Same as above except uses a user-provided range boundary struct. The range
+  // must span the packs of y2, and will likely be a ThreadVectorRange.
+  template <typename V1, typename V2, typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void apply(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const V1& y1,
+    const V2& y2,
+    const Int tgt=-1) const;
+
+  //
+  // -------- Internal API, data ------
+  //
+ protected:
+
+  template <typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void apply_impl(
+    const RangeBoundary& range_boundary,
+    const view_2d<const Pack>& y1,
+    const view_1d<Pack>& y2,
+    const Int tgt) const;
+
+  // Host-side dispatch of apply, depending on the rank of the fields
+  template <typename V1, typename V2>
+  void apply_host(const V1& y1, const V2& y2, std::integral_constant<int,1>) const;
+  template <typename V1, typename V2>
+  void apply_host(const V1& y1, const V2& y2, std::integral_constant<int,2>) const;
+
+  int m_nlat;
+  int m_nlon;
+  int m_ntgt;
+  HorizInterpMethod m_method;
+  view_2d<int>    m_indices; // [tgt,n] -> source column of the n-th nonzero
+  view_2d<Scalar> m_weights; // [tgt,n] -> weight of the n-th nonzero
+};
+
+} //namespace ekat
+
+#include "ekat_horiz_interp_impl.hpp"
+
+#endif // EKAT_HORIZ_INTERP_HPP
@@ -0,0 +1,221 @@
+#ifndef EKAT_HORIZ_INTERP_HPP
+#include "ekat_horiz_interp.hpp"
+#endif
+
+namespace ekat {
+
+// Never include this header directly, only ekat_horiz_interp.hpp should include it
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+HorizInterp<ScalarT, PackSize, DeviceT>::
+HorizInterp(int nlat, int nlon, int ntgt, HorizInterpMethod method) :
+  m_nlat(nlat),
+  m_nlon(nlon),
+  m_ntgt(ntgt),
+  m_method(method)
+{
+  EKAT_REQUIRE_MSG (nlat>0 && nlon>0,
+      "Error! HorizInterp requires a non-empty source grid.\n"
+      "  - nlat: " + std::to_string(nlat) + "\n"
+      "  - nlon: " + std::to_string(nlon) + "\n");
+  EKAT_REQUIRE_MSG (ntgt>=0,
+      "Error! Invalid number of target points: " + std::to_string(ntgt) + "\n");
+
+  m_indices = view_2d<int>("m_indices", ntgt, nnz());
+  m_weights = view_2d<Scalar>("m_weights", ntgt, nnz());
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+void HorizInterp<ScalarT, PackSize, DeviceT>::setup(
+  const view_1d<const Scalar>& src_lat,
+  const view_1d<const Scalar>& src_lon,
+  const view_1d<const Scalar>& tgt_lat,
+  const view_1d<const Scalar>& tgt_lon) const
+{
+  EKAT_REQUIRE_MSG (src_lat.extent_int(0)==m_nlat && src_lon.extent_int(0)==m_nlon,
+      "Error! Source coordinates views have the wrong extents.\n"
+      "  - nlat, nlon: " + std::to_string(m_nlat) + ", " + std::to_string(m_nlon) + "\n"
+      "  - src_lat, src_lon extents: " + std::to_string(src_lat.extent_int(0)) + ", "
+                                       + std::to_string(src_lon.extent_int(0)) + "\n");
+  EKAT_REQUIRE_MSG (tgt_lat.extent_int(0)==m_ntgt && tgt_lon.extent_int(0)==m_ntgt,
+      "Error! Target coordinates views have the wrong extents.\n"
+      "  - ntgt: " + std::to_string(m_ntgt) + "\n"
+      "  - tgt_lat, tgt_lon extents: " + std::to_string(tgt_lat.extent_int(0)) + ", "
+                                       + std::to_string(tgt_lon.extent_int(0)) + "\n");
+
+  const int nlat = m_nlat;
+  const int nlon = m_nlon;
+  const bool bilinear = m_method==HorizInterpMethod::Bilinear;
+  const auto indices = m_indices;
+  const auto weights = m_weights;
+  Kokkos::parallel_for("HorizInterp::setup",
+                       RangePolicy(0, m_ntgt),
+                       KOKKOS_LAMBDA(const int t) {
+    // Latitude: the cell [j0,j1] containing the target, clamped at the poles
+    const auto lat = tgt_lat(t);
+    const int ub_lat = upper_bound_branchless(src_lat.data(), src_lat.data()+nlat, lat)
+                     - src_lat.data();
+    int j0, j1;
+    Scalar a = 0;
+    if (ub_lat==0) {
+      j0 = j1 = 0;
+    } else if (ub_lat==nlat) {
+      j0 = j1 = nlat-1;
+    } else {
+      j0 = ub_lat-1;
+      j1 = ub_lat;
+      a = (lat-src_lat(j0)) / (src_lat(j1)-src_lat(j0));
+    }
+
+    // Longitude: bring the target in [lon0,lon0+360), and find the cell [i0,i1]
+    // containing it; the last cell wraps around to the first source longitude.
+    const auto lon0 = src_lon(0);
+    Scalar dlon = tgt_lon(t) - lon0;
+    dlon -= 360*static_cast<int>(dlon/360);
+    if (dlon<0) {
+      dlon += 360;
+    }
+    const auto lon = lon0 + dlon;
+    const int i0 = upper_bound_branchless(src_lon.data(), src_lon.data()+nlon, lon)
+                 - src_lon.data() - 1;
+    const int i1 = i0==nlon-1 ? 0 : i0+1;
+    const auto lon1 = i0==nlon-1 ? lon0+360 : src_lon(i1);
+    const Scalar b = (lon-src_lon(i0)) / (lon1-src_lon(i0));
+
+    if (bilinear) {
+      indices(t,0) = j0*nlon + i0;
+      indices(t,1) = j0*nlon + i1;
+      indices(t,2) = j1*nlon + i0;
+      indices(t,3) = j1*nlon + i1;
+      weights(t,0) = (1-a)*(1-b);
+      weights(t,1) = (1-a)*b;
+      weights(t,2) = a*(1-b);
+      weights(t,3) = a*b;
+    } else {
+      indices(t,0) = (a<Scalar(0.5) ? j0 : j1)*nlon + (b<Scalar(0.5) ? i0 : i1);
+      weights(t,0) = 1;
+    }
+  });
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2>
+void HorizInterp<ScalarT, PackSize, DeviceT>::apply(
+  const V1& y1,
+  const V2& y2) const
+{
+  static_assert (V1::rank==V2::rank,
+      "Error! HorizInterp::apply requires source and target fields of the same rank.\n");
+  static_assert (V1::rank==1 || V1::rank==2,
+      "Error! HorizInterp::apply only supports rank-1 and rank-2 fields.\n");
+  EKAT_REQUIRE_MSG (y1.extent_int(0)==nsrc() && y2.extent_int(0)==m_ntgt,
+      "Error! Fields have the wrong number of columns.\n"
+      "  - nsrc, ntgt: " + std::to_string(nsrc()) + ", " + std::to_string(m_ntgt) + "\n"
+      "  - y1, y2 extents: " + std::to_string(y1.extent_int(0)) + ", "
+                             + std::to_string(y2.extent_int(0)) + "\n");
+
+  apply_host(y1, y2, std::integral_constant<int,V1::rank>());
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2>
+void HorizInterp<ScalarT, PackSize, DeviceT>::apply_host(
+  const V1& y1,
+  const V2& y2,
+  std::integral_constant<int,1>) const
+{
+  const int nnz = this->nnz();
+  const auto indices = m_indices;
+  const auto weights = m_weights;
+  Kokkos::parallel_for("HorizInterp::apply",
+                       RangePolicy(0, m_ntgt),
+                       KOKKOS_LAMBDA(const int t) {
+    auto sum = weights(t,0)*y1(indices(t,0));
+    for (int n=1; n<nnz; ++n) {
+      sum += weights(t,n)*y1(indices(t,n));
+    }
+    y2(t) = sum;
+  });
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2>
+void HorizInterp<ScalarT, PackSize, DeviceT>::apply_host(
+  const V1& y1,
+  const V2& y2,
+  std::integral_constant<int,2>) const
+{
+  EKAT_REQUIRE_MSG (y1.size()/y1.extent(0)==y2.size()/y2.extent(0),
+      "Error! Source and target fields have a different number of entries per column.\n");
+
+  const auto y1p = ekat::repack<Pack::n>(y1);
+  const auto y2p = ekat::repack<Pack::n>(y2);
+  const auto hi = *this;
+  Kokkos::parallel_for("HorizInterp::apply",
+                       policy(y2p.extent_int(1)),
+                       KOKKOS_LAMBDA(const MemberType& team) {
+    const int t = team.league_rank();
+    hi.apply_impl(Kokkos::TeamVectorRange(team, y2p.extent_int(1)),
+                  y1p, ekat::subview(y2p, t), t);
+  });
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2>
+KOKKOS_INLINE_FUNCTION
+void HorizInterp<ScalarT, PackSize, DeviceT>::apply(
+  const MemberType& team,
+  const V1& y1,
+  const V2& y2,
+  const Int tgt) const
+{
+  const auto y2p = ekat::repack<Pack::n>(y2);
+  apply_impl(Kokkos::TeamVectorRange(team, y2p.extent_int(0)),
+             ekat::repack<Pack::n>(y1), y2p,
+             tgt == -1 ? team.league_rank() : tgt);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2, typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void HorizInterp<ScalarT, PackSize, DeviceT>::apply(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const V1& y1,
+  const V2& y2,
+  const Int tgt) const
+{
+  apply_impl(range_boundary,
+             ekat::repack<Pack::n>(y1), ekat::repack<Pack::n>(y2),
+             tgt == -1 ? team.league_rank() : tgt);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void HorizInterp<ScalarT, PackSize, DeviceT>::apply_impl(
+  const RangeBoundary& range_boundary,
+  const view_2d<const Pack>& y1,
+  const view_1d<      Pack>& y2,
+  const Int t) const
+{
+  // Load the row of the matrix once, and reuse it for all the packs of the column
+  constexpr int max_nnz = 4;
+  const int nnz = this->nnz();
+  int    idx[max_nnz];
+  Scalar w[max_nnz];
+  for (int n=0; n<nnz; ++n) {
+    idx[n] = m_indices(t,n);
+    w[n]   = m_weights(t,n);
+  }
+
+  Kokkos::parallel_for(range_boundary, [&] (Int k) {
+    auto& y2_k = y2(k);
+    y2_k = w[0]*y1(idx[0],k);
+    for (int n=1; n<nnz; ++n) {
+      y2_k += w[n]*y1(idx[n],k);
+    }
+  });
+}
+
+} // namespace ekat
@@ -5,16 +5,34 @@
 #include "ekat/ekat_assert.hpp"
 #include "ekat/kokkos/ekat_kokkos_utils.hpp"
 #include "ekat/kokkos/ekat_kokkos_types.hpp"
+#include "ekat/kokkos/ekat_subview_utils.hpp"
 #include "ekat/ekat_pack.hpp"
 #include "ekat/ekat_pack_kokkos.hpp"
 
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
 namespace ekat {
 
+// How LinInterp computes targets that are outside of the range of x1
+enum class LinInterpExtrap {
+  Linear,   // Extend the line through the first/last two points of x1
+  Clamp,    // Use the value at the first/last point of x1
+  Fill      // Use the fill value given at construction
+};
+
 /*
  * LinInterp is a class for doing fast linear interpolations within Kokkos
  * kernels. The user is expected to call setup for every thread team that
  * intends to do a linear interpolation. Setup is O(n log n) but it allows
  * for any number of O(n) linear interpolations using the same coordinates.
+ * If both x1 and x2 are sorted in increasing order, setup_monotone can be
+ * used instead, which builds the same index map with O(n) work.
+ * If the grids rarely change, setup_if_changed (or setup_dirty, from host)
+ * can be called every step instead, and will only rebuild the index map of
+ * the columns whose grids did change.
  *
  * Example: Linearly interpolate y1a, y1b, and y1c from x1 to x2
  *   Kokkos::parallel_for("setup",
@@ -26,17 +44,44 @@ namespace ekat {
       auto x2col = subview(x2, i);
 
       li.setup(team_member, x1col, x2col);
+      team_member.team_barrier();
 
       li.lin_interp(team_member, x1col, x2col, subview(y1a, i), subview(y2a, i));
       li.lin_interp(team_member, x1col, x2col, subview(y1b, i), subview(y2b, i));
       li.lin_interp(team_member, x1col, x2col, subview(y1c, i), subview(y2c, i));
     });
 
+  If the y fields are stored in a rank-2 view (field,lev), the three lin_interp calls above
+  can be replaced by a single lin_interp_multi call, which computes the interpolation weights
+  only once.
+
+  If the same index map is used for many interpolations, consider constructing the
+  LinInterp object with store_weights=true: the interpolation weights are then computed
+  at setup time, and lin_interp reduces to a gather plus one FMA per point.
+
+  The index map (and the stored weights, if any) is read by every interpolation, so for
+  large ncol*km2 it can account for a good fraction of the memory traffic. The IndexT and
+  WeightT template args allow storing it in narrower types: e.g., std::int16_t indices
+  are enough for km1<=32768, and std::uint8_t ones for km1<=256. Likewise, with
+  WeightT=float the stored weights of a double precision LinInterp take half the space,
+  at the price of a relative error of ~1e-7 in the interpolated values. Entries are
+  widened to int (resp. Scalar) in registers before being used.
+
+  The Extrap template arg selects how targets outside of [x1(0),x1(km1-1)] are handled
+  (see LinInterpExtrap). Targets that are masked as invalid (x2=ScalarTraits::invalid())
+  are set to invalid (or to the fill value, with LinInterpExtrap::Fill). Setup resolves
+  both into the stored weights, so that lin_interp is the same branch-free gather+FMA
+  for all policies. For this reason, Clamp and Fill always store the weights.
+  Note: masked targets are only supported by setup (and setup_if_changed/setup_dirty),
+  since setup_monotone requires x2 to be sorted.
+
   Note: testing has shown that LinInterp runs better on SKX with pack_size=1.
 
  */
 
-template <typename ScalarT, int PackSize, typename DeviceT=DefaultDevice>
+template <typename ScalarT, int PackSize, typename DeviceT=DefaultDevice,
+          typename IndexT=int, typename WeightT=ScalarT,
+          LinInterpExtrap Extrap=LinInterpExtrap::Linear>
 struct LinInterp
 {
   //
@@ -47,6 +92,7 @@ struct LinInterp
   using Scalar = ScalarT;
   using Device = DeviceT;
   static constexpr int LI_PACKN = PackSize;
+  static constexpr LinInterpExtrap extrap = Extrap;
 
   // Other utility types
   using KT = KokkosTypes<Device>;
@@ -60,14 +106,34 @@ struct LinInterp
   using MemberType  = typename KT::MemberType;
   using TeamPolicy  = typename KT::TeamPolicy;
 
+  using Index   = IndexT;
+  using Weight  = WeightT;
+
   using Pack    = ekat::Pack<Scalar, LI_PACKN>;
   using IntPack = ekat::Pack<int, LI_PACKN>;
 
+  // Storage types for the index map and the weights
+  using IndexPack  = ekat::Pack<Index, LI_PACKN>;
+  using WeightPack = ekat::Pack<Weight, LI_PACKN>;
+
+  static_assert (std::is_integral<Index>::value,
+      "Error! LinInterp index type must be an integral type.\n");
+  static_assert (std::is_floating_point<Weight>::value,
+      "Error! LinInterp weight type must be a floating point type.\n");
+
   //
   // ------ public API -------
   //
 
-  LinInterp(int ncol, int km1, int km2);
+  // If store_weights is true, setup will also compute and store the interpolation
+  // weights (and the neighbor index k1+h) for each target point, so that lin_interp
+  // only needs to gather y1 and do one FMA per point. This requires an extra
+  // 2*ncol*km2 scalars of storage, so it is off by default (except for the Clamp
+  // and Fill extrapolations, which always store them).
+  // km1 must be representable by the Index type. The fill value is only used
+  // with LinInterpExtrap::Fill.
+  LinInterp(int ncol, int km1, int km2, bool store_weights = false,
+            Scalar fill_value = ScalarTraits<Scalar>::invalid());
 
   // Simple getters
   KOKKOS_INLINE_FUNCTION
@@ -75,6 +141,12 @@ struct LinInterp
   KOKKOS_INLINE_FUNCTION
   int km2_pack() const { return m_km2_pack; }
 
+  KOKKOS_INLINE_FUNCTION
+  bool stores_weights() const { return m_store_weights; }
+
+  KOKKOS_INLINE_FUNCTION
+  Scalar fill_value() const { return m_fill_value; }
+
   const TeamPolicy& policy() const { return m_policy; }
 
   // Setup the index map. This must be called before lin_interp. By default, will launch a
@@ -99,6 +171,66 @@ struct LinInterp
     const V2& x2,
     const Int col=-1) const;
 
+  // Same as setup, but exploits the fact that both x1 and x2 are sorted in increasing
+  // order. The merge of x1 and x2 is split into km2_pack() segments (merge path), each
+  // of which is located with a single binary search and then walked linearly. This
+  // gives O(km1+km2) work per column rather than O(km2 log km1). The index map is
+  // identical to the one produced by setup, so lin_interp is unaffected.
+  // WARNING: results are undefined if x1 or x2 are not monotonically increasing.
+  template<typename V1, typename V2>
+  KOKKOS_INLINE_FUNCTION
+  void setup_monotone(
+    const MemberType& team,
+    const V1& x1,
+    const V2& x2,
+    const Int col=-1) const;
+
+  // Same as above except uses a user-provided range boundary struct. The range
+  // must span [0,km2_pack()), and will likely be a ThreadVectorRange.
+  template<typename V1, typename V2, typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void setup_monotone(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const V1& x1,
+    const V2& x2,
+    const Int col=-1) const;
+
+  // Same as setup, but only rebuilds the index map if x1 or x2 changed since the last
+  // call to setup_if_changed for this column. A (cheap) fingerprint of x1 and x2 is
+  // stored for each column, and compared to the one of the input grids. Returns true if
+  // the index map was rebuilt. A call to setup or setup_monotone invalidates the
+  // fingerprint of the column, so the next call to setup_if_changed will rebuild the map.
+  template<typename V1, typename V2>
+  KOKKOS_INLINE_FUNCTION
+  bool setup_if_changed(
+    const MemberType& team,
+    const V1& x1,
+    const V2& x2,
+    const Int col=-1) const;
+
+  // Same as above except uses a user-provided range boundary struct. The range
+  // must span [0,km2_pack()), and must be executed by a single thread (so it will
+  // likely be a ThreadVectorRange).
+  template<typename V1, typename V2, typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  bool setup_if_changed(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const V1& x1,
+    const V2& x2,
+    const Int col=-1) const;
+
+  // Host-side setup of all the columns i such that dirty(i) is true. The index
+  // map of all other columns is left untouched. x1 and x2 are rank-2 views (col,lev),
+  // and dirty is a rank-1 view (col) of bool-convertible values, all accessible
+  // from the execution space of the LinInterp object.
+  template<typename V1, typename V2, typename VD>
+  void setup_dirty(
+    const V1& x1,
+    const V2& x2,
+    const VD& dirty) const;
+
   // Linearly interpolate y(x1) onto coordinates x2. By default, will launch a
   // TeamVectorRange kernel. The x1 and x2 should match what was given to setup.
   // By default, the column idx will be team.league_rank(); this can be
@@ -126,10 +258,38 @@ struct LinInterp
     const V4& y2,
     const Int col=-1) const;
 
+  // Linearly interpolate several fields at once. y1 and y2 are rank-2 views, with
+  // layout (field,lev), so that subview(y1,f) is the f-th field on x1. The interpolation
+  // weights are computed once per target point, and then applied to all the fields, so
+  // this is considerably cheaper than calling lin_interp for each field separately.
+  // Note: results may differ from lin_interp by round-off.
+  template <typename V1, typename V2, typename V3, typename V4>
+  KOKKOS_INLINE_FUNCTION
+  void lin_interp_multi(
+    const MemberType& team,
+    const V1& x1,
+    const V2& x2,
+    const V3& y1,
+    const V4& y2,
+    const Int col=-1) const;
+
+  // Same as above except uses a user-provided range boundary struct. This will likely
+  // be a ThreadVectorRange.
+  template <typename V1, typename V2, typename V3, typename V4, typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void lin_interp_multi(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const V1& x1,
+    const V2& x2,
+    const V3& y1,
+    const V4& y2,
+    const Int col=-1) const;
+
   //
   // -------- Internal API, data ------
   //
- private:
+ protected:
 
   template <typename RangeBoundary>
   KOKKOS_INLINE_FUNCTION
@@ -140,6 +300,39 @@ struct LinInterp
     const view_1d<const Pack>& x2,
     const Int col) const;
 
+  template <typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void setup_monotone_impl(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const view_1d<const Pack>& x1,
+    const view_1d<const Pack>& x2,
+    const Int col) const;
+
+  template <typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  bool setup_if_changed_impl(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const view_1d<const Pack>& x1,
+    const view_1d<const Pack>& x2,
+    const Int col,
+    const bool team_wide) const;
+
+  // Order-dependent hash of the first km1 entries of x1 and the first km2 entries of x2.
+  // Never returns 0, which is used to mark an invalid fingerprint.
+  template <typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  std::uint64_t fingerprint(
+    const RangeBoundary& range_boundary,
+    const view_1d<const Pack>& x1,
+    const view_1d<const Pack>& x2) const;
+
+  // Mark the fingerprint of the column as invalid. If team_wide, the whole team
+  // calls this for the same column; otherwise, each thread for its own column.
+  KOKKOS_INLINE_FUNCTION
+  void invalidate_fingerprint(const MemberType& team, const Int col, const bool team_wide) const;
+
   template <typename RangeBoundary>
   KOKKOS_INLINE_FUNCTION
   void lin_interp_impl(
@@ -149,12 +342,33 @@ struct LinInterp
     const view_1d<Pack>& y2,
     const Int col) const;
 
+  template <typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void lin_interp_multi_impl(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const view_1d<const Pack>& x1, const view_1d<const Pack>& x2, const view_2d<const Pack>& y1,
+    const view_2d<Pack>& y2,
+    const Int col) const;
+
+  // Store k1+h and the interpolation weight for the k-th (scalar) target point,
+  // with the extrapolation policy and the masking of invalid targets applied
+  template <typename ScalarView>
+  KOKKOS_INLINE_FUNCTION
+  void store_weight(const int col, const int k, const int k1,
+                    const ScalarView& x1s, const Scalar x2) const;
+
   int m_km1;
   int m_km2;
   int m_km1_pack;
   int m_km2_pack;
   TeamPolicy m_policy;
-  view_2d<IntPack> m_indx_map; // [x2_idx] -> x1_idx
+  view_2d<IndexPack> m_indx_map; // [x2_idx] -> x1_idx
+  view_1d<std::uint64_t> m_fingerprint; // [col] -> hash of (x1,x2) used to build m_indx_map
+  bool m_store_weights;
+  view_2d<IndexPack>  m_indx_map_ph; // [x2_idx] -> x1_idx+h (only if m_store_weights=true)
+  view_2d<WeightPack> m_weights;     // [x2_idx] -> interp weight (only if m_store_weights=true)
+  Scalar m_fill_value;
 };
 
 } //namespace ekat
@@ -6,47 +6,146 @@ namespace ekat {
 
 // Never include this header directly, only ekat_lin_interp.hpp should include it
 
-template <typename ScalarT, int PackSize, typename DeviceT>
-LinInterp<ScalarT, PackSize, DeviceT>::LinInterp(int ncol, int km1, int km2) :
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::LinInterp(int ncol, int km1, int km2, bool store_weights, Scalar fill_value) :
   m_km1(km1),
   m_km2(km2),
   m_km1_pack(ekat::npack<Pack>(km1)),
   m_km2_pack(ekat::npack<Pack>(km2)),
   m_policy(ExeSpaceUtils<ExeSpace>::get_default_team_policy(ncol, m_km2_pack)),
-  m_indx_map("m_indx_map", ncol, ekat::npack<IntPack>(km2))
-{}
+  m_indx_map("m_indx_map", ncol, ekat::npack<IndexPack>(km2)),
+  m_fingerprint("m_fingerprint", ncol),
+  m_store_weights(store_weights || Extrap!=LinInterpExtrap::Linear),
+  m_fill_value(fill_value)
+{
+  EKAT_REQUIRE_MSG (km1-1 <= static_cast<long long>(std::numeric_limits<Index>::max()),
+      "Error! Index type of LinInterp is too narrow for the source grid.\n"
+      "  - km1: " + std::to_string(km1) + "\n"
+      "  - max index: " + std::to_string(static_cast<long long>(std::numeric_limits<Index>::max())) + "\n");
+
+  if (m_store_weights) {
+    m_indx_map_ph = view_2d<IndexPack>("m_indx_map_ph", ncol, ekat::npack<IndexPack>(km2));
+    m_weights = view_2d<WeightPack>("m_weights", ncol, m_km2_pack);
+  }
+}
 
-template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
 template<typename V1, typename V2>
 KOKKOS_INLINE_FUNCTION
-void LinInterp<ScalarT, PackSize, DeviceT>::setup(
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::setup(
   const MemberType& team,
   const V1& x1,
   const V2& x2,
   const Int col) const
 {
+  invalidate_fingerprint(team, col == -1 ? team.league_rank() : col, true);
   setup_impl(team, Kokkos::TeamVectorRange(team, m_km2_pack),
              ekat::repack<Pack::n>(x1), ekat::repack<Pack::n>(x2), col);
 }
 
-template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
 template<typename V1, typename V2, typename RangeBoundary>
 KOKKOS_INLINE_FUNCTION
-void LinInterp<ScalarT, PackSize, DeviceT>::setup(
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::setup(
   const MemberType& team,
   const RangeBoundary& range_boundary,
   const V1& x1,
   const V2& x2,
   const Int col) const
 {
+  invalidate_fingerprint(team, col == -1 ? team.league_rank() : col, false);
   setup_impl(team, range_boundary,
              ekat::repack<Pack::n>(x1), ekat::repack<Pack::n>(x2), col);
 }
 
-template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template<typename V1, typename V2>
+KOKKOS_INLINE_FUNCTION
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::setup_monotone(
+  const MemberType& team,
+  const V1& x1,
+  const V2& x2,
+  const Int col) const
+{
+  invalidate_fingerprint(team, col == -1 ? team.league_rank() : col, true);
+  setup_monotone_impl(team, Kokkos::TeamVectorRange(team, m_km2_pack),
+                      ekat::repack<Pack::n>(x1), ekat::repack<Pack::n>(x2), col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template<typename V1, typename V2, typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::setup_monotone(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const V1& x1,
+  const V2& x2,
+  const Int col) const
+{
+  invalidate_fingerprint(team, col == -1 ? team.league_rank() : col, false);
+  setup_monotone_impl(team, range_boundary,
+                      ekat::repack<Pack::n>(x1), ekat::repack<Pack::n>(x2), col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template<typename V1, typename V2>
+KOKKOS_INLINE_FUNCTION
+bool LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::setup_if_changed(
+  const MemberType& team,
+  const V1& x1,
+  const V2& x2,
+  const Int col) const
+{
+  return setup_if_changed_impl(team, Kokkos::TeamVectorRange(team, m_km2_pack),
+                               ekat::repack<Pack::n>(x1), ekat::repack<Pack::n>(x2), col, true);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template<typename V1, typename V2, typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+bool LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::setup_if_changed(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const V1& x1,
+  const V2& x2,
+  const Int col) const
+{
+  return setup_if_changed_impl(team, range_boundary,
+                               ekat::repack<Pack::n>(x1), ekat::repack<Pack::n>(x2), col, false);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template<typename V1, typename V2, typename VD>
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::setup_dirty(
+  const V1& x1,
+  const V2& x2,
+  const VD& dirty) const
+{
+  static_assert (V1::rank==2 && V2::rank==2,
+      "Error! LinInterp::setup_dirty requires rank-2 views for x1 and x2.\n");
+  static_assert (VD::rank==1,
+      "Error! LinInterp::setup_dirty requires a rank-1 view for the dirty flags.\n");
+  EKAT_REQUIRE_MSG (dirty.extent_int(0)==m_indx_map.extent_int(0),
+      "Error! Dirty flags view has the wrong extent.\n"
+      "  - ncol: " + std::to_string(m_indx_map.extent_int(0)) + "\n"
+      "  - dirty extent: " + std::to_string(dirty.extent_int(0)) + "\n");
+
+  // Clean columns cost a single load per team, so we simply launch the whole league
+  const auto li = *this;
+  Kokkos::parallel_for("LinInterp::setup_dirty",
+                       m_policy,
+                       KOKKOS_LAMBDA(const MemberType& team) {
+    const int i = team.league_rank();
+    if (dirty(i)) {
+      li.setup(team, ekat::subview(x1, i), ekat::subview(x2, i));
+    }
+  });
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
 template <typename V1, typename V2, typename V3, typename V4>
 KOKKOS_INLINE_FUNCTION
-void LinInterp<ScalarT, PackSize, DeviceT>::lin_interp(
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::lin_interp(
   const MemberType& team,
   const V1& x1,
   const V2& x2,
@@ -63,10 +162,10 @@ void LinInterp<ScalarT, PackSize, DeviceT>::lin_interp(
                   col);
 }
 
-template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
 template <typename V1, typename V2, typename V3, typename V4, typename RangeBoundary>
 KOKKOS_INLINE_FUNCTION
-void LinInterp<ScalarT, PackSize, DeviceT>::lin_interp(
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::lin_interp(
   const MemberType& team,
   const RangeBoundary& range_boundary,
   const V1& x1,
@@ -84,10 +183,51 @@ void LinInterp<ScalarT, PackSize, DeviceT>::lin_interp(
                   col);
 }
 
-template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template <typename V1, typename V2, typename V3, typename V4>
+KOKKOS_INLINE_FUNCTION
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::lin_interp_multi(
+  const MemberType& team,
+  const V1& x1,
+  const V2& x2,
+  const V3& y1,
+  const V4& y2,
+  const Int col) const
+{
+  lin_interp_multi_impl(team,
+                        Kokkos::TeamVectorRange(team, m_km2_pack),
+                        ekat::repack<Pack::n>(x1),
+                        ekat::repack<Pack::n>(x2),
+                        ekat::repack<Pack::n>(y1),
+                        ekat::repack<Pack::n>(y2),
+                        col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template <typename V1, typename V2, typename V3, typename V4, typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::lin_interp_multi(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const V1& x1,
+  const V2& x2,
+  const V3& y1,
+  const V4& y2,
+  const Int col) const
+{
+  lin_interp_multi_impl(team,
+                        range_boundary,
+                        ekat::repack<Pack::n>(x1),
+                        ekat::repack<Pack::n>(x2),
+                        ekat::repack<Pack::n>(y1),
+                        ekat::repack<Pack::n>(y2),
+                        col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
 template <typename RangeBoundary>
 KOKKOS_INLINE_FUNCTION
-void LinInterp<ScalarT, PackSize, DeviceT>::lin_interp_impl(
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::lin_interp_impl(
   const MemberType& team,
   const RangeBoundary& range_boundary,
   const view_1d<const Pack>& x1,
@@ -104,6 +244,33 @@ void LinInterp<ScalarT, PackSize, DeviceT>::lin_interp_impl(
 
   const int i = col == -1 ? team.league_rank() : col;
 
+  if (m_store_weights) {
+    // Everything that depends only on x1 and x2 was computed at setup time,
+    // so we only need to gather y1 at k1 and k1+h
+    Kokkos::parallel_for(range_boundary, [&] (Int k2) {
+      Pack y1_k1, y1_k1ph;
+      const IPackT k1(m_indx_map(i, k2));
+      const IPackT k1ph(m_indx_map_ph(i, k2));
+      for (int i=0; i<N; ++i) {
+        y1_k1[i] = y1s(k1[i]);
+      }
+      for (int i=0; i<N; ++i) {
+        y1_k1ph[i] = y1s(k1ph[i]);
+      }
+
+      const Pack w(m_weights(i, k2));
+      auto& y2_k2 = y2(k2);
+      y2_k2  = y1_k1ph-y1_k1;
+      y2_k2 *= w;
+      y2_k2 += y1_k1;
+      if (Extrap==LinInterpExtrap::Fill) {
+        // Setup marked the targets to fill with an invalid weight
+        y2_k2.set(isnan(w), m_fill_value);
+      }
+    });
+    return;
+  }
+
   Kokkos::parallel_for(range_boundary, [&] (Int k2) {
     Pack x1_k1, x1_k1ph, y1_k1, y1_k1ph;
     IPackT k1ph;
@@ -114,18 +281,14 @@ void LinInterp<ScalarT, PackSize, DeviceT>::lin_interp_impl(
     // The catch is that k1 may be the last point. In that case, we go backward instead of fwd
     // to compute the slope
 
-    const auto& k1 = m_indx_map(i, k2);
+    // Widen the (possibly compact) stored indices
+    const IPackT k1(m_indx_map(i, k2));
 
-    // k1ph = k1+h, where h=1 except at the last entry, where h=-1
-    k1ph = k1;
+    // k1ph = k1+h, where h=1 except at the last entry, where h=-1.
+    // Computed arithmetically, so that the loop has no per-lane branch
     vector_simd
     for (int i=0; i<N; ++i) {
-      // k1ph[i] = k1[i];
-      if (k1ph[i]==(m_km1-1)) {
-        --k1ph[i];
-      } else {
-        ++k1ph[i];
-      }
+      k1ph[i] = k1[i] + 1 - 2*(k1[i]==(m_km1-1));
     }
 
     // Eval x1 and y1 at k1 and k1+h
@@ -155,10 +318,81 @@ void LinInterp<ScalarT, PackSize, DeviceT>::lin_interp_impl(
   });
 }
 
-template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
 template <typename RangeBoundary>
 KOKKOS_INLINE_FUNCTION
-void LinInterp<ScalarT, PackSize, DeviceT>::setup_impl(
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::lin_interp_multi_impl(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const view_1d<const Pack>& x1,
+  const view_1d<const Pack>& x2,
+  const view_2d<const Pack>& y1,
+  const view_2d<      Pack>& y2,
+  const Int col) const
+{
+  constexpr int N = Pack::n;
+  using IPackT = ekat::Pack<int,N>;
+
+  auto x1s = scalarize(x1);
+  auto y1s = scalarize(y1);
+
+  const int i = col == -1 ? team.league_rank() : col;
+  const int nfields = y1.extent_int(0);
+
+  Kokkos::parallel_for(range_boundary, [&] (Int k2) {
+    Pack x1_k1, x1_k1ph, y1_k1, y1_k1ph;
+    IPackT k1ph;
+
+    // Same as lin_interp_impl, but rewrite the formula as
+    //   y2(k2) = y1(k1) + w * (y1(k1+h)-y1(k1)),
+    // with w = (x2(k2)-x1(k1))/(x1(k1+h)-x1(k1)), which is the same for all fields.
+
+    const IPackT k1(m_indx_map(i, k2));
+
+    Pack w;
+    if (m_store_weights) {
+      k1ph = IPackT(m_indx_map_ph(i, k2));
+      w = Pack(m_weights(i, k2));
+    } else {
+      vector_simd
+      for (int i=0; i<N; ++i) {
+        k1ph[i] = k1[i] + 1 - 2*(k1[i]==(m_km1-1));
+      }
+
+      for (int i=0; i<N; ++i) {
+        x1_k1[i] = x1s(k1[i]);
+      }
+      for (int i=0; i<N; ++i) {
+        x1_k1ph[i] = x1s(k1ph[i]);
+      }
+
+      w  = x2(k2)-x1_k1;
+      w /= x1_k1ph-x1_k1;
+    }
+
+    for (int f=0; f<nfields; ++f) {
+      for (int i=0; i<N; ++i) {
+        y1_k1[i] = y1s(f,k1[i]);
+      }
+      for (int i=0; i<N; ++i) {
+        y1_k1ph[i] = y1s(f,k1ph[i]);
+      }
+
+      auto& y2_k2 = y2(f,k2);
+      y2_k2  = y1_k1ph-y1_k1;
+      y2_k2 *= w;
+      y2_k2 += y1_k1;
+      if (Extrap==LinInterpExtrap::Fill) {
+        y2_k2.set(isnan(w), m_fill_value);
+      }
+    }
+  });
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template <typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::setup_impl(
   const MemberType& team,
   const RangeBoundary& range_boundary,
   const view_1d<const Pack>& x1,
@@ -171,16 +405,236 @@ void LinInterp<ScalarT, PackSize, DeviceT>::setup_impl(
 
   const int i = col == -1 ? team.league_rank() : col;
   Kokkos::parallel_for(range_boundary, [&] (Int k2) {
+    // Search all the entries of the pack at once. The search is branchless,
+    // so all the pack entries do the same number of iterations.
+    // Masked (invalid) targets search x1(0) instead, to avoid comparing with NaN;
+    // they are invalidated by store_weight, or by lin_interp if weights are not stored.
+    auto x2_k2 = x2(k2);
+    x2_k2.set(isnan(x2_k2), x1s(0));
+    const auto ub = upper_bound_branchless(begin_x1, end_x1, x2_k2);
+    auto& idx = m_indx_map(i, k2);
+    vector_simd
     for (int s = 0; s < Pack::n; ++s) {
-      const Scalar x2_indv = x2(k2)[s];
-      auto ub = upper_bound(begin_x1, end_x1, x2_indv);
-      int x1_idx = ub - begin_x1;
-      if (x1_idx > 0) {
-        --x1_idx;
+      idx[s] = static_cast<Index>(ub[s] > 0 ? ub[s]-1 : 0);
+    }
+    if (m_store_weights) {
+      for (int s = 0; s < Pack::n; ++s) {
+        store_weight(i, k2*Pack::n+s, idx[s], x1s, x2(k2)[s]);
+      }
+    }
+  });
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template <typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::setup_monotone_impl(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const view_1d<const Pack>& x1,
+  const view_1d<const Pack>& x2,
+  const Int col) const
+{
+  constexpr int N = Pack::n;
+
+  auto x1s = ekat::scalarize(x1);
+  auto x2s = ekat::scalarize(x2);
+
+  const int i = col == -1 ? team.league_rank() : col;
+
+  // Consider the merge of x1 and x2, where x1 entries come first in case of ties.
+  // When x2(k2) is reached in the merge, the number k1 of x1 entries already
+  // merged is the number of x1 entries that are <= x2(k2), which is precisely
+  // what upper_bound returns in setup_impl. We split the merge in m_km2_pack
+  // segments of (roughly) equal length, and let each entry of the range walk one.
+  const int nmerge = m_km1 + m_km2;
+  const int nseg   = m_km2_pack;
+  Kokkos::parallel_for(range_boundary, [&] (Int seg) {
+    const int d_beg = (seg*nmerge) / nseg;
+    const int d_end = ((seg+1)*nmerge) / nseg;
+
+    // Find where the segment starts, with a binary search along the cross
+    // diagonal of the merge grid: lo is the number of x1 entries among the
+    // first d_beg entries of the merge.
+    int lo = d_beg>m_km2 ? d_beg-m_km2 : 0;
+    int hi = d_beg<m_km1 ? d_beg : m_km1;
+    while (lo < hi) {
+      const int mid = (lo+hi) / 2;
+      if (x1s(mid) <= x2s(d_beg-mid-1)) {
+        lo = mid+1;
+      } else {
+        hi = mid;
+      }
+    }
+
+    // Walk the segment, recording the x1 index of every x2 entry we run into
+    int k1 = lo;
+    int k2 = d_beg-lo;
+    for (int d=d_beg; d<d_end; ++d) {
+      if (k2==m_km2 || (k1<m_km1 && x1s(k1)<=x2s(k2))) {
+        ++k1;
+      } else {
+        m_indx_map(i, k2/N)[k2%N] = static_cast<Index>(k1>0 ? k1-1 : 0);
+        if (m_store_weights) {
+          store_weight(i, k2, k1>0 ? k1-1 : 0, x1s, x2s(k2));
+        }
+        ++k2;
+      }
+    }
+
+    // The padding at the end of the last pack is not part of the merge,
+    // but it still needs a valid index, since lin_interp processes whole packs.
+    if (seg==nseg-1) {
+      for (int k=m_km2; k<nseg*N; ++k) {
+        m_indx_map(i, k/N)[k%N] = 0;
+        if (m_store_weights) {
+          store_weight(i, k, 0, x1s, x2s(k));
+        }
       }
-      m_indx_map(i, k2)[s] = x1_idx;
     }
   });
 }
 
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template <typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+bool LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::setup_if_changed_impl(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const view_1d<const Pack>& x1,
+  const view_1d<const Pack>& x2,
+  const Int col,
+  const bool team_wide) const
+{
+  const int i = col == -1 ? team.league_rank() : col;
+
+  const auto fp = fingerprint(range_boundary, x1, x2);
+  const bool changed = m_fingerprint(i) != fp;
+  if (team_wide) {
+    // Make sure all threads read the old fingerprint before anyone updates it
+    team.team_barrier();
+  }
+
+  if (changed) {
+    // No need to invalidate the fingerprint first, since we overwrite it right after
+    setup_impl(team, range_boundary, x1, x2, col);
+    if (team_wide) {
+      // The whole team must be done with the map before it is marked as valid
+      team.team_barrier();
+      Kokkos::single(Kokkos::PerTeam(team), [&] () {
+        m_fingerprint(i) = fp;
+      });
+    } else {
+      Kokkos::single(Kokkos::PerThread(team), [&] () {
+        m_fingerprint(i) = fp;
+      });
+    }
+  }
+  return changed;
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template <typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+std::uint64_t LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::fingerprint(
+  const RangeBoundary& range_boundary,
+  const view_1d<const Pack>& x1,
+  const view_1d<const Pack>& x2) const
+{
+  static_assert (sizeof(Scalar)<=sizeof(std::uint64_t),
+      "Error! LinInterp fingerprint only supports scalars of up to 64 bits.\n");
+
+  auto x1s = ekat::scalarize(x1);
+  auto x2s = ekat::scalarize(x2);
+
+  // Hash each entry together with its position (x2 entries come after x1 ones),
+  // with the splitmix64 finalizer. The sum of the hashes is order-independent,
+  // which allows computing it with a parallel reduction.
+  auto hash = [] (const Scalar x, const std::uint64_t pos) -> std::uint64_t {
+    std::uint64_t z = 0;
+    std::memcpy(&z, &x, sizeof(Scalar));
+    z += 0x9e3779b97f4a7c15ULL*(pos+1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  };
+
+  // The range spans the packs of x2; each range index also takes care of
+  // the x1 packs that are congruent to it modulo m_km2_pack.
+  constexpr int N = Pack::n;
+  std::uint64_t fp = 0;
+  Kokkos::parallel_reduce(range_boundary, [&] (Int k2, std::uint64_t& sum) {
+    for (int s=0; s<N; ++s) {
+      const int k = k2*N + s;
+      if (k<m_km2) {
+        sum += hash(x2s(k), m_km1+k);
+      }
+    }
+    for (int k1=k2; k1<m_km1_pack; k1+=m_km2_pack) {
+      for (int s=0; s<N; ++s) {
+        const int k = k1*N + s;
+        if (k<m_km1) {
+          sum += hash(x1s(k), k);
+        }
+      }
+    }
+  }, fp);
+
+  return fp | 1;
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+KOKKOS_INLINE_FUNCTION
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::invalidate_fingerprint(
+  const MemberType& team,
+  const Int col,
+  const bool team_wide) const
+{
+  // Nothing in setup reads the fingerprint, and callers already need a team
+  // barrier between setup and any later use of the map (including a call to
+  // setup_if_changed), which also orders this store.
+  if (team_wide) {
+    Kokkos::single(Kokkos::PerTeam(team), [&] () {
+      m_fingerprint(col) = 0;
+    });
+  } else {
+    Kokkos::single(Kokkos::PerThread(team), [&] () {
+      m_fingerprint(col) = 0;
+    });
+  }
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT, typename IndexT, typename WeightT, LinInterpExtrap Extrap>
+template <typename ScalarView>
+KOKKOS_INLINE_FUNCTION
+void LinInterp<ScalarT, PackSize, DeviceT, IndexT, WeightT, Extrap>::store_weight(
+  const int col,
+  const int k,
+  const int k1,
+  const ScalarView& x1s,
+  const Scalar x2) const
+{
+  constexpr int N = Pack::n;
+
+  // Same as in lin_interp_impl: h=1, except at the last x1 entry, where h=-1
+  const int k1ph = k1==(m_km1-1) ? k1-1 : k1+1;
+  m_indx_map_ph(col, k/N)[k%N] = static_cast<Index>(k1ph);
+
+  // The target is outside of the x1 range iff w<0. Resolve the extrapolation
+  // policy here, so that lin_interp does not need to check. An invalid weight
+  // makes lin_interp produce an invalid value (or the fill value, for Fill).
+  Scalar w;
+  if (is_invalid(x2)) {
+    w = ScalarTraits<Scalar>::invalid();
+  } else {
+    w = (x2-x1s(k1)) / (x1s(k1ph)-x1s(k1));
+    if (Extrap==LinInterpExtrap::Clamp) {
+      w = w<0 ? 0 : w;
+    } else if (Extrap==LinInterpExtrap::Fill && w<0) {
+      w = ScalarTraits<Scalar>::invalid();
+    }
+  }
+  m_weights(col, k/N)[k%N] = static_cast<Weight>(w);
+}
+
 } // namespace ekat
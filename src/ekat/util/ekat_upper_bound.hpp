@@ -2,6 +2,9 @@
 #define EKAT_UPPER_BOUND_HPP
 
 #include "ekat/ekat.hpp"
+#include "ekat/ekat_pack.hpp"
+#include "ekat/ekat_assert.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
 
 #ifndef EKAT_ENABLE_GPU
 # include <algorithm>
@@ -58,6 +61,227 @@ const T* upper_bound(const T* first, const T* last, const T& value)
 using std::upper_bound;
 #endif
 
+/*
+ * Branchless binary search. Returns the same pointer as upper_bound, but
+ * the loop body only contains a conditional move, so the number of
+ * iterations depends only on the size of the range. This avoids branch
+ * mispredictions on CPU, and thread divergence on GPU.
+ */
+template<class T>
+KOKKOS_INLINE_FUNCTION
+const T* upper_bound_branchless(const T* first, const T* last, const T& value)
+{
+  int n = last - first;
+  if (n == 0) {
+    return first;
+  }
+
+  // Invariant: the result is in [first, first+n]
+  while (n > 1) {
+    const int half = n / 2;
+    first = (first[half] <= value) ? first + half : first;
+    n -= half;
+  }
+  return first + (*first <= value);
+}
+
+/*
+ * Branchless binary search of all the entries of a pack at once. Since the
+ * number of iterations does not depend on the searched value, all the lanes
+ * proceed in lockstep. Returns the offsets (from first) of the upper bounds.
+ */
+template<class T, int N>
+KOKKOS_INLINE_FUNCTION
+Pack<int,N> upper_bound_branchless(const T* first, const T* last, const Pack<T,N>& values)
+{
+  int n = last - first;
+  Pack<int,N> base(0);
+  if (n == 0) {
+    return base;
+  }
+
+  while (n > 1) {
+    const int half = n / 2;
+    vector_simd
+    for (int s=0; s<N; ++s) {
+      base[s] += (first[base[s]+half] <= values[s]) ? half : 0;
+    }
+    n -= half;
+  }
+  vector_simd
+  for (int s=0; s<N; ++s) {
+    base[s] += (first[base[s]] <= values[s]);
+  }
+  return base;
+}
+
+/*
+ * Eytzinger (BFS) layout of a sorted array: the entries are stored as the
+ * nodes of an implicit binary search tree, where the children of node k are
+ * 2k and 2k+1 (node 0 is unused). The first levels of the tree, which are hit
+ * by every search, are contiguous in memory, which makes the search much more
+ * cache friendly than a binary search for large arrays, and cheap to prefetch.
+ *
+ *  - eytz must have length n+1, and will contain the tree
+ *  - rank must have length n+1, and will contain, for each node, the position
+ *    of the corresponding entry in the sorted array (with rank[0]=n).
+ */
+template<class T>
+KOKKOS_INLINE_FUNCTION
+void eytzinger_build(const T* sorted, const int n, T* eytz, int* rank)
+{
+  rank[0] = n;
+  eytz[0] = n>0 ? sorted[n-1] : T();
+  if (n == 0) {
+    return;
+  }
+
+  // In-order traversal of the tree, starting from the left-most node
+  int k = 1;
+  while (2*k <= n) {
+    k *= 2;
+  }
+  for (int i=0; i<n; ++i) {
+    eytz[k] = sorted[i];
+    rank[k] = i;
+
+    // Move to the in-order successor: the left-most node of the right subtree,
+    // if any, otherwise the first ancestor of which we are in the left subtree
+    if (2*k+1 <= n) {
+      k = 2*k+1;
+      while (2*k <= n) {
+        k *= 2;
+      }
+    } else {
+      while (k & 1) {
+        k >>= 1;
+      }
+      k >>= 1;
+    }
+  }
+}
+
+// Number of iterations needed by a search in an eytzinger array of length n
+KOKKOS_INLINE_FUNCTION
+int eytzinger_depth(const int n)
+{
+  int depth = 0;
+  for (int m=n; m>0; m>>=1) {
+    ++depth;
+  }
+  return depth;
+}
+
+/*
+ * Search a tree built with eytzinger_build. Returns the same result as
+ * upper_bound(sorted,sorted+n,value)-sorted.
+ */
+template<class T>
+KOKKOS_INLINE_FUNCTION
+int eytzinger_upper_bound(const T* eytz, const int* rank, const int n, const T& value)
+{
+  // Go left if value<eytz[k], right otherwise. Once we fall off the tree,
+  // k encodes the path followed: the node we are looking for is the last one
+  // where we went left, which we find by removing all the trailing right turns
+  // (the 1 bits), plus the last left turn.
+  int k = 1;
+  while (k <= n) {
+    k = 2*k + (eytz[k] <= value);
+  }
+  while (k & 1) {
+    k >>= 1;
+  }
+  k >>= 1;
+  return rank[k];
+}
+
+// Pack version of the above. Lanes run in lockstep, so lanes that already
+// fell off the tree must not move anymore.
+template<class T, int N>
+KOKKOS_INLINE_FUNCTION
+Pack<int,N> eytzinger_upper_bound(const T* eytz, const int* rank, const int n, const Pack<T,N>& values)
+{
+  Pack<int,N> k(1);
+  const int depth = eytzinger_depth(n);
+  for (int d=0; d<depth; ++d) {
+    vector_simd
+    for (int s=0; s<N; ++s) {
+      const bool in = k[s] <= n;
+      const int kk = in ? k[s] : 0;
+      k[s] = in ? 2*kk + (eytz[kk] <= values[s]) : k[s];
+    }
+  }
+  for (int s=0; s<N; ++s) {
+    int ks = k[s];
+    while (ks & 1) {
+      ks >>= 1;
+    }
+    k[s] = rank[ks >> 1];
+  }
+  return k;
+}
+
+/*
+ * A search structure for lookup tables, that is, sorted arrays that are
+ * searched many times. The table is built on host at construction, and the
+ * upper_bound methods can be called on device.
+ */
+template<typename ScalarT, typename DeviceT=DefaultDevice>
+class EytzingerTable
+{
+public:
+  using Scalar = ScalarT;
+  using KT = KokkosTypes<DeviceT>;
+
+  template <typename S>
+  using view_1d = typename KT::template view_1d<S>;
+
+  EytzingerTable () = default;
+
+  // The input view must be sorted in increasing order
+  template<typename SrcView>
+  EytzingerTable (const SrcView& sorted)
+  {
+    static_assert (SrcView::rank==1, "Error! EytzingerTable requires a rank-1 view.\n");
+
+    m_n = sorted.extent(0);
+    m_eytz = view_1d<Scalar>("eytz",m_n+1);
+    m_rank = view_1d<int>("rank",m_n+1);
+
+    auto sorted_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(),sorted);
+    for (int i=1; i<m_n; ++i) {
+      EKAT_REQUIRE_MSG (sorted_h(i-1)<=sorted_h(i),
+          "Error! Input array to EytzingerTable is not sorted.\n");
+    }
+
+    auto eytz_h = Kokkos::create_mirror_view(m_eytz);
+    auto rank_h = Kokkos::create_mirror_view(m_rank);
+    eytzinger_build(sorted_h.data(),m_n,eytz_h.data(),rank_h.data());
+    Kokkos::deep_copy(m_eytz,eytz_h);
+    Kokkos::deep_copy(m_rank,rank_h);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  int size () const { return m_n; }
+
+  // Position of the first entry of the sorted array that is greater than value
+  KOKKOS_INLINE_FUNCTION
+  int upper_bound (const Scalar& value) const {
+    return eytzinger_upper_bound(m_eytz.data(),m_rank.data(),m_n,value);
+  }
+
+  template<int N>
+  KOKKOS_INLINE_FUNCTION
+  Pack<int,N> upper_bound (const Pack<Scalar,N>& values) const {
+    return eytzinger_upper_bound(m_eytz.data(),m_rank.data(),m_n,values);
+  }
+
+private:
+  int               m_n = 0;
+  view_1d<Scalar>   m_eytz;
+  view_1d<int>      m_rank;
+};
+
 } // namespace ekat
 
 #endif // EKAT_UPPER_BOUND_HPP
@@ -0,0 +1,205 @@
+#ifndef EKAT_VERT_INTERP_HPP
+#define EKAT_VERT_INTERP_HPP
+
+#include "ekat/util/ekat_lin_interp.hpp"
+#include "ekat/util/ekat_tridiag.hpp"
+
+namespace ekat {
+
+/*
+ * Interpolators that go beyond LinInterp, but share its setup machinery:
+ * they all inherit from LinInterp, so the index map is built with any of the
+ * setup methods of LinInterp (setup, setup_monotone, setup_if_changed, setup_dirty),
+ * and the same team policy is used. After setup, call interp (rather than
+ * lin_interp) to interpolate a field y1 from x1 onto x2.
+ *
+ *  - LogLinInterp: linear interpolation in log(x). Useful for pressure coordinates.
+ *                  All x1 and x2 must be positive.
+ *  - PchipInterp:  monotone piecewise cubic Hermite interpolation. Interior derivatives
+ *                  are the weighted harmonic mean of the secant slopes (Fritsch-Butland,
+ *                  Brodlie), as in Matlab's pchip; end derivatives use a shape-preserving
+ *                  three-point formula. Does not overshoot the data, and preserves monotonicity.
+ *  - SplineInterp: natural cubic spline. The spline second derivatives are obtained
+ *                  by solving a tridiagonal system per column (via ekat::tridiag).
+ *
+ * Like LinInterp, targets outside the range of x1 are extrapolated linearly
+ * (for the cubic interpolators, using the slope of the interpolant at the end point).
+ *
+ * Example: interpolate y1 from x1 to x2 with a natural cubic spline
+ *   Kokkos::parallel_for("interp",
+                           si.policy(),
+                           KOKKOS_LAMBDA(typename SI::MemberType const& team_member) {
+      const int i = team_member.league_rank();
+
+      auto x1col = subview(x1, i);
+      auto x2col = subview(x2, i);
+
+      si.setup(team_member, x1col, x2col);
+      team_member.team_barrier();
+      si.interp(team_member, x1col, x2col, subview(y1, i), subview(y2, i));
+    });
+ */
+
+template <typename ScalarT, int PackSize, typename DeviceT=DefaultDevice>
+struct LogLinInterp : public LinInterp<ScalarT,PackSize,DeviceT>
+{
+  using base_t = LinInterp<ScalarT,PackSize,DeviceT>;
+
+  using typename base_t::Scalar;
+  using typename base_t::Pack;
+  using typename base_t::MemberType;
+  template <typename S>
+  using view_1d = typename base_t::template view_1d<S>;
+
+  LogLinInterp(int ncol, int km1, int km2) : base_t(ncol,km1,km2) {}
+
+  // Since log is monotone, the index map of LinInterp is also valid for log(x1),log(x2),
+  // so any of the LinInterp setup methods can be called on x1 and x2 directly.
+
+  // Interpolate y(x1) onto coordinates x2, linearly in log(x).
+  template <typename V1, typename V2, typename V3, typename V4>
+  KOKKOS_INLINE_FUNCTION
+  void interp(
+    const MemberType& team,
+    const V1& x1,
+    const V2& x2,
+    const V3& y1,
+    const V4& y2,
+    const Int col=-1) const;
+
+  // Same as above except uses a user-provided range boundary struct. This will likely
+  // be a ThreadVectorRange.
+  template <typename V1, typename V2, typename V3, typename V4, typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void interp(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const V1& x1,
+    const V2& x2,
+    const V3& y1,
+    const V4& y2,
+    const Int col=-1) const;
+
+protected:
+
+  template <typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void interp_impl(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const view_1d<const Pack>& x1, const view_1d<const Pack>& x2, const view_1d<const Pack>& y1,
+    const view_1d<Pack>& y2,
+    const Int col) const;
+};
+
+template <typename ScalarT, int PackSize, typename DeviceT=DefaultDevice>
+struct PchipInterp : public LinInterp<ScalarT,PackSize,DeviceT>
+{
+  using base_t = LinInterp<ScalarT,PackSize,DeviceT>;
+
+  using typename base_t::Scalar;
+  using typename base_t::Pack;
+  using typename base_t::MemberType;
+  template <typename S>
+  using view_1d = typename base_t::template view_1d<S>;
+
+  PchipInterp(int ncol, int km1, int km2) : base_t(ncol,km1,km2) {}
+
+  // Interpolate y(x1) onto coordinates x2 with a monotone cubic. The derivatives
+  // at the two ends of the interval containing each target are computed on the fly,
+  // so no workspace (nor team barrier) is needed.
+  template <typename V1, typename V2, typename V3, typename V4>
+  KOKKOS_INLINE_FUNCTION
+  void interp(
+    const MemberType& team,
+    const V1& x1,
+    const V2& x2,
+    const V3& y1,
+    const V4& y2,
+    const Int col=-1) const;
+
+  // Same as above except uses a user-provided range boundary struct. This will likely
+  // be a ThreadVectorRange.
+  template <typename V1, typename V2, typename V3, typename V4, typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void interp(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const V1& x1,
+    const V2& x2,
+    const V3& y1,
+    const V4& y2,
+    const Int col=-1) const;
+
+protected:
+
+  template <typename RangeBoundary>
+  KOKKOS_INLINE_FUNCTION
+  void interp_impl(
+    const MemberType& team,
+    const RangeBoundary& range_boundary,
+    const view_1d<const Pack>& x1, const view_1d<const Pack>& x2, const view_1d<const Pack>& y1,
+    const view_1d<Pack>& y2,
+    const Int col) const;
+
+  // Derivative at an interior node, given the widths and secant slopes of the
+  // intervals to its left (hl,dl) and right (hr,dr)
+  KOKKOS_INLINE_FUNCTION
+  static Scalar interior_deriv(const Scalar hl, const Scalar dl, const Scalar hr, const Scalar dr);
+
+  // Derivative at an end node, given the widths and secant slopes of the first
+  // (h0,d0) and second (h1,d1) intervals, counting from the end node
+  KOKKOS_INLINE_FUNCTION
+  static Scalar end_deriv(const Scalar h0, const Scalar d0, const Scalar h1, const Scalar d1);
+};
+
+template <typename ScalarT, int PackSize, typename DeviceT=DefaultDevice>
+struct SplineInterp : public LinInterp<ScalarT,PackSize,DeviceT>
+{
+  using base_t = LinInterp<ScalarT,PackSize,DeviceT>;
+
+  using typename base_t::Scalar;
+  using typename base_t::Pack;
+  using typename base_t::MemberType;
+  template <typename S>
+  using view_1d = typename base_t::template view_1d<S>;
+  template <typename S>
+  using view_2d = typename base_t::template view_2d<S>;
+
+  // Allocates 4*ncol*km1 scalars of workspace, to store the tridiagonal
+  // system and the spline second derivatives of each column.
+  SplineInterp(int ncol, int km1, int km2);
+
+  // Interpolate y(x1) onto coordinates x2 with a natural cubic spline. This
+  // requires a tridiagonal solve, hence team barriers, so there is no version
+  // taking a user-provided range boundary.
+  template <typename V1, typename V2, typename V3, typename V4>
+  KOKKOS_INLINE_FUNCTION
+  void interp(
+    const MemberType& team,
+    const V1& x1,
+    const V2& x2,
+    const V3& y1,
+    const V4& y2,
+    const Int col=-1) const;
+
+protected:
+
+  KOKKOS_INLINE_FUNCTION
+  void interp_impl(
+    const MemberType& team,
+    const view_1d<const Pack>& x1, const view_1d<const Pack>& x2, const view_1d<const Pack>& y1,
+    const view_1d<Pack>& y2,
+    const Int col) const;
+
+  view_2d<Scalar> m_dl;   // [col][x1_idx] -> tridiag lower diagonal
+  view_2d<Scalar> m_d;    // [col][x1_idx] -> tridiag diagonal
+  view_2d<Scalar> m_du;   // [col][x1_idx] -> tridiag upper diagonal
+  view_2d<Scalar> m_y2nd; // [col][x1_idx] -> spline second derivative
+};
+
+} //namespace ekat
+
+#include "ekat_vert_interp_impl.hpp"
+
+#endif // EKAT_VERT_INTERP_HPP
@@ -0,0 +1,354 @@
+#ifndef EKAT_VERT_INTERP_HPP
+#include "ekat_vert_interp.hpp"
+#endif
+
+#include "ekat/ekat_pack_math.hpp"
+
+namespace ekat {
+
+// Never include this header directly, only ekat_vert_interp.hpp should include it
+
+// ---------------------- LogLinInterp ---------------------- //
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2, typename V3, typename V4>
+KOKKOS_INLINE_FUNCTION
+void LogLinInterp<ScalarT, PackSize, DeviceT>::interp(
+  const MemberType& team,
+  const V1& x1,
+  const V2& x2,
+  const V3& y1,
+  const V4& y2,
+  const Int col) const
+{
+  interp_impl(team,
+              Kokkos::TeamVectorRange(team, this->m_km2_pack),
+              ekat::repack<Pack::n>(x1),
+              ekat::repack<Pack::n>(x2),
+              ekat::repack<Pack::n>(y1),
+              ekat::repack<Pack::n>(y2),
+              col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2, typename V3, typename V4, typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void LogLinInterp<ScalarT, PackSize, DeviceT>::interp(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const V1& x1,
+  const V2& x2,
+  const V3& y1,
+  const V4& y2,
+  const Int col) const
+{
+  interp_impl(team,
+              range_boundary,
+              ekat::repack<Pack::n>(x1),
+              ekat::repack<Pack::n>(x2),
+              ekat::repack<Pack::n>(y1),
+              ekat::repack<Pack::n>(y2),
+              col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void LogLinInterp<ScalarT, PackSize, DeviceT>::interp_impl(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const view_1d<const Pack>& x1,
+  const view_1d<const Pack>& x2,
+  const view_1d<const Pack>& y1,
+  const view_1d<      Pack>& y2,
+  const Int col) const
+{
+  constexpr int N = Pack::n;
+
+  auto x1s = scalarize(x1);
+  auto y1s = scalarize(y1);
+
+  const int i = col == -1 ? team.league_rank() : col;
+  const int km1 = this->m_km1;
+  const int km2 = this->m_km2;
+
+  Kokkos::parallel_for(range_boundary, [&] (Int k2) {
+    Pack x1_k1, x1_k1ph, y1_k1, y1_k1ph, x2_k2;
+
+    // Same as LinInterp::lin_interp_impl, with x replaced by log(x)
+    const auto& k1 = this->m_indx_map(i, k2);
+    for (int s=0; s<N; ++s) {
+      const int k1ph = k1[s]==(km1-1) ? k1[s]-1 : k1[s]+1;
+      x1_k1[s]   = x1s(k1[s]);
+      x1_k1ph[s] = x1s(k1ph);
+      y1_k1[s]   = y1s(k1[s]);
+      y1_k1ph[s] = y1s(k1ph);
+
+      // The padding at the end of x2 may contain anything (e.g., zeros),
+      // so replace it with a valid value before taking the log
+      x2_k2[s] = (k2*N+s)<km2 ? x2(k2)[s] : x1_k1[s];
+    }
+    const auto lx1_k1 = ekat::log(x1_k1);
+
+    auto& y2_k2 = y2(k2);
+    y2_k2  = y1_k1ph-y1_k1;
+    y2_k2 *= ekat::log(x2_k2)-lx1_k1;
+    y2_k2 /= ekat::log(x1_k1ph)-lx1_k1;
+    y2_k2 += y1_k1;
+  });
+}
+
+// ---------------------- PchipInterp ---------------------- //
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2, typename V3, typename V4>
+KOKKOS_INLINE_FUNCTION
+void PchipInterp<ScalarT, PackSize, DeviceT>::interp(
+  const MemberType& team,
+  const V1& x1,
+  const V2& x2,
+  const V3& y1,
+  const V4& y2,
+  const Int col) const
+{
+  interp_impl(team,
+              Kokkos::TeamVectorRange(team, this->m_km2_pack),
+              ekat::repack<Pack::n>(x1),
+              ekat::repack<Pack::n>(x2),
+              ekat::repack<Pack::n>(y1),
+              ekat::repack<Pack::n>(y2),
+              col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2, typename V3, typename V4, typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void PchipInterp<ScalarT, PackSize, DeviceT>::interp(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const V1& x1,
+  const V2& x2,
+  const V3& y1,
+  const V4& y2,
+  const Int col) const
+{
+  interp_impl(team,
+              range_boundary,
+              ekat::repack<Pack::n>(x1),
+              ekat::repack<Pack::n>(x2),
+              ekat::repack<Pack::n>(y1),
+              ekat::repack<Pack::n>(y2),
+              col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+KOKKOS_INLINE_FUNCTION
+typename PchipInterp<ScalarT, PackSize, DeviceT>::Scalar
+PchipInterp<ScalarT, PackSize, DeviceT>::interior_deriv(
+  const Scalar hl, const Scalar dl, const Scalar hr, const Scalar dr)
+{
+  // Local extrema get a zero derivative. Otherwise, use the weighted
+  // harmonic mean of the secant slopes (Fritsch-Butland / Brodlie)
+  if (dl*dr <= 0) {
+    return 0;
+  }
+  const Scalar wl = 2*hr + hl;
+  const Scalar wr = hr + 2*hl;
+  return (wl+wr) / (wl/dl + wr/dr);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+KOKKOS_INLINE_FUNCTION
+typename PchipInterp<ScalarT, PackSize, DeviceT>::Scalar
+PchipInterp<ScalarT, PackSize, DeviceT>::end_deriv(
+  const Scalar h0, const Scalar d0, const Scalar h1, const Scalar d1)
+{
+  // Non-centered three-point formula, adjusted to preserve shape
+  Scalar d = ((2*h0 + h1)*d0 - h0*d1) / (h0 + h1);
+  if (d*d0 <= 0) {
+    d = 0;
+  } else if (d0*d1 <= 0 && d*d > 9*d0*d0) {
+    d = 3*d0;
+  }
+  return d;
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename RangeBoundary>
+KOKKOS_INLINE_FUNCTION
+void PchipInterp<ScalarT, PackSize, DeviceT>::interp_impl(
+  const MemberType& team,
+  const RangeBoundary& range_boundary,
+  const view_1d<const Pack>& x1,
+  const view_1d<const Pack>& x2,
+  const view_1d<const Pack>& y1,
+  const view_1d<      Pack>& y2,
+  const Int col) const
+{
+  constexpr int N = Pack::n;
+
+  auto x1s = scalarize(x1);
+  auto y1s = scalarize(y1);
+
+  const int i = col == -1 ? team.league_rank() : col;
+  const int km1 = this->m_km1;
+
+  Kokkos::parallel_for(range_boundary, [&] (Int k2) {
+    const auto& k1 = this->m_indx_map(i, k2);
+    auto& y2_k2 = y2(k2);
+    for (int s=0; s<N; ++s) {
+      // Interval [j,j+1] containing the target (or closest to it, if outside x1 range)
+      const int j = k1[s] < km1-1 ? k1[s] : km1-2;
+
+      const Scalar xa = x1s(j);
+      const Scalar xb = x1s(j+1);
+      const Scalar ya = y1s(j);
+      const Scalar yb = y1s(j+1);
+      const Scalar h = xb - xa;
+      const Scalar delta = (yb - ya) / h;
+
+      // Secants of the intervals adjacent to [j,j+1], if any
+      const bool has_l = j > 0;
+      const bool has_r = j+2 < km1;
+      const Scalar hl = has_l ? xa - x1s(j-1) : 0;
+      const Scalar dl = has_l ? (ya - y1s(j-1)) / hl : 0;
+      const Scalar hr = has_r ? x1s(j+2) - xb : 0;
+      const Scalar dr = has_r ? (y1s(j+2) - yb) / hr : 0;
+
+      const Scalar da = has_l ? interior_deriv(hl,dl,h,delta)
+                              : (has_r ? end_deriv(h,delta,hr,dr) : delta);
+      const Scalar db = has_r ? interior_deriv(h,delta,hr,dr)
+                              : (has_l ? end_deriv(h,delta,hl,dl) : delta);
+
+      const Scalar x = x2(k2)[s];
+      if (x < xa) {
+        y2_k2[s] = ya + da*(x-xa);
+      } else if (x > xb) {
+        y2_k2[s] = yb + db*(x-xb);
+      } else {
+        // Cubic Hermite basis
+        const Scalar t = (x-xa) / h;
+        const Scalar omt = 1-t;
+        y2_k2[s] = omt*omt*((1+2*t)*ya + t*h*da)
+                 + t*t*((3-2*t)*yb - omt*h*db);
+      }
+    }
+  });
+}
+
+// ---------------------- SplineInterp ---------------------- //
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+SplineInterp<ScalarT, PackSize, DeviceT>::SplineInterp(int ncol, int km1, int km2) :
+  base_t(ncol, km1, km2),
+  m_dl("m_dl", ncol, km1),
+  m_d("m_d", ncol, km1),
+  m_du("m_du", ncol, km1),
+  m_y2nd("m_y2nd", ncol, km1)
+{}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+template <typename V1, typename V2, typename V3, typename V4>
+KOKKOS_INLINE_FUNCTION
+void SplineInterp<ScalarT, PackSize, DeviceT>::interp(
+  const MemberType& team,
+  const V1& x1,
+  const V2& x2,
+  const V3& y1,
+  const V4& y2,
+  const Int col) const
+{
+  interp_impl(team,
+              ekat::repack<Pack::n>(x1),
+              ekat::repack<Pack::n>(x2),
+              ekat::repack<Pack::n>(y1),
+              ekat::repack<Pack::n>(y2),
+              col);
+}
+
+template <typename ScalarT, int PackSize, typename DeviceT>
+KOKKOS_INLINE_FUNCTION
+void SplineInterp<ScalarT, PackSize, DeviceT>::interp_impl(
+  const MemberType& team,
+  const view_1d<const Pack>& x1,
+  const view_1d<const Pack>& x2,
+  const view_1d<const Pack>& y1,
+  const view_1d<      Pack>& y2,
+  const Int col) const
+{
+  constexpr int N = Pack::n;
+
+  auto x1s = scalarize(x1);
+  auto y1s = scalarize(y1);
+
+  const int i = col == -1 ? team.league_rank() : col;
+  const int km1 = this->m_km1;
+
+  auto dl = ekat::subview(m_dl, i);
+  auto d  = ekat::subview(m_d, i);
+  auto du = ekat::subview(m_du, i);
+  auto M  = ekat::subview(m_y2nd, i);
+
+  // Assemble the system for the second derivatives M:
+  //   h(k-1)*M(k-1) + 2*(h(k-1)+h(k))*M(k) + h(k)*M(k+1) = 6*(delta(k)-delta(k-1)),
+  // with M=0 at the two end points (natural spline).
+  Kokkos::parallel_for(Kokkos::TeamVectorRange(team, km1), [&] (Int k) {
+    if (k==0 || k==km1-1) {
+      dl(k) = 0;
+      d(k)  = 1;
+      du(k) = 0;
+      M(k)  = 0;
+    } else {
+      const Scalar hl = x1s(k) - x1s(k-1);
+      const Scalar hr = x1s(k+1) - x1s(k);
+      dl(k) = hl;
+      d(k)  = 2*(hl+hr);
+      du(k) = hr;
+      M(k)  = 6*((y1s(k+1)-y1s(k))/hr - (y1s(k)-y1s(k-1))/hl);
+    }
+  });
+  team.team_barrier();
+
+  // The matrix is strictly diagonally dominant, so no pivoting is needed
+#ifdef EKAT_ENABLE_GPU
+  tridiag::cr(team, dl, d, du, M);
+#else
+  using RhsView = Kokkos::View<Scalar**, Kokkos::LayoutRight, DeviceT, Kokkos::MemoryUnmanaged>;
+  tridiag::thomas(team, dl, d, du, RhsView(M.data(), km1, 1));
+#endif
+  team.team_barrier();
+
+  Kokkos::parallel_for(Kokkos::TeamVectorRange(team, this->m_km2_pack), [&] (Int k2) {
+    const auto& k1 = this->m_indx_map(i, k2);
+    auto& y2_k2 = y2(k2);
+    for (int s=0; s<N; ++s) {
+      // Interval [j,j+1] containing the target (or closest to it, if outside x1 range)
+      const int j = k1[s] < km1-1 ? k1[s] : km1-2;
+
+      const Scalar xa = x1s(j);
+      const Scalar xb = x1s(j+1);
+      const Scalar ya = y1s(j);
+      const Scalar yb = y1s(j+1);
+      const Scalar Ma = M(j);
+      const Scalar Mb = M(j+1);
+      const Scalar h = xb - xa;
+
+      const Scalar x = x2(k2)[s];
+      if (x < xa) {
+        // Slope of the spline at xa
+        const Scalar da = (yb-ya)/h - h*(2*Ma+Mb)/6;
+        y2_k2[s] = ya + da*(x-xa);
+      } else if (x > xb) {
+        // Slope of the spline at xb
+        const Scalar db = (yb-ya)/h + h*(Ma+2*Mb)/6;
+        y2_k2[s] = yb + db*(x-xb);
+      } else {
+        const Scalar b = (x-xa) / h;
+        const Scalar a = 1-b;
+        y2_k2[s] = a*ya + b*yb + ((a*a*a-a)*Ma + (b*b*b-b)*Mb)*(h*h)/6;
+      }
+    }
+  });
+}
+
+} // namespace ekat
@@ -0,0 +1,207 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/util/ekat_conservative_remap.hpp"
+
+#include "ekat_test_config.h"
+
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using Pack = ekat::Pack<Real,EKAT_TEST_PACK_SIZE>;
+using KT = ekat::KokkosTypes<ekat::DefaultDevice>;
+using packed_view_2d = KT::view_2d<Pack>;
+using CR = ekat::ConservativeRemap<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+
+// Fill the km+1 interfaces of a column with sorted random values in (lo,hi),
+// with the first and last interfaces exactly equal to lo and hi
+template <typename Generator>
+void populate_interfaces (Real* data, const int km, const Real lo, const Real hi, Generator& gen) {
+  std::uniform_real_distribution<Real> dist(lo,hi);
+  bool done = false;
+  while (!done) {
+    data[0] = lo;
+    data[km] = hi;
+    for (int k = 1; k < km; ++k) {
+      data[k] = dist(gen);
+    }
+    std::sort(data, data+km+1);
+    done = std::adjacent_find(data, data+km+1) == data+km+1;
+  }
+}
+
+void run_remap (const CR& cr,
+                const packed_view_2d& xi1,
+                const packed_view_2d& xi2,
+                const packed_view_2d& y1,
+                const packed_view_2d& y2)
+{
+  Kokkos::parallel_for("cons-remap-ut",
+                       cr.policy(),
+                       KOKKOS_LAMBDA(typename CR::MemberType const& team_member) {
+    const int i = team_member.league_rank();
+    auto xi1c = ekat::subview(xi1, i);
+    auto xi2c = ekat::subview(xi2, i);
+    cr.setup(team_member, xi1c, xi2c);
+    team_member.team_barrier();
+    cr.remap(team_member, xi1c, xi2c, ekat::subview(y1, i), ekat::subview(y2, i));
+  });
+}
+
+TEST_CASE("conservative_remap", "remap") {
+  using Catch::Detail::Approx;
+  constexpr Real tol = std::numeric_limits<Real>::epsilon()*1000;
+
+  const auto schemes = {ekat::RemapScheme::PiecewiseConstant,
+                        ekat::RemapScheme::PiecewiseParabolic,
+                        ekat::RemapScheme::PiecewiseParabolicLimited};
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<Real> y_dist(-1,1);
+  std::uniform_int_distribution<int> k_dist(1,80);
+  const int ncol = 5;
+
+  for (int r = 0; r < 10; ++r) {
+    const int km1 = k_dist(generator);
+    const int km2 = k_dist(generator);
+
+    packed_view_2d
+      xi1("xi1", ncol, ekat::npack<Pack>(km1+1)),
+      xi2("xi2", ncol, ekat::npack<Pack>(km2+1)),
+      y1("y1", ncol, ekat::npack<Pack>(km1)),
+      y2("y2", ncol, ekat::npack<Pack>(km2));
+
+    auto xi1_h = Kokkos::create_mirror_view(ekat::scalarize(xi1));
+    auto xi2_h = Kokkos::create_mirror_view(ekat::scalarize(xi2));
+    // Not a mirror view, since y1 is overwritten with other data below
+    auto y1_h  = Kokkos::create_mirror(ekat::scalarize(y1));
+    auto y2_h  = Kokkos::create_mirror_view(ekat::scalarize(y2));
+
+    for (int i = 0; i < ncol; ++i) {
+      populate_interfaces(&xi1_h(i,0), km1, 0, 1, generator);
+      populate_interfaces(&xi2_h(i,0), km2, 0, 1, generator);
+      for (int k = 0; k < km1; ++k) {
+        y1_h(i,k) = y_dist(generator);
+      }
+    }
+    Kokkos::deep_copy(ekat::scalarize(xi1), xi1_h);
+    Kokkos::deep_copy(ekat::scalarize(xi2), xi2_h);
+
+    for (auto scheme : schemes) {
+      CR cr(ncol, km1, km2, scheme);
+      REQUIRE (cr.scheme()==scheme);
+
+      {
+        // A constant field is preserved
+        Kokkos::deep_copy(y1, Pack(3));
+        run_remap(cr, xi1, xi2, y1, y2);
+        Kokkos::deep_copy(y2_h, ekat::scalarize(y2));
+        for (int i = 0; i < ncol; ++i) {
+          for (int k = 0; k < km2; ++k) {
+            REQUIRE (y2_h(i,k)==Approx(3).epsilon(tol));
+          }
+        }
+      }
+
+      {
+        // The column integral is preserved, and the limited scheme does not
+        // create new extrema
+        Kokkos::deep_copy(ekat::scalarize(y1), y1_h);
+        run_remap(cr, xi1, xi2, y1, y2);
+        Kokkos::deep_copy(y2_h, ekat::scalarize(y2));
+        for (int i = 0; i < ncol; ++i) {
+          Real mass1 = 0, mass2 = 0;
+          for (int k = 0; k < km1; ++k) {
+            mass1 += y1_h(i,k)*(xi1_h(i,k+1)-xi1_h(i,k));
+          }
+          for (int k = 0; k < km2; ++k) {
+            mass2 += y2_h(i,k)*(xi2_h(i,k+1)-xi2_h(i,k));
+          }
+          REQUIRE (mass2==Approx(mass1).epsilon(tol).margin(tol));
+
+          if (scheme!=ekat::RemapScheme::PiecewiseParabolic) {
+            const Real ymin = *std::min_element(&y1_h(i,0),&y1_h(i,0)+km1);
+            const Real ymax = *std::max_element(&y1_h(i,0),&y1_h(i,0)+km1);
+            for (int k = 0; k < km2; ++k) {
+              REQUIRE (y2_h(i,k)>=ymin-tol);
+              REQUIRE (y2_h(i,k)<=ymax+tol);
+            }
+          }
+        }
+      }
+
+      {
+        // Remapping onto the same layers is the identity
+        Kokkos::deep_copy(ekat::scalarize(y1), y1_h);
+        CR cr_id(ncol, km1, km1, scheme);
+        packed_view_2d y1_out_d("y1_out", ncol, ekat::npack<Pack>(km1));
+        run_remap(cr_id, xi1, xi1, y1, y1_out_d);
+        auto y1_out = Kokkos::create_mirror_view(ekat::scalarize(y1_out_d));
+        Kokkos::deep_copy(y1_out, ekat::scalarize(y1_out_d));
+        for (int i = 0; i < ncol; ++i) {
+          for (int k = 0; k < km1; ++k) {
+            REQUIRE (y1_out(i,k)==Approx(y1_h(i,k)).epsilon(tol).margin(tol));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("conservative_remap_accuracy", "remap") {
+  // On a smooth field, PPM is considerably more accurate than PCM
+  const int ncol = 1;
+  const int km1 = 64;
+  const int km2 = 50;
+
+  packed_view_2d
+    xi1("xi1", ncol, ekat::npack<Pack>(km1+1)),
+    xi2("xi2", ncol, ekat::npack<Pack>(km2+1)),
+    y1("y1", ncol, ekat::npack<Pack>(km1)),
+    y2("y2", ncol, ekat::npack<Pack>(km2));
+
+  auto xi1_h = Kokkos::create_mirror_view(ekat::scalarize(xi1));
+  auto xi2_h = Kokkos::create_mirror_view(ekat::scalarize(xi2));
+  auto y1_h  = Kokkos::create_mirror_view(ekat::scalarize(y1));
+  auto y2_h  = Kokkos::create_mirror_view(ekat::scalarize(y2));
+
+  // Layer averages of sin(x)
+  auto avg = [] (const Real a, const Real b) {
+    return (std::cos(a)-std::cos(b))/(b-a);
+  };
+  for (int k = 0; k <= km1; ++k) {
+    xi1_h(0,k) = Real(k)/km1;
+  }
+  for (int k = 0; k <= km2; ++k) {
+    xi2_h(0,k) = Real(k)/km2;
+  }
+  for (int k = 0; k < km1; ++k) {
+    y1_h(0,k) = avg(xi1_h(0,k),xi1_h(0,k+1));
+  }
+  Kokkos::deep_copy(ekat::scalarize(xi1), xi1_h);
+  Kokkos::deep_copy(ekat::scalarize(xi2), xi2_h);
+  Kokkos::deep_copy(ekat::scalarize(y1), y1_h);
+
+  auto max_err = [&] (const ekat::RemapScheme scheme) {
+    CR cr(ncol, km1, km2, scheme);
+    run_remap(cr, xi1, xi2, y1, y2);
+    Kokkos::deep_copy(y2_h, ekat::scalarize(y2));
+    Real err = 0;
+    // Skip the layers next to the boundaries, where PPM drops to lower order
+    for (int k = 2; k < km2-2; ++k) {
+      err = std::max(err, std::abs(y2_h(0,k)-avg(xi2_h(0,k),xi2_h(0,k+1))));
+    }
+    return err;
+  };
+
+  const Real err_pcm = max_err(ekat::RemapScheme::PiecewiseConstant);
+  const Real err_ppm = max_err(ekat::RemapScheme::PiecewiseParabolic);
+  const Real err_lim = max_err(ekat::RemapScheme::PiecewiseParabolicLimited);
+  REQUIRE (err_ppm < err_pcm/10);
+  REQUIRE (err_lim < err_pcm/10);
+}
+
+} // empty namespace
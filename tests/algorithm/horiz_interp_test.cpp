@@ -0,0 +1,215 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/util/ekat_horiz_interp.hpp"
+
+#include "ekat_test_config.h"
+
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using Pack = ekat::Pack<Real,EKAT_TEST_PACK_SIZE>;
+using KT = ekat::KokkosTypes<ekat::DefaultDevice>;
+using HI = ekat::HorizInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+using view_1d = KT::view_1d<Real>;
+using packed_view_2d = KT::view_2d<Pack>;
+
+// A lat/lon grid with (slightly) irregular spacing
+void make_grid (const view_1d& lat, const view_1d& lon, std::default_random_engine& gen)
+{
+  std::uniform_real_distribution<Real> pert(-0.25,0.25);
+  const int nlat = lat.extent_int(0);
+  const int nlon = lon.extent_int(0);
+  auto lat_h = Kokkos::create_mirror_view(lat);
+  auto lon_h = Kokkos::create_mirror_view(lon);
+  const Real dlat = Real(170)/(nlat-1);
+  const Real dlon = Real(360)/nlon;
+  for (int j = 0; j < nlat; ++j) {
+    lat_h(j) = -85 + dlat*(j + (j==0 || j==nlat-1 ? 0 : pert(gen)));
+  }
+  for (int i = 0; i < nlon; ++i) {
+    lon_h(i) = -180 + dlon*(i + pert(gen));
+  }
+  Kokkos::deep_copy(lat, lat_h);
+  Kokkos::deep_copy(lon, lon_h);
+}
+
+TEST_CASE("horiz_interp_bilinear", "horiz_interp") {
+  using Catch::Detail::Approx;
+  constexpr Real tol = std::numeric_limits<Real>::epsilon()*1000;
+
+  std::default_random_engine generator;
+  const int nlat = 19;
+  const int nlon = 36;
+  const int nsrc = nlat*nlon;
+  const int ntgt = 500;
+  const int nlev = 13;
+
+  view_1d src_lat("src_lat", nlat), src_lon("src_lon", nlon);
+  view_1d tgt_lat("tgt_lat", ntgt), tgt_lon("tgt_lon", ntgt);
+  make_grid(src_lat, src_lon, generator);
+
+  // Targets everywhere, including across the lon seam, poleward of the source
+  // grid, and with longitudes outside of [-180,180)
+  auto src_lat_h = Kokkos::create_mirror_view(src_lat);
+  auto src_lon_h = Kokkos::create_mirror_view(src_lon);
+  auto tgt_lat_h = Kokkos::create_mirror_view(tgt_lat);
+  auto tgt_lon_h = Kokkos::create_mirror_view(tgt_lon);
+  Kokkos::deep_copy(src_lat_h, src_lat);
+  Kokkos::deep_copy(src_lon_h, src_lon);
+  std::uniform_real_distribution<Real> lat_dist(-90,90);
+  std::uniform_real_distribution<Real> lon_dist(-540,540);
+  for (int t = 0; t < ntgt; ++t) {
+    tgt_lat_h(t) = lat_dist(generator);
+    tgt_lon_h(t) = lon_dist(generator);
+  }
+  Kokkos::deep_copy(tgt_lat, tgt_lat_h);
+  Kokkos::deep_copy(tgt_lon, tgt_lon_h);
+
+  HI hi(nlat, nlon, ntgt);
+  REQUIRE (hi.nnz()==4);
+  hi.setup(src_lat, src_lon, tgt_lat, tgt_lon);
+
+  // Weights are a partition of unity
+  auto w = Kokkos::create_mirror_view(hi.weights());
+  Kokkos::deep_copy(w, hi.weights());
+  for (int t = 0; t < ntgt; ++t) {
+    Real sum = 0;
+    for (int n = 0; n < hi.nnz(); ++n) {
+      REQUIRE (w(t,n)>=-tol);
+      sum += w(t,n);
+    }
+    REQUIRE (sum==Approx(1).epsilon(tol));
+  }
+
+  // Fields that depend only on the latitude are linear within each cell, and
+  // constant poleward of the source grid. Regrid one such field per level.
+  auto f = [&](const Real lat, const int k) {
+    const Real latc = std::min(std::max(lat,src_lat_h(0)),src_lat_h(nlat-1));
+    return (k+1)*latc + k;
+  };
+
+  view_1d y1_2d("y1_2d", nsrc), y2_2d("y2_2d", ntgt);
+  packed_view_2d y1("y1", nsrc, ekat::npack<Pack>(nlev)), y2("y2", ntgt, ekat::npack<Pack>(nlev));
+  auto y1_2d_h = Kokkos::create_mirror_view(y1_2d);
+  auto y1_h = Kokkos::create_mirror_view(ekat::scalarize(y1));
+  for (int j = 0; j < nlat; ++j) {
+    for (int i = 0; i < nlon; ++i) {
+      y1_2d_h(j*nlon+i) = f(src_lat_h(j),0);
+      for (int k = 0; k < nlev; ++k) {
+        y1_h(j*nlon+i,k) = f(src_lat_h(j),k);
+      }
+    }
+  }
+  Kokkos::deep_copy(y1_2d, y1_2d_h);
+  Kokkos::deep_copy(ekat::scalarize(y1), y1_h);
+
+  hi.apply(y1_2d, y2_2d);
+  hi.apply(y1, y2);
+
+  auto y2_2d_h = Kokkos::create_mirror_view(y2_2d);
+  auto y2_h = Kokkos::create_mirror_view(ekat::scalarize(y2));
+  Kokkos::deep_copy(y2_2d_h, y2_2d);
+  Kokkos::deep_copy(y2_h, ekat::scalarize(y2));
+  for (int t = 0; t < ntgt; ++t) {
+    REQUIRE (y2_2d_h(t)==Approx(f(tgt_lat_h(t),0)).epsilon(tol).margin(tol));
+    for (int k = 0; k < nlev; ++k) {
+      REQUIRE (y2_h(t,k)==Approx(f(tgt_lat_h(t),k)).epsilon(tol).margin(tol*nlev));
+    }
+  }
+
+  // The team-level apply gives the same result
+  packed_view_2d y2_team("y2_team", ntgt, ekat::npack<Pack>(nlev));
+  Kokkos::parallel_for("horiz-interp-ut",
+                       hi.policy(ekat::npack<Pack>(nlev)),
+                       KOKKOS_LAMBDA(const HI::MemberType& team) {
+    hi.apply(team, y1, ekat::subview(y2_team, team.league_rank()));
+  });
+  auto y2_team_h = Kokkos::create_mirror_view(ekat::scalarize(y2_team));
+  Kokkos::deep_copy(y2_team_h, ekat::scalarize(y2_team));
+  for (int t = 0; t < ntgt; ++t) {
+    for (int k = 0; k < nlev; ++k) {
+      REQUIRE (y2_team_h(t,k)==y2_h(t,k));
+    }
+  }
+
+  // Away from the seam, a field that is bilinear in (lat,lon) is reproduced exactly
+  std::uniform_real_distribution<Real> lon_in_dist(src_lon_h(0),src_lon_h(nlon-1));
+  std::uniform_real_distribution<Real> lat_in_dist(src_lat_h(0),src_lat_h(nlat-1));
+  for (int t = 0; t < ntgt; ++t) {
+    tgt_lat_h(t) = lat_in_dist(generator);
+    tgt_lon_h(t) = lon_in_dist(generator);
+  }
+  Kokkos::deep_copy(tgt_lat, tgt_lat_h);
+  Kokkos::deep_copy(tgt_lon, tgt_lon_h);
+  hi.setup(src_lat, src_lon, tgt_lat, tgt_lon);
+
+  auto g = [](const Real lat, const Real lon) {
+    return 1 + lat/90 - lon/180 + lat*lon/(90*180);
+  };
+  for (int j = 0; j < nlat; ++j) {
+    for (int i = 0; i < nlon; ++i) {
+      y1_2d_h(j*nlon+i) = g(src_lat_h(j),src_lon_h(i));
+    }
+  }
+  Kokkos::deep_copy(y1_2d, y1_2d_h);
+  hi.apply(y1_2d, y2_2d);
+  Kokkos::deep_copy(y2_2d_h, y2_2d);
+  for (int t = 0; t < ntgt; ++t) {
+    REQUIRE (y2_2d_h(t)==Approx(g(tgt_lat_h(t),tgt_lon_h(t))).epsilon(tol).margin(tol));
+  }
+}
+
+TEST_CASE("horiz_interp_nearest", "horiz_interp") {
+  std::default_random_engine generator;
+  const int nlat = 10;
+  const int nlon = 20;
+  const int nsrc = nlat*nlon;
+
+  view_1d src_lat("src_lat", nlat), src_lon("src_lon", nlon);
+  make_grid(src_lat, src_lon, generator);
+  auto src_lat_h = Kokkos::create_mirror_view(src_lat);
+  auto src_lon_h = Kokkos::create_mirror_view(src_lon);
+  Kokkos::deep_copy(src_lat_h, src_lat);
+  Kokkos::deep_copy(src_lon_h, src_lon);
+
+  // Targets are the source nodes, slightly perturbed (and shifted by 360
+  // degrees), so the nearest node is the original one
+  const int ntgt = nsrc;
+  view_1d tgt_lat("tgt_lat", ntgt), tgt_lon("tgt_lon", ntgt);
+  auto tgt_lat_h = Kokkos::create_mirror_view(tgt_lat);
+  auto tgt_lon_h = Kokkos::create_mirror_view(tgt_lon);
+  std::uniform_real_distribution<Real> pert(-0.1,0.1);
+  for (int j = 0; j < nlat; ++j) {
+    for (int i = 0; i < nlon; ++i) {
+      tgt_lat_h(j*nlon+i) = src_lat_h(j) + pert(generator);
+      tgt_lon_h(j*nlon+i) = src_lon_h(i) + pert(generator) + (i%2==0 ? 360 : -360);
+    }
+  }
+  Kokkos::deep_copy(tgt_lat, tgt_lat_h);
+  Kokkos::deep_copy(tgt_lon, tgt_lon_h);
+
+  HI hi(nlat, nlon, ntgt, ekat::HorizInterpMethod::Nearest);
+  REQUIRE (hi.nnz()==1);
+  hi.setup(src_lat, src_lon, tgt_lat, tgt_lon);
+
+  view_1d y1("y1", nsrc), y2("y2", ntgt);
+  auto y1_h = Kokkos::create_mirror_view(y1);
+  std::uniform_real_distribution<Real> y_dist(-1,1);
+  for (int c = 0; c < nsrc; ++c) {
+    y1_h(c) = y_dist(generator);
+  }
+  Kokkos::deep_copy(y1, y1_h);
+  hi.apply(y1, y2);
+
+  auto y2_h = Kokkos::create_mirror_view(y2);
+  Kokkos::deep_copy(y2_h, y2);
+  for (int c = 0; c < nsrc; ++c) {
+    REQUIRE (y2_h(c)==y1_h(c));
+  }
+}
+
+} // empty namespace
@@ -8,6 +8,8 @@
 #include <random>
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
 
 #ifdef EKAT_ENABLE_FORTRAN
 extern "C" {
@@ -318,6 +320,11 @@ TEST_CASE("lin_interp_api", "lin_interp")
     vect.setup(team_member, x1c, x2);
     vect.setup(team_member, x1c, x2c);
 
+    vect.setup_monotone(team_member, x1, x2);
+    vect.setup_monotone(team_member, x1, x2c);
+    vect.setup_monotone(team_member, x1c, x2);
+    vect.setup_monotone(team_member, x1c, x2c);
+
     vect.lin_interp(team_member, x1, x2, y1, y2);
     vect.lin_interp(team_member, x1, x2c, y1, y2);
     vect.lin_interp(team_member, x1c, x2, y1, y2);
@@ -660,4 +667,710 @@ TEST_CASE("lin_interp_monotone", "lin_interp") {
   }
 }
 
+TEST_CASE("lin_interp_multi", "lin_interp") {
+  using LIV = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+  using Pack = ekat::Pack<Real,EKAT_TEST_PACK_SIZE>;
+  using packed_view_2d = typename LIV::template view_2d<Pack>;
+  using packed_view_3d = typename LIV::KT::template view_3d<Pack>;
+
+  constexpr Real tol = std::numeric_limits<Real>::epsilon()*1000;
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int> k_dist(1,100);
+  std::uniform_real_distribution<Real> x1_dist(0.0,1.0);
+  std::uniform_real_distribution<Real> x2_dist(-0.1,1.1);
+  std::uniform_real_distribution<Real> y_dist(0.0,100.0);
+
+  const int ncol = 10;
+  const int nfields = 5;
+
+  for (int r = 0; r < 20; ++r) {
+    const int km1 = k_dist(generator) + 1;
+    const int km2 = k_dist(generator);
+    const int km1_pack = ekat::npack<Pack>(km1);
+    const int km2_pack = ekat::npack<Pack>(km2);
+
+    packed_view_2d x1_d("x1", ncol, km1_pack), x2_d("x2", ncol, km2_pack);
+    packed_view_3d
+      y1_d("y1", ncol, nfields, km1_pack),
+      y2_d("y2", ncol, nfields, km2_pack),
+      y2_ref_d("y2_ref", ncol, nfields, km2_pack);
+
+    auto x1_h = Kokkos::create_mirror_view(x1_d);
+    auto x2_h = Kokkos::create_mirror_view(x2_d);
+    auto y1_h = Kokkos::create_mirror_view(y1_d);
+    for (int i = 0; i < ncol; ++i) {
+      populate_array (km1,get_col(x1_h,i).data(),generator,x1_dist,true);
+      populate_array (km2,get_col(x2_h,i).data(),generator,x2_dist,true);
+      for (int f = 0; f < nfields; ++f) {
+        auto y1_s = ekat::scalarize(ekat::subview(y1_h,i,f));
+        populate_array (km1,y1_s.data(),generator,y_dist,false);
+      }
+    }
+    Kokkos::deep_copy(x1_d, x1_h);
+    Kokkos::deep_copy(x2_d, x2_h);
+    Kokkos::deep_copy(y1_d, y1_h);
+
+    LIV vect(ncol, km1, km2);
+    Kokkos::parallel_for("lin-interp-ut-multi",
+                         vect.policy(),
+                         KOKKOS_LAMBDA(typename LIV::MemberType const& team_member) {
+      const int i = team_member.league_rank();
+      auto x1 = ekat::subview(x1_d, i);
+      auto x2 = ekat::subview(x2_d, i);
+      vect.setup(team_member, x1, x2);
+      team_member.team_barrier();
+      vect.lin_interp_multi(team_member, x1, x2,
+                            ekat::subview(y1_d, i),
+                            ekat::subview(y2_d, i));
+      for (int f = 0; f < nfields; ++f) {
+        vect.lin_interp(team_member, x1, x2,
+                        ekat::subview(y1_d, i, f),
+                        ekat::subview(y2_ref_d, i, f));
+      }
+    });
+
+    auto y2_h = Kokkos::create_mirror_view(y2_d);
+    auto y2_ref_h = Kokkos::create_mirror_view(y2_ref_d);
+    Kokkos::deep_copy(y2_h, y2_d);
+    Kokkos::deep_copy(y2_ref_h, y2_ref_d);
+
+    using Catch::Detail::Approx;
+    for (int i = 0; i < ncol; ++i) {
+      for (int f = 0; f < nfields; ++f) {
+        auto y2_s = ekat::scalarize(ekat::subview(y2_h,i,f));
+        auto y2_ref_s = ekat::scalarize(ekat::subview(y2_ref_h,i,f));
+        for (int k = 0; k < km2; ++k) {
+          REQUIRE ( y2_s(k)==Approx(y2_ref_s(k)).epsilon(tol).margin(tol) );
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("lin_interp_stored_weights", "lin_interp") {
+  using LIV = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+  using Pack = ekat::Pack<Real,EKAT_TEST_PACK_SIZE>;
+  using packed_view_2d = typename LIV::template view_2d<Pack>;
+  using packed_view_3d = typename LIV::KT::template view_3d<Pack>;
+
+  constexpr Real tol = std::numeric_limits<Real>::epsilon()*1000;
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int> k_dist(1,100);
+  std::uniform_real_distribution<Real> x1_dist(0.0,1.0);
+  std::uniform_real_distribution<Real> x2_dist(-0.1,1.1);
+  std::uniform_real_distribution<Real> y_dist(0.0,100.0);
+
+  const int ncol = 10;
+  const int nfields = 3;
+
+  for (int r = 0; r < 20; ++r) {
+    const int km1 = k_dist(generator) + 1;
+    const int km2 = k_dist(generator);
+    const int km1_pack = ekat::npack<Pack>(km1);
+    const int km2_pack = ekat::npack<Pack>(km2);
+
+    packed_view_2d x1_d("x1", ncol, km1_pack), x2_d("x2", ncol, km2_pack);
+    packed_view_3d y1_d("y1", ncol, nfields, km1_pack);
+
+    auto x1_h = Kokkos::create_mirror_view(x1_d);
+    auto x2_h = Kokkos::create_mirror_view(x2_d);
+    auto y1_h = Kokkos::create_mirror_view(y1_d);
+    for (int i = 0; i < ncol; ++i) {
+      populate_array (km1,get_col(x1_h,i).data(),generator,x1_dist,true);
+      populate_array (km2,get_col(x2_h,i).data(),generator,x2_dist,true);
+      for (int f = 0; f < nfields; ++f) {
+        auto y1_s = ekat::scalarize(ekat::subview(y1_h,i,f));
+        populate_array (km1,y1_s.data(),generator,y_dist,false);
+      }
+    }
+    Kokkos::deep_copy(x1_d, x1_h);
+    Kokkos::deep_copy(x2_d, x2_h);
+    Kokkos::deep_copy(y1_d, y1_h);
+
+    // Interpolate all fields with lin_interp_multi, and field 0 with lin_interp
+    auto run = [&] (const bool store_weights, const bool monotone) {
+      LIV vect(ncol, km1, km2, store_weights);
+      REQUIRE (vect.stores_weights()==store_weights);
+
+      packed_view_3d y2m_d("y2m", ncol, nfields, km2_pack);
+      packed_view_2d y2s_d("y2s", ncol, km2_pack);
+      Kokkos::parallel_for("lin-interp-ut-stored-weights",
+                           vect.policy(),
+                           KOKKOS_LAMBDA(typename LIV::MemberType const& team_member) {
+        const int i = team_member.league_rank();
+        auto x1 = ekat::subview(x1_d, i);
+        auto x2 = ekat::subview(x2_d, i);
+        if (monotone) {
+          vect.setup_monotone(team_member, x1, x2);
+        } else {
+          vect.setup(team_member, x1, x2);
+        }
+        team_member.team_barrier();
+        vect.lin_interp(team_member, x1, x2,
+                        ekat::subview(y1_d, i, 0),
+                        ekat::subview(y2s_d, i));
+        vect.lin_interp_multi(team_member, x1, x2,
+                              ekat::subview(y1_d, i),
+                              ekat::subview(y2m_d, i));
+      });
+      auto y2m_h = Kokkos::create_mirror_view(y2m_d);
+      auto y2s_h = Kokkos::create_mirror_view(y2s_d);
+      Kokkos::deep_copy(y2m_h, y2m_d);
+      Kokkos::deep_copy(y2s_h, y2s_d);
+      return std::make_pair(y2m_h, y2s_h);
+    };
+
+    using Catch::Detail::Approx;
+    for (bool monotone : {false, true}) {
+      auto y2_ref = run(false, monotone);
+      auto y2_sw  = run(true, monotone);
+      for (int i = 0; i < ncol; ++i) {
+        // lin_interp_multi uses the same formula for the weights in both cases
+        for (int f = 0; f < nfields; ++f) {
+          auto y2_ref_s = ekat::scalarize(ekat::subview(y2_ref.first,i,f));
+          auto y2_sw_s = ekat::scalarize(ekat::subview(y2_sw.first,i,f));
+          for (int k = 0; k < km2; ++k) {
+            REQUIRE ( y2_sw_s(k)==y2_ref_s(k) );
+          }
+        }
+        auto y2_ref_s = ekat::scalarize(ekat::subview(y2_ref.second,i));
+        auto y2_sw_s = ekat::scalarize(ekat::subview(y2_sw.second,i));
+        for (int k = 0; k < km2; ++k) {
+          REQUIRE ( y2_sw_s(k)==Approx(y2_ref_s(k)).epsilon(tol).margin(tol) );
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("lin_interp_setup_if_changed", "lin_interp") {
+  using LIV = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+  using Pack = ekat::Pack<Real,EKAT_TEST_PACK_SIZE>;
+  using packed_view_2d = typename LIV::template view_2d<Pack>;
+  using int_view_1d = typename LIV::template view_1d<int>;
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<Real> x_dist(0.0,1.0);
+  std::uniform_real_distribution<Real> y_dist(0.0,100.0);
+
+  const int ncol = 10;
+  const int km1 = 37;
+  const int km2 = 21;
+  const int km1_pack = ekat::npack<Pack>(km1);
+  const int km2_pack = ekat::npack<Pack>(km2);
+
+  packed_view_2d
+    x1_d("x1", ncol, km1_pack),
+    x2_d("x2", ncol, km2_pack),
+    y1_d("y1", ncol, km1_pack),
+    y2_d("y2", ncol, km2_pack),
+    y2_ref_d("y2_ref", ncol, km2_pack);
+  int_view_1d changed_d("changed", ncol);
+
+  auto x1_h = Kokkos::create_mirror_view(x1_d);
+  auto x2_h = Kokkos::create_mirror_view(x2_d);
+  auto y1_h = Kokkos::create_mirror_view(y1_d);
+  auto changed_h = Kokkos::create_mirror_view(changed_d);
+
+  auto new_grid = [&] (const int i) {
+    populate_array (km1,get_col(x1_h,i).data(),generator,x_dist,true);
+    populate_array (km2,get_col(x2_h,i).data(),generator,x_dist,true);
+  };
+  for (int i = 0; i < ncol; ++i) {
+    new_grid(i);
+    populate_array (km1,get_col(y1_h,i).data(),generator,y_dist,false);
+  }
+  Kokkos::deep_copy(y1_d, y1_h);
+
+  // Interpolate y1 to y2 with the index map as is, and check against a fresh setup
+  auto check = [&] (LIV& vect) {
+    Kokkos::parallel_for("lin-interp-ut-check",
+                         vect.policy(),
+                         KOKKOS_LAMBDA(typename LIV::MemberType const& team_member) {
+      const int i = team_member.league_rank();
+      auto x1 = ekat::subview(x1_d, i);
+      auto x2 = ekat::subview(x2_d, i);
+      auto y1 = ekat::subview(y1_d, i);
+      vect.lin_interp(team_member, x1, x2, y1, ekat::subview(y2_d, i));
+    });
+    LIV ref(ncol, km1, km2);
+    Kokkos::parallel_for("lin-interp-ut-check-ref",
+                         ref.policy(),
+                         KOKKOS_LAMBDA(typename LIV::MemberType const& team_member) {
+      const int i = team_member.league_rank();
+      auto x1 = ekat::subview(x1_d, i);
+      auto x2 = ekat::subview(x2_d, i);
+      ref.setup(team_member, x1, x2);
+      team_member.team_barrier();
+      ref.lin_interp(team_member, x1, x2, ekat::subview(y1_d, i), ekat::subview(y2_ref_d, i));
+    });
+    auto y2 = Kokkos::create_mirror_view(ekat::scalarize(y2_d));
+    auto y2_ref = Kokkos::create_mirror_view(ekat::scalarize(y2_ref_d));
+    Kokkos::deep_copy(y2, ekat::scalarize(y2_d));
+    Kokkos::deep_copy(y2_ref, ekat::scalarize(y2_ref_d));
+    for (int i = 0; i < ncol; ++i) {
+      for (int k = 0; k < km2; ++k) {
+        REQUIRE (y2(i,k)==y2_ref(i,k));
+      }
+    }
+  };
+
+  LIV vect(ncol, km1, km2);
+
+  SECTION ("fingerprint") {
+    auto run = [&] () {
+      Kokkos::deep_copy(x1_d, x1_h);
+      Kokkos::deep_copy(x2_d, x2_h);
+      Kokkos::parallel_for("lin-interp-ut-setup-if-changed",
+                           vect.policy(),
+                           KOKKOS_LAMBDA(typename LIV::MemberType const& team_member) {
+        const int i = team_member.league_rank();
+        const bool changed = vect.setup_if_changed(team_member,
+                                                   ekat::subview(x1_d, i),
+                                                   ekat::subview(x2_d, i));
+        Kokkos::single(Kokkos::PerTeam(team_member), [&] () {
+          changed_d(i) = changed;
+        });
+      });
+      Kokkos::deep_copy(changed_h, changed_d);
+    };
+
+    // First call always builds the map
+    run();
+    for (int i = 0; i < ncol; ++i) {
+      REQUIRE (changed_h(i)==1);
+    }
+    check(vect);
+
+    // Same grids: nothing to do
+    run();
+    for (int i = 0; i < ncol; ++i) {
+      REQUIRE (changed_h(i)==0);
+    }
+    check(vect);
+
+    // Change one entry of x1 in one column, and x2 in another
+    get_col(x1_h,2)(km1/2) = 0.5*(get_col(x1_h,2)(km1/2-1)+get_col(x1_h,2)(km1/2));
+    get_col(x2_h,7)(0) = -0.1;
+    run();
+    for (int i = 0; i < ncol; ++i) {
+      REQUIRE (changed_h(i)==(i==2 || i==7 ? 1 : 0));
+    }
+    check(vect);
+
+    // A regular setup invalidates the stored fingerprint
+    Kokkos::parallel_for("lin-interp-ut-setup",
+                         vect.policy(),
+                         KOKKOS_LAMBDA(typename LIV::MemberType const& team_member) {
+      const int i = team_member.league_rank();
+      vect.setup(team_member, ekat::subview(x1_d, i), ekat::subview(x2_d, i));
+    });
+    run();
+    for (int i = 0; i < ncol; ++i) {
+      REQUIRE (changed_h(i)==1);
+    }
+    check(vect);
+  }
+
+  SECTION ("team_size") {
+    // With several threads per team, a thread must not overwrite the stored
+    // fingerprint after another one updated it, or the next call rebuilds the map
+    using ExeSpace = typename LIV::KT::ExeSpace;
+    const int team_size = std::min(4, static_cast<int>(ExeSpace::concurrency()));
+    const auto policy = ekat::ExeSpaceUtils<ExeSpace>::get_team_policy_force_team_size(ncol, team_size);
+
+    Kokkos::deep_copy(x1_d, x1_h);
+    Kokkos::deep_copy(x2_d, x2_h);
+    for (int iter = 0; iter < 2; ++iter) {
+      Kokkos::parallel_for("lin-interp-ut-setup-if-changed-team",
+                           policy,
+                           KOKKOS_LAMBDA(typename LIV::MemberType const& team_member) {
+        const int i = team_member.league_rank();
+        const bool changed = vect.setup_if_changed(team_member,
+                                                   ekat::subview(x1_d, i),
+                                                   ekat::subview(x2_d, i));
+        Kokkos::single(Kokkos::PerTeam(team_member), [&] () {
+          changed_d(i) = changed;
+        });
+      });
+      Kokkos::deep_copy(changed_h, changed_d);
+      for (int i = 0; i < ncol; ++i) {
+        REQUIRE (changed_h(i)==(iter==0 ? 1 : 0));
+      }
+    }
+    check(vect);
+  }
+
+  SECTION ("dirty") {
+    int_view_1d dirty_d("dirty", ncol);
+    auto dirty_h = Kokkos::create_mirror_view(dirty_d);
+
+    Kokkos::deep_copy(x1_d, x1_h);
+    Kokkos::deep_copy(x2_d, x2_h);
+    Kokkos::deep_copy(dirty_d, 1);
+    vect.setup_dirty(x1_d, x2_d, dirty_d);
+    check(vect);
+
+    // Change the grids of some columns, and only setup those
+    for (int i = 0; i < ncol; ++i) {
+      dirty_h(i) = i%3==0;
+      if (dirty_h(i)) {
+        new_grid(i);
+      }
+    }
+    Kokkos::deep_copy(x1_d, x1_h);
+    Kokkos::deep_copy(x2_d, x2_h);
+    Kokkos::deep_copy(dirty_d, dirty_h);
+    vect.setup_dirty(x1_d, x2_d, dirty_d);
+    check(vect);
+  }
+}
+
+TEST_CASE("lin_interp_setup_monotone", "lin_interp") {
+  using LIV = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+  using Pack = ekat::Pack<Real,EKAT_TEST_PACK_SIZE>;
+  using packed_view_2d = typename LIV::template view_2d<Pack>;
+  using real_pdf = std::uniform_real_distribution<Real>;
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int> k_dist(1,200);
+  const int ncol = 10;
+
+  // Make x2 range slightly larger than x1, so we also test extrapolation
+  real_pdf x1_dist(0.0,1.0);
+  real_pdf x2_dist(-0.1,1.1);
+  real_pdf y_dist(0.0,100.0);
+
+  // Run the interpolation with either setup method, and return y2
+  auto run = [&](const int km1, const int km2,
+                 const packed_view_2d& x1_d, const packed_view_2d& x2_d,
+                 const packed_view_2d& y1_d, const bool monotone) {
+    LIV vect(ncol, km1, km2);
+    packed_view_2d y2_d("y2", ncol, ekat::npack<Pack>(km2));
+    Kokkos::parallel_for("lin-interp-ut-setup-monotone",
+                         vect.policy(),
+                         KOKKOS_LAMBDA(typename LIV::MemberType const& team_member) {
+      const int i = team_member.league_rank();
+      if (monotone) {
+        vect.setup_monotone(team_member,
+                            ekat::subview(x1_d, i),
+                            ekat::subview(x2_d, i));
+      } else {
+        vect.setup(team_member,
+                   ekat::subview(x1_d, i),
+                   ekat::subview(x2_d, i));
+      }
+      team_member.team_barrier();
+      vect.lin_interp(team_member,
+                      ekat::subview(x1_d, i),
+                      ekat::subview(x2_d, i),
+                      ekat::subview(y1_d, i),
+                      ekat::subview(y2_d, i));
+    });
+    auto y2_h = Kokkos::create_mirror_view(y2_d);
+    Kokkos::deep_copy(y2_h, y2_d);
+    return y2_h;
+  };
+
+  // increase iterations for a more-thorough testing
+  for (int r = 0; r < 100; ++r) {
+    // Ensure km1>1, since we need at least two points to interpolate
+    const int km1 = k_dist(generator) + 1;
+    const int km2 = k_dist(generator);
+
+    const int km1_pack = ekat::npack<Pack>(km1);
+    const int km2_pack = ekat::npack<Pack>(km2);
+    packed_view_2d
+      x1_d("x1", ncol, km1_pack),
+      x2_d("x2", ncol, km2_pack),
+      y1_d("y1", ncol, km1_pack);
+
+    auto x1_h = Kokkos::create_mirror_view(x1_d);
+    auto x2_h = Kokkos::create_mirror_view(x2_d);
+    auto y1_h = Kokkos::create_mirror_view(y1_d);
+    for (int i = 0; i < ncol; ++i) {
+      populate_array (km1,get_col(x1_h,i).data(),generator,x1_dist,true);
+      populate_array (km1,get_col(y1_h,i).data(),generator,y_dist,false);
+      populate_array (km2,get_col(x2_h,i).data(),generator,x2_dist,true);
+
+      // Add some ties between x1 and x2, to check they are handled like setup does
+      auto x1s = get_col(x1_h,i);
+      auto x2s = get_col(x2_h,i);
+      for (int k=0; k<std::min(km1,km2); k+=3) {
+        x2s(k) = x1s(k);
+      }
+      std::sort(x2s.data(), x2s.data()+km2);
+    }
+    Kokkos::deep_copy(x1_d, x1_h);
+    Kokkos::deep_copy(y1_d, y1_h);
+    Kokkos::deep_copy(x2_d, x2_h);
+
+    // The index map is the same, so results must match bfb
+    const auto y2_bs_h = run(km1,km2,x1_d,x2_d,y1_d,false);
+    const auto y2_mp_h = run(km1,km2,x1_d,x2_d,y1_d,true);
+    auto y2_bs = ekat::scalarize(y2_bs_h);
+    auto y2_mp = ekat::scalarize(y2_mp_h);
+    for (int i = 0; i < ncol; ++i) {
+      for (int j = 0; j < km2; ++j) {
+        REQUIRE ( y2_mp(i,j)==y2_bs(i,j) );
+      }
+    }
+  }
+}
+
+// Not a unit test: hidden from the default run, use "[benchmark]" to run it
+TEST_CASE("lin_interp_setup_monotone_benchmark", "[.][benchmark]") {
+  using LIV = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+  using Pack = ekat::Pack<Real,EKAT_TEST_PACK_SIZE>;
+  using packed_view_2d = typename LIV::template view_2d<Pack>;
+  using real_pdf = std::uniform_real_distribution<Real>;
+
+  std::default_random_engine generator;
+  real_pdf x1_dist(0.0,1.0);
+  real_pdf x2_dist(-0.1,1.1);
+
+  // Time the two setups on a column-remap sized problem.
+  const int nc = 512;
+  const int km1 = 128;
+  const int km2 = 128;
+  const int nrep = 10;
+
+  LIV vect(nc, km1, km2);
+  packed_view_2d
+    x1_d("x1", nc, ekat::npack<Pack>(km1)),
+    x2_d("x2", nc, ekat::npack<Pack>(km2));
+  auto x1_h = Kokkos::create_mirror_view(x1_d);
+  auto x2_h = Kokkos::create_mirror_view(x2_d);
+  for (int i = 0; i < nc; ++i) {
+    populate_array (km1,get_col(x1_h,i).data(),generator,x1_dist,true);
+    populate_array (km2,get_col(x2_h,i).data(),generator,x2_dist,true);
+  }
+  Kokkos::deep_copy(x1_d, x1_h);
+  Kokkos::deep_copy(x2_d, x2_h);
+
+  auto time_setup = [&](const bool monotone) -> double {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int n = 0; n < nrep; ++n) {
+      Kokkos::parallel_for("lin-interp-ut-setup-bench",
+                           vect.policy(),
+                           KOKKOS_LAMBDA(typename LIV::MemberType const& team_member) {
+        const int i = team_member.league_rank();
+        if (monotone) {
+          vect.setup_monotone(team_member,
+                              ekat::subview(x1_d, i),
+                              ekat::subview(x2_d, i));
+        } else {
+          vect.setup(team_member,
+                     ekat::subview(x1_d, i),
+                     ekat::subview(x2_d, i));
+        }
+      });
+    }
+    Kokkos::fence();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(t1-t0).count() / nrep;
+  };
+
+  // Warm up, then time
+  time_setup(false);
+  const double t_bs = time_setup(false);
+  const double t_mp = time_setup(true);
+  WARN ("lin_interp setup (ncol=" << nc << ", km1=" << km1 << ", km2=" << km2 << "):\n"
+        << "  binary search: " << t_bs << " s\n"
+        << "  merge path:    " << t_mp << " s");
+}
+
+TEST_CASE("lin_interp_compact", "lin_interp") {
+  using Pack = ekat::Pack<Real,EKAT_TEST_PACK_SIZE>;
+  using LIV  = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+  using LI16 = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE,ekat::DefaultDevice,std::int16_t>;
+  using LI8  = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE,ekat::DefaultDevice,std::uint8_t>;
+  using LI8F = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE,ekat::DefaultDevice,std::uint8_t,float>;
+  using packed_view_2d = typename LIV::template view_2d<Pack>;
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int> k_dist(2,256);
+  std::uniform_real_distribution<Real> x1_dist(0.0,1.0);
+  std::uniform_real_distribution<Real> x2_dist(-0.1,1.1);
+  std::uniform_real_distribution<Real> y_dist(0.0,100.0);
+
+  const int ncol = 10;
+
+  // The index type must be able to represent all the source indices
+  REQUIRE_THROWS (LI8(ncol, 257, 10));
+  REQUIRE_NOTHROW (LI8(ncol, 256, 10));
+
+  for (int r = 0; r < 20; ++r) {
+    const int km1 = k_dist(generator);
+    const int km2 = k_dist(generator);
+    const int km1_pack = ekat::npack<Pack>(km1);
+    const int km2_pack = ekat::npack<Pack>(km2);
+
+    packed_view_2d x1_d("x1", ncol, km1_pack), x2_d("x2", ncol, km2_pack), y1_d("y1", ncol, km1_pack);
+
+    auto x1_h = Kokkos::create_mirror_view(x1_d);
+    auto x2_h = Kokkos::create_mirror_view(x2_d);
+    auto y1_h = Kokkos::create_mirror_view(y1_d);
+    for (int i = 0; i < ncol; ++i) {
+      populate_array (km1,get_col(x1_h,i).data(),generator,x1_dist,true);
+      populate_array (km2,get_col(x2_h,i).data(),generator,x2_dist,true);
+      populate_array (km1,get_col(y1_h,i).data(),generator,y_dist,false);
+    }
+    Kokkos::deep_copy(x1_d, x1_h);
+    Kokkos::deep_copy(x2_d, x2_h);
+    Kokkos::deep_copy(y1_d, y1_h);
+
+    auto run = [&] (const auto& li) {
+      using LIT = typename std::remove_reference<decltype(li)>::type;
+      packed_view_2d y2_d("y2", ncol, km2_pack);
+      Kokkos::parallel_for("lin-interp-ut-compact",
+                           li.policy(),
+                           KOKKOS_LAMBDA(typename LIT::MemberType const& team_member) {
+        const int i = team_member.league_rank();
+        auto x1 = ekat::subview(x1_d, i);
+        auto x2 = ekat::subview(x2_d, i);
+        li.setup(team_member, x1, x2);
+        team_member.team_barrier();
+        li.lin_interp(team_member, x1, x2, ekat::subview(y1_d, i), ekat::subview(y2_d, i));
+      });
+      auto y2_h = Kokkos::create_mirror_view(y2_d);
+      Kokkos::deep_copy(y2_h, y2_d);
+      return y2_h;
+    };
+
+    const auto y2_ref  = run(LIV (ncol, km1, km2));
+    const auto y2_16   = run(LI16(ncol, km1, km2));
+    const auto y2_8    = run(LI8 (ncol, km1, km2));
+    const auto y2_8sw  = run(LI8 (ncol, km1, km2, true));
+    const auto y2_ref_sw = run(LIV (ncol, km1, km2, true));
+    const auto y2_8f   = run(LI8F(ncol, km1, km2, true));
+
+    // Compact indices must give bit-for-bit identical results. Compact weights
+    // are only accurate to the precision of the weight type.
+    using Catch::Detail::Approx;
+    const Real ftol = std::numeric_limits<float>::epsilon()*100;
+    for (int i = 0; i < ncol; ++i) {
+      auto ref    = get_col(y2_ref,i);
+      auto ref_sw = get_col(y2_ref_sw,i);
+      for (int k = 0; k < km2; ++k) {
+        REQUIRE ( get_col(y2_16,i)(k)==ref(k) );
+        REQUIRE ( get_col(y2_8,i)(k)==ref(k) );
+        REQUIRE ( get_col(y2_8sw,i)(k)==ref_sw(k) );
+        REQUIRE ( get_col(y2_8f,i)(k)==Approx(ref_sw(k)).epsilon(ftol).margin(ftol*100) );
+      }
+    }
+  }
+}
+
+TEST_CASE("lin_interp_extrapolation", "lin_interp") {
+  using Pack = ekat::Pack<Real,EKAT_TEST_PACK_SIZE>;
+  using Extrap = ekat::LinInterpExtrap;
+  using LIL = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+  using LIC = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE,ekat::DefaultDevice,int,Real,Extrap::Clamp>;
+  using LIF = ekat::LinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE,ekat::DefaultDevice,int,Real,Extrap::Fill>;
+  using packed_view_2d = typename LIL::template view_2d<Pack>;
+
+  constexpr Real tol = std::numeric_limits<Real>::epsilon()*1000;
+  const Real fill = -999;
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int> k_dist(2,100);
+  std::uniform_real_distribution<Real> x1_dist(0.0,1.0);
+  std::uniform_real_distribution<Real> x2_dist(-0.5,1.5);
+  std::uniform_real_distribution<Real> y_dist(0.0,100.0);
+
+  const int ncol = 10;
+
+  // Clamp and Fill are resolved in the weights, so they always store them
+  REQUIRE (not LIL(ncol, 10, 10).stores_weights());
+  REQUIRE (LIC(ncol, 10, 10).stores_weights());
+  REQUIRE (LIF(ncol, 10, 10, false, fill).stores_weights());
+  REQUIRE (LIF(ncol, 10, 10, false, fill).fill_value()==fill);
+
+  for (int r = 0; r < 20; ++r) {
+    const int km1 = k_dist(generator);
+    const int km2 = k_dist(generator);
+    const int km1_pack = ekat::npack<Pack>(km1);
+    const int km2_pack = ekat::npack<Pack>(km2);
+
+    packed_view_2d x1_d("x1", ncol, km1_pack), x2_d("x2", ncol, km2_pack), y1_d("y1", ncol, km1_pack);
+
+    // x2 is not sorted, and every 7th target is masked as invalid
+    auto x1_h = Kokkos::create_mirror_view(x1_d);
+    auto x2_h = Kokkos::create_mirror_view(x2_d);
+    auto y1_h = Kokkos::create_mirror_view(y1_d);
+    for (int i = 0; i < ncol; ++i) {
+      populate_array (km1,get_col(x1_h,i).data(),generator,x1_dist,true);
+      populate_array (km2,get_col(x2_h,i).data(),generator,x2_dist,false);
+      populate_array (km1,get_col(y1_h,i).data(),generator,y_dist,false);
+      for (int k = i%7; k < km2; k+=7) {
+        get_col(x2_h,i)(k) = ekat::ScalarTraits<Real>::invalid();
+      }
+    }
+    Kokkos::deep_copy(x1_d, x1_h);
+    Kokkos::deep_copy(x2_d, x2_h);
+    Kokkos::deep_copy(y1_d, y1_h);
+
+    auto run = [&] (const auto& li) {
+      using LIT = typename std::remove_reference<decltype(li)>::type;
+      packed_view_2d y2_d("y2", ncol, km2_pack);
+      Kokkos::parallel_for("lin-interp-ut-extrap",
+                           li.policy(),
+                           KOKKOS_LAMBDA(typename LIT::MemberType const& team_member) {
+        const int i = team_member.league_rank();
+        auto x1 = ekat::subview(x1_d, i);
+        auto x2 = ekat::subview(x2_d, i);
+        li.setup(team_member, x1, x2);
+        team_member.team_barrier();
+        li.lin_interp(team_member, x1, x2, ekat::subview(y1_d, i), ekat::subview(y2_d, i));
+      });
+      auto y2_h = Kokkos::create_mirror_view(y2_d);
+      Kokkos::deep_copy(y2_h, y2_d);
+      return y2_h;
+    };
+
+    const auto y2_lin    = run(LIL(ncol, km1, km2));
+    const auto y2_lin_sw = run(LIL(ncol, km1, km2, true));
+    const auto y2_clamp  = run(LIC(ncol, km1, km2));
+    const auto y2_fill   = run(LIF(ncol, km1, km2, false, fill));
+
+    using Catch::Detail::Approx;
+    for (int i = 0; i < ncol; ++i) {
+      auto x1 = get_col(x1_h,i);
+      auto x2 = get_col(x2_h,i);
+      auto y1 = get_col(y1_h,i);
+      for (int k = 0; k < km2; ++k) {
+        if (ekat::is_invalid(x2(k))) {
+          REQUIRE (ekat::is_invalid(get_col(y2_lin,i)(k)));
+          REQUIRE (ekat::is_invalid(get_col(y2_lin_sw,i)(k)));
+          REQUIRE (ekat::is_invalid(get_col(y2_clamp,i)(k)));
+          REQUIRE (get_col(y2_fill,i)(k)==fill);
+          continue;
+        }
+
+        // Linear extrapolation uses the first/last two points
+        const int k1 = x2(k)<x1(0) ? 0 :
+                       (x2(k)>x1(km1-1) ? km1-2 :
+                        std::min<int>(std::upper_bound(x1.data(),x1.data()+km1,x2(k))-x1.data()-1,km1-2));
+        const Real y_lin = y1(k1) + (y1(k1+1)-y1(k1))*(x2(k)-x1(k1))/(x1(k1+1)-x1(k1));
+        REQUIRE (get_col(y2_lin,i)(k)==Approx(y_lin).epsilon(tol).margin(tol));
+        REQUIRE (get_col(y2_lin_sw,i)(k)==Approx(y_lin).epsilon(tol).margin(tol));
+
+        if (x2(k)<x1(0)) {
+          REQUIRE (get_col(y2_clamp,i)(k)==y1(0));
+          REQUIRE (get_col(y2_fill,i)(k)==fill);
+        } else if (x2(k)>x1(km1-1)) {
+          REQUIRE (get_col(y2_clamp,i)(k)==y1(km1-1));
+          REQUIRE (get_col(y2_fill,i)(k)==fill);
+        } else {
+          REQUIRE (get_col(y2_clamp,i)(k)==get_col(y2_lin_sw,i)(k));
+          REQUIRE (get_col(y2_fill,i)(k)==get_col(y2_lin_sw,i)(k));
+        }
+      }
+    }
+  }
+}
+
 } // empty namespace
@@ -0,0 +1,256 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/util/ekat_vert_interp.hpp"
+#include "ekat/kokkos/ekat_subview_utils.hpp"
+
+#include "ekat_test_config.h"
+
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using Pack = ekat::Pack<Real,EKAT_TEST_PACK_SIZE>;
+using KT = ekat::KokkosTypes<ekat::DefaultDevice>;
+using packed_view_2d = KT::view_2d<Pack>;
+
+// Fill the first km entries of a column with sorted random values in [lo,hi],
+// making sure there are no duplicates
+template <typename Generator>
+void populate_sorted (Real* data, const int km, const Real lo, const Real hi, Generator& gen) {
+  std::uniform_real_distribution<Real> dist(lo,hi);
+  bool done = false;
+  while (!done) {
+    for (int k = 0; k < km; ++k) {
+      data[k] = dist(gen);
+    }
+    std::sort(data, data+km);
+    done = std::adjacent_find(data, data+km) == data+km;
+  }
+}
+
+// Setup interpolator li on x1->x2, and interpolate y1 to y2 on all columns
+template <typename Interp>
+void run_interp (const Interp& li,
+                 const packed_view_2d& x1,
+                 const packed_view_2d& x2,
+                 const packed_view_2d& y1,
+                 const packed_view_2d& y2)
+{
+  Kokkos::parallel_for("vert-interp-ut",
+                       li.policy(),
+                       KOKKOS_LAMBDA(typename Interp::MemberType const& team_member) {
+    const int i = team_member.league_rank();
+    auto x1c = ekat::subview(x1, i);
+    auto x2c = ekat::subview(x2, i);
+    li.setup(team_member, x1c, x2c);
+    team_member.team_barrier();
+    li.interp(team_member, x1c, x2c, ekat::subview(y1, i), ekat::subview(y2, i));
+  });
+}
+
+TEST_CASE("log_lin_interp", "vert_interp") {
+  using LI = ekat::LogLinInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+
+  constexpr Real tol = std::numeric_limits<Real>::epsilon()*1000;
+
+  std::default_random_engine generator;
+  const int ncol = 5;
+  const int km1 = 37;
+  const int km2 = 53;
+
+  packed_view_2d
+    x1("x1", ncol, ekat::npack<Pack>(km1)),
+    x2("x2", ncol, ekat::npack<Pack>(km2)),
+    y1("y1", ncol, ekat::npack<Pack>(km1)),
+    y2("y2", ncol, ekat::npack<Pack>(km2));
+
+  auto x1_h = Kokkos::create_mirror_view(ekat::scalarize(x1));
+  auto x2_h = Kokkos::create_mirror_view(ekat::scalarize(x2));
+  auto y1_h = Kokkos::create_mirror_view(ekat::scalarize(y1));
+  auto y2_h = Kokkos::create_mirror_view(ekat::scalarize(y2));
+
+  // Pressure-like coordinates. Targets also slightly outside the source range,
+  // to test extrapolation. Data is linear in log(p), so it must be reproduced exactly
+  for (int i = 0; i < ncol; ++i) {
+    populate_sorted(&x1_h(i,0), km1, 1000, 100000, generator);
+    populate_sorted(&x2_h(i,0), km2, 900, 101000, generator);
+    for (int k = 0; k < km1; ++k) {
+      y1_h(i,k) = 3*std::log(x1_h(i,k)) - 2;
+    }
+  }
+  Kokkos::deep_copy(ekat::scalarize(x1), x1_h);
+  Kokkos::deep_copy(ekat::scalarize(x2), x2_h);
+  Kokkos::deep_copy(ekat::scalarize(y1), y1_h);
+
+  LI li(ncol, km1, km2);
+  run_interp(li, x1, x2, y1, y2);
+  Kokkos::deep_copy(y2_h, ekat::scalarize(y2));
+
+  using Catch::Detail::Approx;
+  for (int i = 0; i < ncol; ++i) {
+    for (int k = 0; k < km2; ++k) {
+      REQUIRE (y2_h(i,k)==Approx(3*std::log(x2_h(i,k)) - 2).epsilon(tol));
+    }
+  }
+}
+
+TEST_CASE("pchip_interp", "vert_interp") {
+  using PI = ekat::PchipInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+
+  constexpr Real tol = std::numeric_limits<Real>::epsilon()*1000;
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<Real> incr_dist(0,10);
+  const int ncol = 5;
+
+  for (const int km1 : {2, 3, 17, 64}) {
+    const int km2 = 101;
+    packed_view_2d
+      x1("x1", ncol, ekat::npack<Pack>(km1)),
+      x2("x2", ncol, ekat::npack<Pack>(km2)),
+      y1("y1", ncol, ekat::npack<Pack>(km1)),
+      y2("y2", ncol, ekat::npack<Pack>(km2));
+
+    auto x1_h = Kokkos::create_mirror_view(ekat::scalarize(x1));
+    auto x2_h = Kokkos::create_mirror_view(ekat::scalarize(x2));
+    auto y1_h = Kokkos::create_mirror_view(ekat::scalarize(y1));
+    auto y2_h = Kokkos::create_mirror_view(ekat::scalarize(y2));
+
+    for (int i = 0; i < ncol; ++i) {
+      populate_sorted(&x1_h(i,0), km1, 0, 1, generator);
+      populate_sorted(&x2_h(i,0), km2, x1_h(i,0), x1_h(i,km1-1), generator);
+      // Make sure the source points are hit exactly
+      for (int k = 0; k < km1; ++k) {
+        x2_h(i,k) = x1_h(i,k);
+      }
+      std::sort(&x2_h(i,0), &x2_h(i,0)+km2);
+    }
+    Kokkos::deep_copy(ekat::scalarize(x1), x1_h);
+    Kokkos::deep_copy(ekat::scalarize(x2), x2_h);
+
+    PI pi(ncol, km1, km2);
+    using Catch::Detail::Approx;
+
+    SECTION ("linear_data") {
+      // Linear data is reproduced exactly
+      for (int i = 0; i < ncol; ++i) {
+        for (int k = 0; k < km1; ++k) {
+          y1_h(i,k) = 2*x1_h(i,k) + 1;
+        }
+      }
+      Kokkos::deep_copy(ekat::scalarize(y1), y1_h);
+      run_interp(pi, x1, x2, y1, y2);
+      Kokkos::deep_copy(y2_h, ekat::scalarize(y2));
+      for (int i = 0; i < ncol; ++i) {
+        for (int k = 0; k < km2; ++k) {
+          REQUIRE (y2_h(i,k)==Approx(2*x2_h(i,k) + 1).epsilon(tol).margin(tol));
+        }
+      }
+    }
+
+    SECTION ("monotone_data") {
+      // Monotone data gives monotone results, with no overshoot, and
+      // the source values are hit exactly at the source points
+      for (int i = 0; i < ncol; ++i) {
+        y1_h(i,0) = 0;
+        for (int k = 1; k < km1; ++k) {
+          y1_h(i,k) = y1_h(i,k-1) + incr_dist(generator)*(k%5==0 ? 0 : 1);
+        }
+      }
+      Kokkos::deep_copy(ekat::scalarize(y1), y1_h);
+      run_interp(pi, x1, x2, y1, y2);
+      Kokkos::deep_copy(y2_h, ekat::scalarize(y2));
+      for (int i = 0; i < ncol; ++i) {
+        for (int k = 1; k < km2; ++k) {
+          REQUIRE (y2_h(i,k)>=y2_h(i,k-1)-tol*y2_h(i,k));
+        }
+        REQUIRE (y2_h(i,0)==Approx(y1_h(i,0)).margin(tol));
+        REQUIRE (y2_h(i,km2-1)==Approx(y1_h(i,km1-1)).epsilon(tol));
+
+        int k2 = 0;
+        for (int k = 0; k < km1; ++k) {
+          while (x2_h(i,k2)!=x1_h(i,k)) {
+            ++k2;
+          }
+          REQUIRE (y2_h(i,k2)==Approx(y1_h(i,k)).epsilon(tol).margin(tol));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("spline_interp", "vert_interp") {
+  using SI = ekat::SplineInterp<Real,EKAT_TEST_POSSIBLY_NO_PACK_SIZE>;
+
+  std::default_random_engine generator;
+  const int ncol = 5;
+  const int km1 = 100;
+  const int km2 = 77;
+  const Real pi = std::acos(Real(-1));
+
+  packed_view_2d
+    x1("x1", ncol, ekat::npack<Pack>(km1)),
+    x2("x2", ncol, ekat::npack<Pack>(km2)),
+    y1("y1", ncol, ekat::npack<Pack>(km1)),
+    y2("y2", ncol, ekat::npack<Pack>(km2));
+
+  auto x1_h = Kokkos::create_mirror_view(ekat::scalarize(x1));
+  auto x2_h = Kokkos::create_mirror_view(ekat::scalarize(x2));
+  auto y1_h = Kokkos::create_mirror_view(ekat::scalarize(y1));
+  auto y2_h = Kokkos::create_mirror_view(ekat::scalarize(y2));
+
+  // Interpolate sin(x) on [0,pi]. Since sin''=0 at both ends, the natural
+  // spline converges with fourth order, so the error is tiny even near the ends.
+  // Use a uniform x1 with a random perturbation, so that h is never too large.
+  std::uniform_real_distribution<Real> pert(-0.25,0.25);
+  const Real h = pi/(km1-1);
+  for (int i = 0; i < ncol; ++i) {
+    for (int k = 0; k < km1; ++k) {
+      x1_h(i,k) = h*(k + (k==0 || k==km1-1 ? 0 : pert(generator)));
+      y1_h(i,k) = std::sin(x1_h(i,k));
+    }
+    populate_sorted(&x2_h(i,0), km2, 0, pi, generator);
+    x2_h(i,0) = x1_h(i,0);
+    x2_h(i,km2-1) = x1_h(i,km1-1);
+  }
+  Kokkos::deep_copy(ekat::scalarize(x1), x1_h);
+  Kokkos::deep_copy(ekat::scalarize(x2), x2_h);
+  Kokkos::deep_copy(ekat::scalarize(y1), y1_h);
+
+  SI si(ncol, km1, km2);
+  run_interp(si, x1, x2, y1, y2);
+  Kokkos::deep_copy(y2_h, ekat::scalarize(y2));
+
+  const Real tol = std::max(Real(1e-6), std::numeric_limits<Real>::epsilon()*100);
+  for (int i = 0; i < ncol; ++i) {
+    for (int k = 0; k < km2; ++k) {
+      REQUIRE (std::abs(y2_h(i,k)-std::sin(x2_h(i,k)))<tol);
+    }
+  }
+
+  // A straight line is reproduced exactly, including extrapolation
+  for (int i = 0; i < ncol; ++i) {
+    for (int k = 0; k < km1; ++k) {
+      y1_h(i,k) = 1 - 3*x1_h(i,k);
+    }
+    x2_h(i,0) = -0.5;
+    x2_h(i,km2-1) = pi + 0.5;
+  }
+  Kokkos::deep_copy(ekat::scalarize(x2), x2_h);
+  Kokkos::deep_copy(ekat::scalarize(y1), y1_h);
+  run_interp(si, x1, x2, y1, y2);
+  Kokkos::deep_copy(y2_h, ekat::scalarize(y2));
+
+  using Catch::Detail::Approx;
+  const Real ltol = std::numeric_limits<Real>::epsilon()*1000;
+  for (int i = 0; i < ncol; ++i) {
+    for (int k = 0; k < km2; ++k) {
+      REQUIRE (y2_h(i,k)==Approx(1 - 3*x2_h(i,k)).epsilon(ltol).margin(ltol));
+    }
+  }
+}
+
+} // empty namespace
@@ -0,0 +1,103 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/io/ekat_serialize.hpp"
+#include "ekat/ekat_parameter_list.hpp"
+
+#include <limits>
+
+namespace {
+
+template<typename T>
+T round_trip (const T& val) {
+  std::vector<char> buf;
+  ekat::serialize(val,buf);
+  T out;
+  std::size_t pos = 0;
+  ekat::deserialize(out,buf,pos);
+  REQUIRE (pos==buf.size());
+  return out;
+}
+
+TEST_CASE ("serialize_stl","") {
+  using namespace ekat;
+
+  REQUIRE (round_trip(-42)==-42);
+  REQUIRE (round_trip(true)==true);
+  REQUIRE (round_trip(std::numeric_limits<double>::max())==std::numeric_limits<double>::max());
+  REQUIRE (round_trip(std::string(""))=="");
+  REQUIRE (round_trip(std::string("a string"))=="a string");
+
+  const std::vector<double> dv = {1.5, -2.25, 1e300};
+  REQUIRE (round_trip(dv)==dv);
+  const std::vector<bool> bv = {true, false, true};
+  REQUIRE (round_trip(bv)==bv);
+  const std::vector<std::string> sv = {"a", "", "bc"};
+  REQUIRE (round_trip(sv)==sv);
+  const std::set<int> is = {3, 1, 2};
+  REQUIRE (round_trip(is)==is);
+  const std::map<std::string,std::vector<std::pair<int,double>>> m =
+    {{"one", {{1,1.0}}}, {"none", {}}, {"two", {{1,1.0},{2,2.0}}}};
+  REQUIRE (round_trip(m)==m);
+
+  // Several values in one buffer
+  std::vector<char> buf;
+  serialize(1,buf);
+  serialize(std::string("two"),buf);
+  serialize(3.0,buf);
+  int i;
+  std::string s;
+  double d;
+  std::size_t pos = 0;
+  deserialize(i,buf,pos);
+  deserialize(s,buf,pos);
+  deserialize(d,buf,pos);
+  REQUIRE ((i==1 && s=="two" && d==3.0));
+
+  // Reading past the end throws
+  REQUIRE_THROWS (deserialize(i,buf,pos));
+  buf.clear();
+  serialize(dv,buf);
+  buf.pop_back();
+  std::vector<double> dv2;
+  pos = 0;
+  REQUIRE_THROWS (deserialize(dv2,buf,pos));
+}
+
+TEST_CASE ("serialize_parameter_list","") {
+  using namespace ekat;
+
+  ParameterList params("params");
+  params.set("b",true);
+  params.set("i",-3);
+  params.set("d",0.1);
+  params.set<std::string>("s","hello");
+  params.set("vb",std::vector<char>{1,0});
+  params.set("vi",std::vector<int>{1,2,3});
+  params.set("vd",std::vector<double>{});
+  params.set("vs",std::vector<std::string>{"x","y"});
+  auto& sub = params.sublist("sub");
+  sub.set("i",42);
+  sub.sublist("empty");
+
+  auto out = round_trip(params);
+  REQUIRE (out.name()=="params");
+  REQUIRE (out.get<bool>("b")==true);
+  REQUIRE (out.get<int>("i")==-3);
+  REQUIRE (out.get<double>("d")==0.1);
+  REQUIRE (out.get<std::string>("s")=="hello");
+  REQUIRE (out.get<std::vector<char>>("vb")==std::vector<char>{1,0});
+  REQUIRE (out.get<std::vector<int>>("vi")==std::vector<int>{1,2,3});
+  REQUIRE (out.get<std::vector<double>>("vd").empty());
+  REQUIRE (out.get<std::vector<std::string>>("vs")==std::vector<std::string>{"x","y"});
+  REQUIRE (out.isSublist("sub"));
+  REQUIRE (out.sublist("sub").name()=="sub");
+  REQUIRE (out.sublist("sub").get<int>("i")==42);
+  REQUIRE (out.sublist("sub").isSublist("empty"));
+
+  // Only the types produced by the YAML parser are supported
+  params.set("f",1.0f);
+  std::vector<char> buf;
+  REQUIRE_THROWS (serialize(params,buf));
+}
+
+} // anonymous namespace
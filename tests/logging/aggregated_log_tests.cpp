@@ -0,0 +1,185 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/logging/ekat_logger.hpp"
+#include "ekat/mpi/ekat_comm.hpp"
+
+#include <spdlog/sinks/base_sink.h>
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A sink that records the messages
+class RecordSink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+  std::vector<std::string> messages;
+
+protected:
+  void sink_it_ (const spdlog::details::log_msg& msg) override {
+    messages.emplace_back(msg.payload.begin(),msg.payload.end());
+  }
+  void flush_ () override {}
+};
+
+// Log a few messages from all ranks, and return what root writes. Each
+// step is checked right away, since the messages of a sync are written
+// by root only at the following one.
+std::vector<std::string> log_and_collect (const ekat::Comm& comm)
+{
+  using namespace ekat::logger;
+
+  auto record = std::make_shared<RecordSink>();
+  auto sink = AggregatingSink::create(comm,comm.am_i_root() ? record : nullptr);
+  spdlog::logger log("aggregated",sink);
+
+  log.info("same everywhere");
+  log.warn(comm.rank()%2==0 ? "even" : "odd");
+  if (comm.rank()<comm.size()-1) {
+    log.info("all but last");
+  }
+  log.info("from rank {}",comm.rank());
+  log.info("same everywhere");   // Duplicates are collapsed within a sync
+
+  sink->sync();
+  const auto num_after_sync = record->messages.size();
+  EKAT_REQUIRE_MSG (num_after_sync==(comm.size()==1 ? 3 : 0),
+      "Error! Unexpected number of messages written by the first sync.\n");
+
+  log.info("second batch");
+  sink->sync(true);
+  EKAT_REQUIRE_MSG (not comm.am_i_root() || record->messages.size()==num_after_sync+(comm.size()==1 ? 1 : comm.size()+5),
+      "Error! Unexpected number of messages written by the second sync.\n");
+  sink->sync(true);   // Nothing to write
+
+  return record->messages;
+}
+
+std::vector<std::string> expected_messages (const int size)
+{
+  if (size==1) {
+    return {"same everywhere", "even", "from rank 0", "second batch"};
+  }
+
+  // Even and odd ranks are never contiguous
+  auto list = [&](const int first) {
+    std::string s = first+2<size ? "ranks " : "rank ";
+    for (int r=first; r<size; r+=2) {
+      s += (r==first ? "" : ", ") + std::to_string(r);
+    }
+    return s;
+  };
+
+  std::vector<std::string> msgs = {
+    "same everywhere (all ranks)",
+    "even (" + list(0) + ")",
+    size==2 ? "all but last (rank 0)" : "all but last (ranks 0-" + std::to_string(size-2) + ")",
+    "from rank 0 (rank 0)",
+    "odd (" + list(1) + ")"
+  };
+  for (int r=1; r<size; ++r) {
+    msgs.push_back("from rank " + std::to_string(r) + " (rank " + std::to_string(r) + ")");
+  }
+  msgs.push_back("second batch (all ranks)");
+  return msgs;
+}
+
+} // anonymous namespace
+
+TEST_CASE ("aggregating_sink", "[logging]") {
+  using namespace ekat;
+
+  Comm comm(MPI_COMM_WORLD);
+
+  SECTION ("mpi_ranks") {
+    const auto msgs = log_and_collect(comm);
+    if (comm.am_i_root()) {
+      REQUIRE (msgs==expected_messages(comm.size()));
+    }
+  }
+
+  SECTION ("ahead_of_root") {
+    // Non-root ranks can be one sync ahead of root without waiting for it,
+    // even with batches large enough for MPI to send them synchronously
+    using namespace ekat::logger;
+    auto record = std::make_shared<RecordSink>();
+    auto sink = AggregatingSink::create(comm,comm.am_i_root() ? record : nullptr);
+    spdlog::logger log("ahead",sink);
+
+    const std::string big(1 << 20,'x');
+    log.info(big + "1");
+    sink->sync();
+    log.info(big + "2");
+    if (not comm.am_i_root()) {
+      sink->sync();
+    }
+    comm.barrier();
+    if (comm.am_i_root()) {
+      sink->sync();
+    }
+    sink->sync(true);
+
+    if (comm.am_i_root()) {
+      const std::string suffix = comm.size()==1 ? "" : " (all ranks)";
+      REQUIRE (record->messages.size()==2);
+      REQUIRE (record->messages[0]==big + "1" + suffix);
+      REQUIRE (record->messages[1]==big + "2" + suffix);
+    }
+  }
+
+#ifndef EKAT_ENABLE_MPI
+  SECTION ("thread_ranks") {
+    for (int nranks : {2,3,5}) {
+      std::vector<std::string> msgs;
+      run_on_thread_ranks(nranks,[&](const Comm& tcomm) {
+        auto m = log_and_collect(tcomm);
+        if (tcomm.am_i_root()) {
+          msgs = m;
+        }
+      });
+      REQUIRE (msgs==expected_messages(nranks));
+    }
+  }
+#endif
+}
+
+TEST_CASE ("log_aggregated", "[logging]") {
+  using namespace ekat;
+  using namespace ekat::logger;
+
+  Comm comm(MPI_COMM_WORLD);
+
+  const std::string name = "log_aggregated_np" + std::to_string(comm.size());
+  {
+    Logger<LogBasicFile,LogAggregated> log(name, LogLevel::info, comm);
+    log.set_console_level(LogLevel::off);
+    log.set_no_format();
+
+    log.warn("hello");
+    log.debug("not logged");
+    log.sync();
+    log.info("from rank " + std::to_string(comm.rank()));
+  }
+
+  // Make sure root is done writing
+  comm.barrier();
+
+  if (comm.am_i_root()) {
+    std::ifstream lf(name+".log");
+    REQUIRE (lf.is_open());
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(lf,line)) {
+      lines.push_back(line);
+    }
+    const std::string suffix = comm.size()==1 ? "" : " (all ranks)";
+    REQUIRE (lines.size()==static_cast<std::size_t>(comm.size())+1);
+    REQUIRE (lines[0]==("hello" + suffix));
+    for (int r=0; r<comm.size(); ++r) {
+      const std::string rank_suffix = comm.size()==1 ? "" : " (rank " + std::to_string(r) + ")";
+      REQUIRE (lines[r+1]==("from rank " + std::to_string(r) + rank_suffix));
+    }
+  }
+}
@@ -0,0 +1,154 @@
+#include "ekat/logging/ekat_log_async.hpp"
+#include "ekat/logging/ekat_logger.hpp"
+#include "ekat/mpi/ekat_comm.hpp"
+
+#include <spdlog/sinks/base_sink.h>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// A sink that records the messages, and can hold the writing thread
+// until it is released (to fill up the queue of an AsyncSink)
+class GateSink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+  std::vector<std::string> messages;
+  std::atomic<bool> closed {false};
+  std::atomic<bool> waiting {false};
+
+protected:
+  void sink_it_ (const spdlog::details::log_msg& msg) override {
+    while (closed) {
+      waiting = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    waiting = false;
+    messages.emplace_back(msg.payload.begin(),msg.payload.end());
+  }
+  void flush_ () override {}
+};
+
+// Log msg0, and wait until the background thread holds it, so that the
+// queue is empty, and the following messages pile up in it
+void hold_first (spdlog::logger& log, GateSink& gate) {
+  gate.closed = true;
+  log.info("msg0");
+  while (not gate.waiting) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+TEST_CASE("async_log", "[logging]") {
+  using namespace ekat;
+  using namespace ekat::logger;
+
+  ekat::Comm comm;
+
+  SECTION("log_to_file") {
+    const int n = 1000;
+    {
+      Logger<LogAsync<LogBasicFile>,LogRootRank> mylog("async_log", LogLevel::debug, comm);
+      mylog.set_no_format();
+      mylog.set_console_level(LogLevel::off);
+      REQUIRE (mylog.get_logfile_name()=="async_log.log");
+
+      for (int i=0; i<n; ++i) {
+        mylog.info("line " + std::to_string(i));
+      }
+      mylog.trace("this message won't show up anywhere.");
+
+      // After a flush, all lines are in the file, in order
+      mylog.flush();
+      std::ifstream lf("async_log.log");
+      REQUIRE (lf.is_open());
+      std::string line;
+      int count = 0;
+      while (std::getline(lf,line)) {
+        REQUIRE (line==("line " + std::to_string(count)));
+        ++count;
+      }
+      REQUIRE (count==n);
+    }
+  }
+
+  SECTION("overflow") {
+    auto gate = std::make_shared<GateSink>();
+
+    SECTION("drop_new") {
+      spdlog::logger log("drop_new",AsyncSink::create(gate,2,AsyncOverflowPolicy::DropNew));
+      hold_first(log,*gate);
+      for (int i=1; i<6; ++i) {
+        log.info("msg" + std::to_string(i));
+      }
+      gate->closed = false;
+      log.flush();
+      REQUIRE (gate->messages==std::vector<std::string>{"msg0","msg1","msg2"});
+      REQUIRE (std::static_pointer_cast<AsyncSink>(log.sinks()[0])->num_dropped()==3);
+    }
+
+    SECTION("drop_oldest") {
+      spdlog::logger log("drop_oldest",AsyncSink::create(gate,2,AsyncOverflowPolicy::DropOldest));
+      hold_first(log,*gate);
+      for (int i=1; i<6; ++i) {
+        log.info("msg" + std::to_string(i));
+      }
+      gate->closed = false;
+      log.flush();
+      REQUIRE (gate->messages==std::vector<std::string>{"msg0","msg4","msg5"});
+      REQUIRE (std::static_pointer_cast<AsyncSink>(log.sinks()[0])->num_dropped()==3);
+    }
+
+    SECTION("block") {
+      spdlog::logger log("block",AsyncSink::create(gate,2,AsyncOverflowPolicy::Block));
+      hold_first(log,*gate);
+      std::atomic<bool> done {false};
+      std::thread t([&]() {
+        for (int i=1; i<6; ++i) {
+          log.info("msg" + std::to_string(i));
+        }
+        done = true;
+      });
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      REQUIRE (not done);
+      gate->closed = false;
+      t.join();
+      log.flush();
+      REQUIRE (gate->messages.size()==6);
+      REQUIRE (std::static_pointer_cast<AsyncSink>(log.sinks()[0])->num_dropped()==0);
+    }
+  }
+
+  SECTION("flush_callbacks") {
+    auto gate = std::make_shared<GateSink>();
+    {
+      spdlog::logger log("callbacks",AsyncSink::create(gate));
+      hold_first(log,*gate);
+      for (int i=1; i<100; ++i) {
+        log.info("msg" + std::to_string(i));
+      }
+
+      // A failed check that is caught does not wait for the queue (which
+      // cannot be written while the gate is closed)
+      auto fail = []() { EKAT_REQUIRE_MSG(false,"Error! Something went wrong.\n"); };
+      REQUIRE_THROWS (fail());
+      REQUIRE (gate->messages.empty());
+
+      // The flush callbacks (run on abort/terminate) write out all the queued messages
+      gate->closed = false;
+      error::run_flush_callbacks();
+      REQUIRE (gate->messages.size()==100);
+    }
+
+    // The callback of a destroyed sink is gone
+    error::run_flush_callbacks();
+  }
+}
+
+} // anonymous namespace
@@ -0,0 +1,184 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/logging/ekat_logger.hpp"
+#include "ekat/mpi/ekat_comm.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<ekat::logger::BinaryLogRecord> read_all (const std::string& file_name)
+{
+  ekat::logger::BinaryLogReader reader(file_name);
+  std::vector<ekat::logger::BinaryLogRecord> records;
+  ekat::logger::BinaryLogRecord rec;
+  while (reader.next(rec)) {
+    records.push_back(rec);
+  }
+  return records;
+}
+
+} // anonymous namespace
+
+TEST_CASE("binary_log", "[logging]") {
+  using namespace ekat;
+  using namespace ekat::logger;
+  using ekat::logger::impl::BinaryArgType;
+
+  Comm comm;
+
+  SECTION ("binary_file") {
+    int num_evals = 0;
+    auto counted = [&]() { return ++num_evals; };
+    {
+      Logger<LogBinaryFile,LogRootRank> log("binary_log", LogLevel::debug, comm, ".blog");
+      log.set_console_level(LogLevel::off);
+      REQUIRE (log.get_logfile_name()=="binary_log.blog");
+
+      for (int step=0; step<3; ++step) {
+        EKAT_LOG_BINARY(log,LogLevel::info,"step {}: {} took {:.2f} s",step,"dynamics",0.5*step);
+      }
+      EKAT_LOG_BINARY(log,LogLevel::warn,"{1} {0} {2} {3}",'c',true,-7L,42u);
+      EKAT_LOG_BINARY(log,LogLevel::trace,"filtered {}",counted());
+      log.info("formatted by spdlog: {}",1.5);
+    }
+    REQUIRE (num_evals==0);
+
+    const auto records = read_all("binary_log.blog");
+    REQUIRE (records.size()==5);
+    for (int step=0; step<3; ++step) {
+      const auto& r = records[step];
+      REQUIRE (r.rank==comm.rank());
+      REQUIRE (r.level==LogLevel::info);
+      REQUIRE (r.format=="step {}: {} took {:.2f} s");
+      REQUIRE (r.args.size()==3);
+      REQUIRE (r.args[0].type==BinaryArgType::Int);
+      REQUIRE (r.args[0].i==step);
+      REQUIRE (r.args[1].type==BinaryArgType::String);
+      REQUIRE (r.args[2].type==BinaryArgType::Double);
+      REQUIRE (r.args[2].d==0.5*step);
+      REQUIRE (r.message()==fmt::format("step {}: dynamics took {:.2f} s",step,0.5*step));
+    }
+    REQUIRE (records[0].time_ns<=records[1].time_ns);
+
+    const auto& mixed = records[3];
+    REQUIRE (mixed.level==LogLevel::warn);
+    REQUIRE (mixed.args[0].type==BinaryArgType::Char);
+    REQUIRE (mixed.args[1].type==BinaryArgType::Bool);
+    REQUIRE (mixed.args[2].type==BinaryArgType::Int);
+    REQUIRE (mixed.args[3].type==BinaryArgType::UInt);
+    REQUIRE (mixed.message()=="true c -7 42");
+    REQUIRE (mixed.to_csv().substr(mixed.to_csv().find(",warning,"))==",warning,\"true c -7 42\",c,true,-7,42");
+
+    const auto& text = records[4];
+    REQUIRE (text.format=="{}");
+    REQUIRE (text.message()=="formatted by spdlog: 1.5");
+    REQUIRE (text.to_text().find("] [0] [info] formatted by spdlog: 1.5")!=std::string::npos);
+  }
+
+  SECTION ("encoding") {
+    // Values at the ends of the varint ranges, and ranks changing mid-file
+    const auto fmt_id = logger::impl::register_binary_format("{} {} {}");
+    {
+      BinaryFileSink sink("binary_log_encoding.blog",3,BinaryLogClock::Precise);
+      REQUIRE (sink.get_clock()==BinaryLogClock::Precise);
+      sink.write(LogLevel::info,fmt_id,std::numeric_limits<long long>::min(),
+                 std::numeric_limits<unsigned long long>::max(),std::string(300,'s'));
+      sink.set_rank(5);
+      sink.write(LogLevel::debug,fmt_id,-1,0u,"");
+      sink.set_level(LogLevel::info);
+      sink.write(LogLevel::debug,fmt_id,0,0u,"filtered");
+      sink.write(LogLevel::err,fmt_id,std::numeric_limits<long long>::max(),127u,"x");
+    }
+
+    const auto records = read_all("binary_log_encoding.blog");
+    REQUIRE (records.size()==3);
+    REQUIRE (records[0].rank==3);
+    REQUIRE (records[0].args[0].i==std::numeric_limits<long long>::min());
+    REQUIRE (records[0].args[1].u==std::numeric_limits<unsigned long long>::max());
+    REQUIRE (records[0].args[2].s==std::string(300,'s'));
+    REQUIRE (records[1].rank==5);
+    REQUIRE (records[1].level==LogLevel::debug);
+    REQUIRE (records[1].message()=="-1 0 ");
+    REQUIRE (records[2].rank==5);
+    REQUIRE (records[2].args[0].i==std::numeric_limits<long long>::max());
+    REQUIRE (records[2].message()=="9223372036854775807 127 x");
+
+    // Time stamps are absolute, whatever the clock
+    const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    for (const auto& r : records) {
+      REQUIRE (std::abs(now-r.time_ns)<std::int64_t(60)*1000000000);
+    }
+    REQUIRE (records[0].time_ns<=records[1].time_ns);
+
+    // Loggers pick the clock with the file policy
+    Logger<LogBinaryFileWithClock<BinaryLogClock::Precise>,LogRootRank>
+      log("binary_log_precise", LogLevel::debug, comm, ".blog");
+    log.set_console_level(LogLevel::off);
+    auto bsink = std::dynamic_pointer_cast<BinaryFileSink>(log.get_file_sink());
+    REQUIRE (bsink->get_clock()==BinaryLogClock::Precise);
+  }
+
+  SECTION ("ordering") {
+    // Records written concurrently, in binary and text form, are stored in
+    // time order, for either clock
+    const auto fmt_id = logger::impl::register_binary_format("{} {}");
+    for (auto clock : {BinaryLogClock::Coarse, BinaryLogClock::Precise}) {
+      const int nthreads = 4;
+      const int n = 2000;
+      {
+        auto sink = std::make_shared<BinaryFileSink>("binary_log_ordering.blog",0,clock);
+        REQUIRE (sink->get_clock()==clock);
+        spdlog::logger text("binary_log_ordering",sink);
+        std::vector<std::thread> threads;
+        for (int t=0; t<nthreads; ++t) {
+          threads.emplace_back([&,t]() {
+            for (int i=0; i<n; ++i) {
+              if (i%4==0) {
+                text.info("{} {}",t,i);
+              } else {
+                sink->write(LogLevel::info,fmt_id,t,i);
+              }
+            }
+          });
+        }
+        for (auto& th : threads) {
+          th.join();
+        }
+      }
+
+      const auto records = read_all("binary_log_ordering.blog");
+      REQUIRE (records.size()==std::size_t(nthreads*n));
+      bool sorted = true;
+      for (std::size_t i=1; i<records.size(); ++i) {
+        sorted &= records[i-1].time_ns<=records[i].time_ns;
+      }
+      REQUIRE (sorted);
+    }
+  }
+
+  SECTION ("text_file") {
+    // With a text file sink, EKAT_LOG_BINARY formats the message
+    {
+      Logger<LogBasicFile,LogRootRank> log("binary_log_text", LogLevel::debug, comm);
+      log.set_console_level(LogLevel::off);
+      log.set_no_format();
+      EKAT_LOG_BINARY(log,LogLevel::info,"x={:.3f} n={}",0.25,3);
+    }
+    std::ifstream f("binary_log_text.log");
+    std::string line;
+    std::getline(f,line);
+    REQUIRE (line=="x=0.250 n=3");
+
+    // ... which is not a binary log file
+    REQUIRE_THROWS (BinaryLogReader("binary_log_text.log"));
+  }
+}
@@ -0,0 +1,135 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/logging/ekat_log_device.hpp"
+#include "ekat/logging/ekat_logger.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
+
+#include <spdlog/sinks/base_sink.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A sink that records the messages and their levels
+class RecordSink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+  std::vector<std::string> messages;
+  std::vector<spdlog::level::level_enum> levels;
+
+protected:
+  void sink_it_ (const spdlog::details::log_msg& msg) override {
+    messages.emplace_back(msg.payload.begin(),msg.payload.end());
+    levels.push_back(msg.level);
+  }
+  void flush_ () override {}
+};
+
+enum : int {
+  NegativeMass = 0,
+  Limiter      = 1,
+  Unregistered = 2
+};
+
+} // anonymous namespace
+
+TEST_CASE("device_log", "[logging]") {
+  using namespace ekat;
+  using namespace ekat::logger;
+
+  using KT = KokkosTypes<DefaultDevice>;
+  using RangePolicy = typename KT::RangePolicy;
+
+  auto sink = std::make_shared<RecordSink>();
+  spdlog::logger log("device_log",sink);
+  log.set_level(LogLevel::trace);
+
+  auto reset = [&]() {
+    sink->messages.clear();
+    sink->levels.clear();
+  };
+
+  DeviceLogBuffer<> buf("device_log",64);
+  buf.register_code(NegativeMass,"negative mass at column {} (level {}): {:.2f}");
+  buf.register_code(Limiter,"limiter active at column {}");
+  REQUIRE (buf.capacity()==64);
+  REQUIRE_THROWS (DeviceLogBuffer<>("bad",0));
+
+  SECTION ("drain") {
+    const int ncols = 10;
+    const auto dlog = buf.get_device_logger();
+    Kokkos::parallel_for(RangePolicy(0,ncols), KOKKOS_LAMBDA(const int icol) {
+      if (icol%3==0) {
+        dlog.log(LogLevel::warn,NegativeMass,icol,2*icol,-0.5*icol-0.25);
+      }
+      if (icol==7) {
+        dlog.log(LogLevel::info,Limiter,icol);
+        dlog.log(LogLevel::debug,Unregistered,icol,1.5,2);
+      }
+    });
+    REQUIRE (buf.drain(log)==6);
+
+    // Kernels may append in any order
+    auto msgs = sink->messages;
+    std::sort(msgs.begin(),msgs.end());
+    std::vector<std::string> expected = {
+      "code 2: column 7, values 1.5, 2",
+      "limiter active at column 7",
+      "negative mass at column 0 (level 0): -0.25",
+      "negative mass at column 3 (level 6): -1.75",
+      "negative mass at column 6 (level 12): -3.25",
+      "negative mass at column 9 (level 18): -4.75",
+    };
+    REQUIRE (msgs==expected);
+    REQUIRE (std::count(sink->levels.begin(),sink->levels.end(),LogLevel::warn)==4);
+    REQUIRE (std::count(sink->levels.begin(),sink->levels.end(),LogLevel::info)==1);
+    REQUIRE (std::count(sink->levels.begin(),sink->levels.end(),LogLevel::debug)==1);
+
+    // Nothing left
+    reset();
+    REQUIRE (buf.drain(log)==0);
+    REQUIRE (sink->messages.empty());
+  }
+
+  SECTION ("level") {
+    buf.set_level(LogLevel::info);
+    REQUIRE (buf.get_level()==LogLevel::info);
+    const auto dlog = buf.get_device_logger();
+    Kokkos::parallel_for(RangePolicy(0,4), KOKKOS_LAMBDA(const int icol) {
+      dlog.log(LogLevel::debug,Limiter,icol);
+      if (icol==1) {
+        dlog.log(LogLevel::err,Limiter,icol);
+      }
+    });
+    REQUIRE (buf.drain(log)==1);
+    REQUIRE (sink->messages.size()==1);
+    REQUIRE (sink->messages[0]=="limiter active at column 1");
+    REQUIRE (sink->levels[0]==LogLevel::err);
+  }
+
+  SECTION ("overflow") {
+    const auto dlog = buf.get_device_logger();
+    for (int iter=0; iter<3; ++iter) {
+      // Fill past capacity: the newest records are dropped, and reported
+      reset();
+      Kokkos::parallel_for(RangePolicy(0,100), KOKKOS_LAMBDA(const int icol) {
+        dlog.log(LogLevel::info,Limiter,icol);
+      });
+      REQUIRE (buf.drain(log)==100);
+      REQUIRE (sink->messages.size()==65);
+      REQUIRE (sink->messages.back()=="DeviceLogBuffer 'device_log': 36 records dropped (capacity: 64).");
+      REQUIRE (sink->levels.back()==LogLevel::warn);
+
+      // Positions keep growing across drains, so records wrap around the ring
+      reset();
+      Kokkos::parallel_for(RangePolicy(0,5), KOKKOS_LAMBDA(const int icol) {
+        dlog.log(LogLevel::info,NegativeMass,icol,icol,1.0);
+      });
+      REQUIRE (buf.drain(log)==5);
+      REQUIRE (sink->messages.size()==5);
+    }
+  }
+}
@@ -0,0 +1,105 @@
+// Compile out the EKAT_LOG_XYZ calls below info in this file
+#define EKAT_LOG_ACTIVE_LEVEL 2
+
+#include <catch2/catch.hpp>
+
+#include "ekat/logging/ekat_logger.hpp"
+#include "ekat/mpi/ekat_comm.hpp"
+
+#include <spdlog/sinks/base_sink.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A sink that records the messages
+class RecordSink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+  std::vector<std::string> messages;
+
+protected:
+  void sink_it_ (const spdlog::details::log_msg& msg) override {
+    messages.emplace_back(msg.payload.begin(),msg.payload.end());
+  }
+  void flush_ () override {}
+};
+
+// An argument whose evaluation is visible
+struct Counted {
+  int num_evals = 0;
+  std::string operator() () {
+    ++num_evals;
+    return "value";
+  }
+};
+
+} // anonymous namespace
+
+TEST_CASE("log_macros", "[logging]") {
+  using namespace ekat;
+  using namespace ekat::logger;
+
+  REQUIRE (EKAT_LOG_ACTIVE_LEVEL==EKAT_LOG_LEVEL_INFO);
+
+  Comm comm;
+
+  Logger<> log("log_macros", LogLevel::warn, comm);
+  log.set_console_level(LogLevel::off);
+  auto record = std::make_shared<RecordSink>();
+  log.sinks().push_back(record);
+
+  Counted arg;
+
+  SECTION ("runtime_level") {
+    // Filtered by the logger level: arguments are not evaluated
+    EKAT_LOG_INFO(log,"info: {}",arg());
+    REQUIRE (arg.num_evals==0);
+    REQUIRE (record->messages.empty());
+
+    EKAT_LOG_WARN(log,"warn: {}",arg());
+    EKAT_LOG_ERROR(log,"error: {}",arg());
+    EKAT_LOG(log,LogLevel::critical,"critical: {}",arg());
+    EKAT_LOG(log,LogLevel::info,"info: {}",arg());
+    REQUIRE (arg.num_evals==3);
+    REQUIRE (record->messages==std::vector<std::string>{"warn: value","error: value","critical: value"});
+
+    // The level can change at runtime
+    log.set_log_level(LogLevel::info);
+    EKAT_LOG_INFO(log,"info: {}",arg());
+    REQUIRE (arg.num_evals==4);
+    REQUIRE (record->messages.back()=="info: value");
+  }
+
+  SECTION ("compile_time_level") {
+    // Below EKAT_LOG_ACTIVE_LEVEL: never logged, whatever the runtime level
+    log.set_log_level(LogLevel::trace);
+    EKAT_LOG_TRACE(log,"trace: {}",arg());
+    EKAT_LOG_DEBUG(log,"debug: {}",arg());
+    REQUIRE (arg.num_evals==0);
+    REQUIRE (record->messages.empty());
+
+    // The generic macro only checks the runtime level
+    EKAT_LOG(log,LogLevel::debug,"debug: {}",arg());
+    REQUIRE (arg.num_evals==1);
+    REQUIRE (record->messages.size()==1);
+  }
+
+  SECTION ("pointers") {
+    auto ptr = std::make_shared<Logger<>>("log_macros_ptr", LogLevel::info, comm);
+    ptr->set_console_level(LogLevel::off);
+    ptr->sinks().push_back(record);
+    LoggerBase* raw = ptr.get();
+
+    EKAT_LOG_INFO(ptr,"shared: {}",arg());
+    EKAT_LOG_INFO(raw,"raw: {}",arg());
+    REQUIRE (record->messages==std::vector<std::string>{"shared: value","raw: value"});
+
+    // The logger expression is evaluated once
+    int n = 0;
+    auto get = [&]() -> LoggerBase& { ++n; return *ptr; };
+    EKAT_LOG_WARN(get(),"once");
+    REQUIRE (n==1);
+  }
+}
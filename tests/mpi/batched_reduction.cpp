@@ -0,0 +1,73 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/mpi/ekat_batched_reduction.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
+
+#include <cmath>
+
+namespace {
+
+TEST_CASE ("batched_reduction","") {
+  using namespace ekat;
+  using BR = BatchedReduction<double>;
+  using RangePolicy = typename BR::KT::RangePolicy;
+
+  Comm comm(MPI_COMM_WORLD);
+  const int rank = comm.rank();
+  const int size = comm.size();
+
+  BR br(comm);
+
+  // Interleave the ops, to check that entries are regrouped correctly
+  const int sum  = br.add("sum",MPI_SUM);
+  const int max  = br.add("max",MPI_MAX);
+  const int sum2 = br.add("sum2",MPI_SUM);
+  const int min  = br.add("min",MPI_MIN);
+  const int prod = br.add("prod",MPI_PROD);
+  const int set  = br.add("set",MPI_MAX);
+  REQUIRE_THROWS (br.add("land",MPI_LAND));
+  REQUIRE (br.num_entries()==6);
+  REQUIRE (br.name(sum2)=="sum2");
+
+  REQUIRE_THROWS (br.entry(sum));
+  br.setup();
+  REQUIRE_THROWS (br.add("late",MPI_SUM));
+  REQUIRE_THROWS (br.value(sum));
+  REQUIRE_THROWS (br.entry(br.num_entries()));
+
+  const int n = 10;
+  for (int step=0; step<2; ++step) {
+    // Local values on rank r are r*n + i, i=0,...,n-1 (plus the step)
+    const double offset = rank*n + step;
+    br.parallel_reduce("sum",RangePolicy(0,n),KOKKOS_LAMBDA(const int i, double& acc) {
+      acc += offset + i;
+    },sum);
+    br.parallel_reduce("sum2",RangePolicy(0,n),KOKKOS_LAMBDA(const int, double& acc) {
+      acc += 1;
+    },sum2);
+    br.parallel_reduce("max",RangePolicy(0,n),KOKKOS_LAMBDA(const int i, double& acc) {
+      acc = offset + i > acc ? offset + i : acc;
+    },max);
+    br.parallel_reduce("min",RangePolicy(0,n),KOKKOS_LAMBDA(const int i, double& acc) {
+      acc = offset + i < acc ? offset + i : acc;
+    },min);
+    br.parallel_reduce("prod",RangePolicy(0,1),KOKKOS_LAMBDA(const int, double& acc) {
+      acc *= 2;
+    },prod);
+    const auto e = br.entry(set);
+    Kokkos::parallel_for(RangePolicy(0,1),KOKKOS_LAMBDA(const int) {
+      e() = rank==0 ? 100*(step+1) : -1;
+    });
+    br.reduce();
+
+    const int ntot = n*size;
+    REQUIRE (br.value(sum)==ntot*(ntot-1)/2 + ntot*step);
+    REQUIRE (br.value(sum2)==ntot);
+    REQUIRE (br.value(max)==ntot-1+step);
+    REQUIRE (br.value(min)==step);
+    REQUIRE (br.value(prod)==std::pow(2.0,size));
+    REQUIRE (br.value(set)==100*(step+1));
+  }
+}
+
+} // anonymous namespace
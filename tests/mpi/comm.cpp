@@ -1,5 +1,15 @@
 #include <catch2/catch.hpp>
 #include "ekat/mpi/ekat_comm.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
+#include "ekat/ekat_pack.hpp"
+#include "ekat/ekat_parameter_list.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <random>
+#include <limits>
+#include <cmath>
 
 // Instantiate get_mpi_type for a user defined type
 // to check that the user can extend comm functionalities
@@ -115,6 +125,380 @@ void test_gather_in_place (const ekat::Comm& comm) {
   delete[] ranks;
 }
 
+template<typename T>
+void test_nonblocking (const ekat::Comm& comm) {
+  const int rank = comm.rank();
+  const int size = comm.size();
+  const T sum_gauss = T((size-1)*size/2);
+
+  // Start all the operations, then complete them in different ways
+  T val = rank, sum;
+  T sum_in_place = rank;
+  std::vector<T> ranks(size), ranks_in_place(size);
+  ranks_in_place[rank] = rank;
+  T bcast_val = comm.am_i_root() ? T(42) : T(0);
+
+  auto req_sum = comm.iall_reduce(&val,&sum,1,MPI_SUM);
+  auto req_sum_in_place = comm.iall_reduce(&sum_in_place,1,MPI_SUM);
+  auto req_gather = comm.iall_gather(&val,ranks.data(),1);
+  auto req_bcast = comm.ibroadcast(&bcast_val,1,comm.root_rank());
+
+  std::vector<ekat::Comm::Request> reqs;
+  reqs.emplace_back(comm.iall_gather(ranks_in_place.data(),1));
+  reqs.emplace_back(comm.ibarrier());
+
+  req_sum.wait();
+  REQUIRE (not req_sum.is_pending());
+  REQUIRE (sum==sum_gauss);
+
+  while (not req_sum_in_place.test()) {}
+  REQUIRE (not req_sum_in_place.is_pending());
+  REQUIRE (sum_in_place==sum_gauss);
+
+  ekat::Comm::Request::wait_all(reqs);
+  for (const auto& r : reqs) {
+    REQUIRE (not r.is_pending());
+  }
+  for (int i=0; i<size; ++i) {
+    REQUIRE (ranks_in_place[i]==T(i));
+  }
+
+  // Moving a request transfers ownership of the pending operation,
+  // and the destructor completes it
+  {
+    auto req = std::move(req_gather);
+    REQUIRE (not req_gather.is_pending());
+  }
+  for (int i=0; i<size; ++i) {
+    REQUIRE (ranks[i]==T(i));
+  }
+
+  req_bcast.wait();
+  REQUIRE (bcast_val==T(42));
+}
+
+template<typename T>
+void test_point_to_point (const ekat::Comm& comm) {
+  const int rank = comm.rank();
+  const int size = comm.size();
+  const int next = (rank+1) % size;
+  const int prev = (rank+size-1) % size;
+
+  // Nonblocking ring exchange, with two messages matched by tag
+  T to_next[2] = {T(rank), T(rank+1)};
+  T from_prev[2];
+  auto req_recv1 = comm.irecv(&from_prev[1],1,prev,1);
+  auto req_recv0 = comm.irecv(&from_prev[0],1,prev,0);
+  auto req_send0 = comm.isend(&to_next[0],1,next,0);
+  auto req_send1 = comm.isend(&to_next[1],1,next,1);
+  req_recv0.wait();
+  req_recv1.wait();
+  req_send0.wait();
+  req_send1.wait();
+  REQUIRE (from_prev[0]==T(prev));
+  REQUIRE (from_prev[1]==T(prev+1));
+
+  // Blocking ring exchange. A blocking send to self may never return,
+  // so this needs at least two ranks.
+  if (size>1) {
+    T val;
+    if (rank%2==0) {
+      comm.send(&to_next[0],1,next);
+      comm.recv(&val,1,prev);
+    } else {
+      comm.recv(&val,1,prev);
+      comm.send(&to_next[0],1,next);
+    }
+    REQUIRE (val==T(prev));
+  }
+}
+
+template<typename T>
+void test_views (const ekat::Comm& comm) {
+  using KT = ekat::KokkosTypes<ekat::DefaultDevice>;
+  using Pack = ekat::Pack<T,4>;
+
+  const int rank = comm.rank();
+  const int size = comm.size();
+  const T sum_gauss = T((size-1)*size/2);
+  const int n = 5;
+
+  // Scalar device view, in place and not
+  KT::view_1d<T> v("v",n), sum("sum",n);
+  Kokkos::deep_copy(v,T(rank));
+  comm.all_reduce(v,sum,MPI_SUM);
+  comm.all_reduce(v,MPI_MAX);
+  auto v_h = Kokkos::create_mirror_view(v);
+  auto sum_h = Kokkos::create_mirror_view(sum);
+  Kokkos::deep_copy(v_h,v);
+  Kokkos::deep_copy(sum_h,sum);
+  for (int i=0; i<n; ++i) {
+    REQUIRE (v_h(i)==T(size-1));
+    REQUIRE (sum_h(i)==sum_gauss);
+  }
+
+  // Packs are reduced entry by entry
+  KT::view_2d<Pack> p("p",2,3);
+  auto p_h = Kokkos::create_mirror_view(p);
+  for (int i=0; i<2; ++i) {
+    for (int j=0; j<3; ++j) {
+      for (int s=0; s<Pack::n; ++s) {
+        p_h(i,j)[s] = rank*(i+j+s);
+      }
+    }
+  }
+  Kokkos::deep_copy(p,p_h);
+  comm.all_reduce(p,MPI_SUM);
+  Kokkos::deep_copy(p_h,p);
+  for (int i=0; i<2; ++i) {
+    for (int j=0; j<3; ++j) {
+      for (int s=0; s<Pack::n; ++s) {
+        REQUIRE (p_h(i,j)[s]==sum_gauss*(i+j+s));
+      }
+    }
+  }
+
+  // Non-contiguous views, and an inclusive scan
+  KT::view_2d<T> m("m",n,3);
+  auto col = Kokkos::subview(m,Kokkos::ALL,1);
+  Kokkos::deep_copy(m,T(-1));
+  Kokkos::deep_copy(col,T(rank+1));
+  comm.scan(col,MPI_SUM);
+  comm.broadcast(Kokkos::subview(m,Kokkos::ALL,0),size-1);
+  auto m_h = Kokkos::create_mirror_view(m);
+  Kokkos::deep_copy(m_h,m);
+  for (int i=0; i<n; ++i) {
+    REQUIRE (m_h(i,0)==T(-1));
+    REQUIRE (m_h(i,1)==T((rank+1)*(rank+2)/2));
+    REQUIRE (m_h(i,2)==T(-1));
+  }
+
+  // Gather a rank-1 view into a rank-2 one
+  KT::view_2d<T> all("all",size,n);
+  Kokkos::deep_copy(v,T(rank));
+  comm.all_gather(v,all);
+  auto all_h = Kokkos::create_mirror_view(all);
+  Kokkos::deep_copy(all_h,all);
+  for (int r=0; r<size; ++r) {
+    for (int i=0; i<n; ++i) {
+      REQUIRE (all_h(r,i)==T(r));
+    }
+  }
+  REQUIRE_THROWS (comm.all_gather(v,KT::view_1d<T>("wrong",n*size+1)));
+  REQUIRE_THROWS (comm.all_reduce(v,KT::view_1d<T>("wrong",n+1),MPI_SUM));
+}
+
+template<typename T>
+void test_variable_count (const ekat::Comm& comm) {
+  using KT = ekat::KokkosTypes<ekat::DefaultDevice>;
+
+  const int rank = comm.rank();
+  const int size = comm.size();
+  const int root = size-1;
+
+  // Rank r contributes r+1 values
+  std::vector<T> mine(rank+1);
+  for (int i=0; i<=rank; ++i) {
+    mine[i] = 100*rank+i;
+  }
+  auto check_all = [&](const std::vector<T>& all, const std::vector<int>& counts) {
+    REQUIRE (static_cast<int>(counts.size())==size);
+    REQUIRE (static_cast<int>(all.size())==size*(size+1)/2);
+    int n = 0;
+    for (int r=0; r<size; ++r) {
+      REQUIRE (counts[r]==r+1);
+      for (int i=0; i<=r; ++i, ++n) {
+        REQUIRE (all[n]==T(100*r+i));
+      }
+    }
+  };
+
+  std::vector<int> counts;
+  auto gathered = comm.gatherv(mine,root,&counts);
+  if (rank==root) {
+    check_all(gathered,counts);
+  } else {
+    REQUIRE (gathered.empty());
+  }
+  check_all(comm.all_gatherv(mine,&counts),counts);
+
+  // Root sends r values to rank r (so rank 0 gets nothing)
+  std::vector<int> scounts(size);
+  std::vector<T> to_scatter;
+  for (int r=0; r<size; ++r) {
+    scounts[r] = r;
+    for (int i=0; i<r; ++i) {
+      to_scatter.push_back(100*r+i);
+    }
+  }
+  auto scattered = comm.scatterv(to_scatter,scounts,0);
+  REQUIRE (static_cast<int>(scattered.size())==rank);
+  for (int i=0; i<rank; ++i) {
+    REQUIRE (scattered[i]==T(100*rank+i));
+  }
+
+  // Rank r sends (r+d)%3 values to rank d
+  std::vector<int> send_counts(size), recv_counts;
+  std::vector<T> to_send;
+  for (int d=0; d<size; ++d) {
+    send_counts[d] = (rank+d)%3;
+    for (int i=0; i<send_counts[d]; ++i) {
+      to_send.push_back(100*rank+d);
+    }
+  }
+  auto received = comm.all_to_allv(to_send,send_counts,&recv_counts);
+  int n = 0;
+  for (int s=0; s<size; ++s) {
+    REQUIRE (recv_counts[s]==(s+rank)%3);
+    for (int i=0; i<recv_counts[s]; ++i, ++n) {
+      REQUIRE (received[n]==T(100*s+rank));
+    }
+  }
+  REQUIRE (n==static_cast<int>(received.size()));
+
+  // Views: rank r owns r+1 rows of 3 entries
+  KT::view_2d<T> rows("rows",rank+1,3);
+  auto rows_h = Kokkos::create_mirror_view(rows);
+  for (int i=0; i<=rank; ++i) {
+    for (int j=0; j<3; ++j) {
+      rows_h(i,j) = 100*rank+10*i+j;
+    }
+  }
+  Kokkos::deep_copy(rows,rows_h);
+  auto all_rows = comm.all_gatherv(rows,&counts);
+  REQUIRE (all_rows.extent_int(0)==size*(size+1)/2);
+  REQUIRE (all_rows.extent_int(1)==3);
+  auto all_rows_h = Kokkos::create_mirror_view(all_rows);
+  Kokkos::deep_copy(all_rows_h,all_rows);
+  n = 0;
+  for (int r=0; r<size; ++r) {
+    REQUIRE (counts[r]==r+1);
+    for (int i=0; i<=r; ++i, ++n) {
+      for (int j=0; j<3; ++j) {
+        REQUIRE (all_rows_h(n,j)==T(100*r+10*i+j));
+      }
+    }
+  }
+
+  // A non-contiguous view: send column 1 of my rows back to their owners
+  auto col = Kokkos::subview(all_rows,Kokkos::ALL,1);
+  auto mine_again = comm.all_to_allv(col,counts,&recv_counts);
+  REQUIRE (mine_again.extent_int(0)==size*(rank+1));
+  auto mine_again_h = Kokkos::create_mirror_view(mine_again);
+  Kokkos::deep_copy(mine_again_h,mine_again);
+  for (int s=0; s<size; ++s) {
+    REQUIRE (recv_counts[s]==rank+1);
+    for (int i=0; i<=rank; ++i) {
+      REQUIRE (mine_again_h(s*(rank+1)+i)==T(100*rank+10*i+1));
+    }
+  }
+}
+
+void test_broadcast_serialized (const ekat::Comm& comm) {
+  const int rank = comm.rank();
+  const int size = comm.size();
+
+  for (int root=0; root<size; ++root) {
+    std::string str;
+    std::map<std::string,std::vector<int>> map;
+    ekat::ParameterList params;
+    if (rank==root) {
+      str = "from root " + std::to_string(root);
+      map["root"] = std::vector<int>(root+1,root);
+      map["empty"];
+      params.rename("params");
+      params.set("root",root);
+      params.sublist("sub").set("names",std::vector<std::string>{"a","b"});
+    }
+    comm.broadcast(str,root);
+    comm.broadcast(map,root);
+    comm.broadcast(params,root);
+
+    REQUIRE (str==("from root " + std::to_string(root)));
+    REQUIRE (map.size()==2);
+    REQUIRE (map["root"]==std::vector<int>(root+1,root));
+    REQUIRE (map["empty"].empty());
+    REQUIRE (params.name()=="params");
+    REQUIRE (params.get<int>("root")==root);
+    REQUIRE (params.sublist("sub").get<std::vector<std::string>>("names").size()==2);
+  }
+}
+
+void test_reproducible_sum (const ekat::Comm& comm) {
+  const int rank = comm.rank();
+  const int size = comm.size();
+
+  // Three sums: values spanning many orders of magnitude, with cancellations;
+  // all zeros; a non-finite value.
+  const int n = 1000;
+  const int nsums = 3;
+  std::vector<double> all(nsums*n,0);
+  std::mt19937_64 gen(1234);
+  std::uniform_real_distribution<double> mantissa(-1,1);
+  std::uniform_int_distribution<int> exponent(-40,40);
+  for (int i=0; i<n; ++i) {
+    all[i] = std::ldexp(mantissa(gen),exponent(gen));
+  }
+  all[2*n+n/2] = std::numeric_limits<double>::infinity();
+
+  // The reference result, computed on a single rank
+  double ref[nsums];
+  ekat::Comm(MPI_COMM_SELF).reproducible_sum(all.data(),ref,n,nsums);
+
+  long double exact = 0;
+  for (int i=0; i<n; ++i) {
+    exact += all[i];
+  }
+  REQUIRE (std::abs(ref[0]-exact) <= 1e-15*std::abs(exact));
+  REQUIRE (ref[1]==0);
+  REQUIRE (ref[2]==std::numeric_limits<double>::infinity());
+
+  // Negating the summands negates the sum, bit for bit
+  std::vector<double> neg(all.begin(),all.begin()+n);
+  for (auto& x : neg) {
+    x = -x;
+  }
+  double neg_ref;
+  ekat::Comm(MPI_COMM_SELF).reproducible_sum(neg.data(),&neg_ref,n);
+  REQUIRE (neg_ref==-ref[0]);
+
+  // Small sums with exact results: negative totals, and heavy cancellation
+  auto sum_cyclic = [&] (const std::vector<double>& vals) {
+    std::vector<double> mine;
+    for (int i=rank; i<static_cast<int>(vals.size()); i+=size) {
+      mine.push_back(vals[i]);
+    }
+    double sum;
+    comm.reproducible_sum(mine.data(),&sum,mine.size());
+    return sum;
+  };
+  REQUIRE (sum_cyclic({1.0, -1.0, -0x1p-80})==-0x1p-80);
+  REQUIRE (sum_cyclic({-3.0, 0.5, -0x1p-40})==-(2.5+0x1p-40));
+  REQUIRE (sum_cyclic({1e20, 1.5, -1e20, 0x1p-30})==1.5+0x1p-30);
+  REQUIRE (sum_cyclic({-1e20, -1.5, 1e20, -0x1p-30})==-(1.5+0x1p-30));
+  REQUIRE (sum_cyclic({0x1p-100, -1.0, 1.0, -0x1p-100})==0);
+
+  // Distribute the summands in blocks, or cyclically in reverse order.
+  // Both distributions give the same bits as the reference.
+  for (const bool cyclic : {false, true}) {
+    std::vector<double> mine;
+    for (int j=0; j<nsums; ++j) {
+      for (int i=0; i<n; ++i) {
+        const int idx = cyclic ? n-1-i : i;
+        const int owner = cyclic ? idx % size : (idx*size)/n;
+        if (owner==rank) {
+          mine.push_back(all[j*n+idx]);
+        }
+      }
+    }
+    double sums[nsums];
+    comm.reproducible_sum(mine.data(),sums,mine.size()/nsums,nsums);
+    for (int j=0; j<nsums; ++j) {
+      REQUIRE (sums[j]==ref[j]);
+    }
+  }
+}
+
 TEST_CASE ("ekat_comm","") {
   using namespace ekat;
 
@@ -139,6 +523,10 @@ TEST_CASE ("ekat_comm","") {
     test_broadcast<double>(comm);
   }
 
+  SECTION ("broadcast_serialized") {
+    test_broadcast_serialized(comm);
+  }
+
   SECTION ("scan") {
     test_scan<int>(comm);
     test_scan<float>(comm);
@@ -203,6 +591,34 @@ TEST_CASE ("ekat_comm","") {
     test_gather_in_place<TwoInts>(comm);
   }
 
+  SECTION ("nonblocking") {
+    test_nonblocking<int>(comm);
+    test_nonblocking<float>(comm);
+    test_nonblocking<double>(comm);
+  }
+
+  SECTION ("point_to_point") {
+    test_point_to_point<int>(comm);
+    test_point_to_point<float>(comm);
+    test_point_to_point<double>(comm);
+  }
+
+  SECTION ("views") {
+    test_views<int>(comm);
+    test_views<float>(comm);
+    test_views<double>(comm);
+  }
+
+  SECTION ("variable_count") {
+    test_variable_count<int>(comm);
+    test_variable_count<float>(comm);
+    test_variable_count<double>(comm);
+  }
+
+  SECTION ("reproducible_sum") {
+    test_reproducible_sum(comm);
+  }
+
   SECTION ("split") {
     auto new_comm = comm.split(rank % 2);
     
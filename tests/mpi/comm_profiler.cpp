@@ -0,0 +1,109 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/mpi/ekat_comm.hpp"
+#include "ekat/mpi/ekat_comm_profiler.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+const ekat::CommProfileEntry*
+find_entry (const std::vector<ekat::CommProfileEntry>& entries,
+            const std::string& region, const std::string& op)
+{
+  auto it = std::find_if(entries.begin(),entries.end(),[&](const ekat::CommProfileEntry& e) {
+    return e.region==region && e.op==op;
+  });
+  return it==entries.end() ? nullptr : &*it;
+}
+
+TEST_CASE ("comm_profiler","") {
+  using namespace ekat;
+
+  Comm comm(MPI_COMM_WORLD);
+  comm.barrier();
+  reset_comm_profile();
+
+  const int n = 10;
+  std::vector<double> vals(n,comm.rank()), sums(n);
+
+  comm.all_reduce(vals.data(),sums.data(),n,MPI_SUM);
+  {
+    EKAT_COMM_PROFILING_REGION("outer");
+    comm.broadcast(vals.data(),n,comm.root_rank());
+    {
+      EKAT_COMM_PROFILING_REGION("inner");
+      comm.broadcast(vals.data(),n,comm.root_rank());
+      comm.reproducible_sum(vals.data(),sums.data(),n);
+    }
+    comm.broadcast(vals.data(),2,comm.root_rank());
+  }
+
+  const auto entries = get_comm_profile();
+  if (not comm_profiling_enabled()) {
+    // Nothing is recorded
+    REQUIRE (entries.empty());
+    return;
+  }
+
+  REQUIRE (entries.size()==4);
+
+  auto e = find_entry(entries,"","all_reduce");
+  REQUIRE (e!=nullptr);
+  REQUIRE (e->calls==1);
+  REQUIRE (e->bytes==n*sizeof(double));
+  REQUIRE (e->time>=0);
+
+  e = find_entry(entries,"outer","broadcast");
+  REQUIRE (e!=nullptr);
+  REQUIRE (e->calls==2);
+  REQUIRE (e->bytes==(n+2)*sizeof(double));
+
+  e = find_entry(entries,"outer/inner","broadcast");
+  REQUIRE (e!=nullptr);
+  REQUIRE (e->calls==1);
+
+  // The reductions issued by reproducible_sum are not recorded separately
+  e = find_entry(entries,"outer/inner","reproducible_sum");
+  REQUIRE (e!=nullptr);
+  REQUIRE (e->calls==1);
+  REQUIRE (find_entry(entries,"outer/inner","all_reduce")==nullptr);
+
+  // With a barrier before collectives, the imbalance is recorded (and the
+  // barrier itself is not)
+  reset_comm_profile();
+  set_comm_profiling_barrier(true);
+  if (comm.am_i_root()) {
+    // Make root late
+    double x = 0;
+    for (int i=0; i<1000000; ++i) {
+      x += 1e-9*i;
+    }
+    vals[0] = x;
+  }
+  comm.all_reduce(vals.data(),sums.data(),n,MPI_SUM);
+  set_comm_profiling_barrier(false);
+  const auto imb_entries = get_comm_profile();
+  REQUIRE (imb_entries.size()==1);
+  REQUIRE (imb_entries[0].op=="all_reduce");
+  REQUIRE (imb_entries[0].imbalance>=0);
+
+  // Only root prints, and the report contains all ops
+  std::ostringstream out;
+  print_comm_profile(comm,out);
+  if (comm.am_i_root()) {
+    REQUIRE (out.str().find("ekat::Comm profile")!=std::string::npos);
+    REQUIRE (out.str().find("all_reduce")!=std::string::npos);
+  } else {
+    REQUIRE (out.str().empty());
+  }
+
+  // Printing does not record anything
+  REQUIRE (get_comm_profile().size()==1);
+  reset_comm_profile();
+  REQUIRE (get_comm_profile().empty());
+}
+
+} // anonymous namespace
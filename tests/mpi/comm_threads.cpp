@@ -0,0 +1,391 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/mpi/ekat_comm.hpp"
+#include "ekat/mpi/ekat_hierarchical_comm.hpp"
+#include "ekat/mpi/ekat_node_shared_array.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
+
+#include <cmath>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Catch is not thread safe, so the ranks check results with EKAT_REQUIRE_MSG,
+// and failures are rethrown on the main thread by run_on_thread_ranks.
+#define CHECK_RANK(cond) \
+  EKAT_REQUIRE_MSG (cond, "Check failed on rank " + std::to_string(comm.rank()) + "\n")
+
+void test_collectives (const ekat::Comm& comm)
+{
+  const int rank = comm.rank();
+  const int size = comm.size();
+  const int n = 3;
+
+  CHECK_RANK (ekat::Comm(MPI_COMM_WORLD).size()==size);
+  CHECK_RANK (ekat::Comm(MPI_COMM_WORLD).rank()==rank);
+  CHECK_RANK (ekat::Comm().size()==1);
+
+  for (int root=0; root<size; ++root) {
+    std::vector<int> vals(n,-1);
+    if (rank==root) {
+      std::iota(vals.begin(),vals.end(),root);
+    }
+    comm.broadcast(vals.data(),n,root);
+    for (int i=0; i<n; ++i) {
+      CHECK_RANK (vals[i]==root+i);
+    }
+  }
+
+  std::vector<int> mine(n), result(n);
+  for (int i=0; i<n; ++i) {
+    mine[i] = (rank+1)*(i+1);
+  }
+  comm.all_reduce(mine.data(),result.data(),n,MPI_SUM);
+  for (int i=0; i<n; ++i) {
+    CHECK_RANK (result[i]==(i+1)*size*(size+1)/2);
+  }
+  comm.scan(mine.data(),result.data(),n,MPI_SUM);
+  for (int i=0; i<n; ++i) {
+    CHECK_RANK (result[i]==(i+1)*(rank+1)*(rank+2)/2);
+  }
+  int bits = 1 << rank;
+  comm.all_reduce(&bits,1,MPI_BOR);
+  CHECK_RANK (bits==(1<<size)-1);
+  double x = rank;
+  comm.all_reduce(&x,1,MPI_MAX);
+  CHECK_RANK (x==size-1);
+  auto req = comm.iall_reduce(mine.data(),n,MPI_MIN);
+  req.wait();
+  CHECK_RANK (mine[n-1]==n);
+
+  std::vector<int> all(size);
+  comm.all_gather(&rank,all.data(),1);
+  all.assign(size,-1);
+  all[rank] = 10*rank;
+  comm.all_gather(all.data(),1);
+  for (int r=0; r<size; ++r) {
+    CHECK_RANK (all[r]==10*r);
+  }
+
+  // Split in even/odd ranks
+  auto sub = comm.split(rank%2);
+  CHECK_RANK (sub.size()==(size+1-rank%2)/2);
+  CHECK_RANK (sub.rank()==rank/2);
+  int sum = rank;
+  sub.all_reduce(&sum,1,MPI_SUM);
+  int expected = 0;
+  for (int r=rank%2; r<size; r+=2) {
+    expected += r;
+  }
+  CHECK_RANK (sum==expected);
+  comm.barrier();
+}
+
+void test_point_to_point (const ekat::Comm& comm)
+{
+  const int rank = comm.rank();
+  const int size = comm.size();
+  if (size==1) {
+    return;
+  }
+
+  // Receives are posted before the matching sends
+  const int left  = (rank+size-1) % size;
+  const int right = (rank+1) % size;
+  int from_left[2] = {-1,-1};
+  auto req0 = comm.irecv(&from_left[0],1,left);
+  auto req1 = comm.irecv(&from_left[1],1,left);
+  CHECK_RANK (req1.is_pending());
+  for (int i=0; i<2; ++i) {
+    const int val = 100*rank+i;
+    comm.send(&val,1,right);
+  }
+  req1.wait();
+  req0.wait();
+  CHECK_RANK (from_left[0]==100*left && from_left[1]==100*left+1);
+
+  // Tags are matched independently
+  const double a = rank, b = -rank;
+  auto sa = comm.isend(&a,1,right,1);
+  auto sb = comm.isend(&b,1,right,2);
+  double ra, rb;
+  comm.recv(&rb,1,left,2);
+  comm.recv(&ra,1,left,1);
+  CHECK_RANK (ra==left && rb==-left);
+}
+
+void test_nonblocking (const ekat::Comm& comm)
+{
+  const int rank = comm.rank();
+  const int size = comm.size();
+  const int n = 3;
+
+  // Nonblocking collectives must not wait for the other ranks. Here, rank 1
+  // only posts the barrier after receiving what rank 0 sends after posting it.
+  int val = -1;
+  if (rank==0) {
+    auto req = comm.ibarrier();
+    CHECK_RANK (req.is_pending()==(size>1));
+    if (size>1) {
+      val = 42;
+      comm.send(&val,1,1);
+    }
+    req.wait();
+  } else {
+    if (rank==1) {
+      comm.recv(&val,1,0);
+      CHECK_RANK (val==42);
+    }
+    comm.ibarrier().wait();
+  }
+
+  // Several collectives can be pending at once, and are completed in any order
+  const int root = size-1;
+  std::vector<int> bcast(n,-1), mine(n), sum(n), inout(n), all(size*n,-1);
+  if (rank==root) {
+    std::iota(bcast.begin(),bcast.end(),root);
+  }
+  for (int i=0; i<n; ++i) {
+    mine[i] = inout[i] = (rank+1)*(i+1);
+    all[rank*n+i] = 10*rank+i;
+  }
+  std::vector<ekat::Comm::Request> reqs;
+  reqs.push_back(comm.ibroadcast(bcast.data(),n,root));
+  reqs.push_back(comm.iall_reduce(mine.data(),sum.data(),n,MPI_SUM));
+  reqs.push_back(comm.iall_reduce(inout.data(),n,MPI_MAX));
+  reqs.push_back(comm.iall_gather(all.data(),n));
+  if (rank==0 && size>1) {
+    // The contributions of rank 0 are taken at completion, not when posted
+    comm.send(&val,1,1);
+  } else if (rank==1) {
+    comm.recv(&val,1,0);
+  }
+  for (int i=reqs.size()-1; i>=0; --i) {
+    reqs[i].wait();
+  }
+  for (int i=0; i<n; ++i) {
+    CHECK_RANK (bcast[i]==root+i);
+    CHECK_RANK (sum[i]==(i+1)*size*(size+1)/2);
+    CHECK_RANK (inout[i]==(i+1)*size);
+  }
+  for (int r=0; r<size; ++r) {
+    for (int i=0; i<n; ++i) {
+      CHECK_RANK (all[r*n+i]==10*r+i);
+    }
+  }
+
+  // Polling completes the requests too
+  auto req = comm.iall_gather(&rank,all.data(),1);
+  while (not req.test()) {}
+  CHECK_RANK (not req.is_pending());
+  for (int r=0; r<size; ++r) {
+    CHECK_RANK (all[r]==r);
+  }
+}
+
+void test_variable_count (const ekat::Comm& comm)
+{
+  const int rank = comm.rank();
+  const int size = comm.size();
+
+  // Rank r contributes r+1 copies of r
+  std::vector<int> mine(rank+1,rank);
+  std::vector<int> counts;
+  auto all = comm.all_gatherv(mine,&counts);
+  CHECK_RANK (static_cast<int>(all.size())==size*(size+1)/2);
+  auto gathered = comm.gatherv(mine,size-1);
+  CHECK_RANK (gathered.size()==(rank==size-1 ? all.size() : 0));
+  auto back = comm.scatterv(all,counts,0);
+  CHECK_RANK (back==mine);
+
+  // Rank r sends s+1 copies of r to rank s
+  std::vector<int> send_counts(size), send;
+  for (int s=0; s<size; ++s) {
+    send_counts[s] = s+1;
+    send.insert(send.end(),s+1,rank);
+  }
+  std::vector<int> recv_counts;
+  auto recv = comm.all_to_allv(send,send_counts,&recv_counts);
+  CHECK_RANK (static_cast<int>(recv.size())==size*(rank+1));
+  for (int r=0; r<size; ++r) {
+    CHECK_RANK (recv_counts[r]==rank+1 && recv[r*(rank+1)]==r);
+  }
+}
+
+void test_views (const ekat::Comm& comm)
+{
+  using KT = ekat::KokkosTypes<ekat::DefaultDevice>;
+
+  const int rank = comm.rank();
+  const int size = comm.size();
+  const int n = 100;
+
+  // Kokkos calls made here must not run concurrently on several ranks
+  auto guarded = [](const auto& f) {
+    std::lock_guard<std::mutex> lock(ekat::impl::thread_kokkos_mutex());
+    f();
+  };
+
+  // Columns of a 2d view are not contiguous, so they are staged by Comm
+  KT::view_2d<double> m;
+  KT::view_2d<double>::HostMirror m_h;
+  guarded([&]() {
+    m = KT::view_2d<double>("m",n,3);
+    m_h = Kokkos::create_mirror_view(m);
+    Kokkos::deep_copy(Kokkos::subview(m,Kokkos::ALL,0),double(rank));
+    Kokkos::deep_copy(Kokkos::subview(m,Kokkos::ALL,1),double(rank+1));
+  });
+  for (int iter=0; iter<10; ++iter) {
+    comm.broadcast(Kokkos::subview(m,Kokkos::ALL,2),iter%size);
+    comm.all_reduce(Kokkos::subview(m,Kokkos::ALL,0),Kokkos::subview(m,Kokkos::ALL,2),MPI_SUM);
+    comm.scan(Kokkos::subview(m,Kokkos::ALL,1),MPI_MAX);
+  }
+  guarded([&]() { Kokkos::deep_copy(m_h,m); });
+  for (int i=0; i<n; ++i) {
+    CHECK_RANK (m_h(i,0)==rank);
+    CHECK_RANK (m_h(i,1)==rank+1);
+    CHECK_RANK (m_h(i,2)==size*(size-1)/2);
+  }
+
+  // The outputs of the variable-count front ends are allocated by Comm
+  KT::view_1d<int> mine;
+  guarded([&]() {
+    mine = KT::view_1d<int>("mine",rank+1);
+    Kokkos::deep_copy(mine,rank);
+  });
+  std::vector<int> counts;
+  auto all = comm.all_gatherv(mine,&counts);
+  auto back = comm.scatterv(all,counts,0);
+  CHECK_RANK (static_cast<int>(all.extent(0))==size*(size+1)/2);
+  CHECK_RANK (static_cast<int>(back.extent(0))==rank+1);
+  guarded([&]() {
+    auto all_h = Kokkos::create_mirror_view(all);
+    auto back_h = Kokkos::create_mirror_view(back);
+    Kokkos::deep_copy(all_h,all);
+    Kokkos::deep_copy(back_h,back);
+    for (int r=0, i=0; r<size; ++r) {
+      for (int j=0; j<=r; ++j, ++i) {
+        CHECK_RANK (all_h(i)==r);
+      }
+    }
+    for (int j=0; j<=rank; ++j) {
+      CHECK_RANK (back_h(j)==rank);
+    }
+  });
+}
+
+void test_hierarchical (const ekat::Comm& comm)
+{
+  const int rank = comm.rank();
+  ekat::HierarchicalComm hcomm(comm,comm.split(rank/2));
+  CHECK_RANK (hcomm.num_nodes()==(comm.size()+1)/2);
+  CHECK_RANK (hcomm.node_id()==rank/2);
+
+  int sum = rank;
+  hcomm.all_reduce(&sum,1,MPI_SUM);
+  CHECK_RANK (sum==comm.size()*(comm.size()-1)/2);
+  for (int root=0; root<comm.size(); ++root) {
+    int val = rank==root ? 42+root : -1;
+    hcomm.broadcast(&val,1,root);
+    CHECK_RANK (val==42+root);
+  }
+
+  ekat::NodeSharedArray<double> table(hcomm.node_comm(),10);
+  if (table.am_i_writer()) {
+    for (int i=0; i<10; ++i) {
+      table.data()[i] = i + 100*hcomm.node_id();
+    }
+  }
+  table.sync();
+  for (int i=0; i<10; ++i) {
+    CHECK_RANK (table.data()[i]==i + 100*hcomm.node_id());
+  }
+}
+
+TEST_CASE ("comm_threads","") {
+  using namespace ekat;
+
+  SECTION ("collectives") {
+    for (int nranks : {1,2,3,4}) {
+      REQUIRE_NOTHROW (run_on_thread_ranks(nranks,test_collectives));
+    }
+  }
+
+  SECTION ("point_to_point") {
+    for (int nranks : {1,2,3,4}) {
+      REQUIRE_NOTHROW (run_on_thread_ranks(nranks,test_point_to_point));
+    }
+    // Without thread ranks, there is no one to talk to
+    const int val = 0;
+    REQUIRE_THROWS (Comm().send(&val,1,0));
+  }
+
+  SECTION ("nonblocking") {
+    for (int nranks : {1,2,3,4}) {
+      REQUIRE_NOTHROW (run_on_thread_ranks(nranks,test_nonblocking));
+    }
+  }
+
+  SECTION ("variable_count") {
+    for (int nranks : {1,2,3,4}) {
+      REQUIRE_NOTHROW (run_on_thread_ranks(nranks,test_variable_count));
+    }
+  }
+
+  SECTION ("views") {
+    for (int nranks : {1,2,3,4}) {
+      REQUIRE_NOTHROW (run_on_thread_ranks(nranks,test_views));
+    }
+  }
+
+  SECTION ("reproducible_sum") {
+    // The sum has the same bits regardless of the number of ranks
+    const int n = 120;
+    std::vector<double> vals(n);
+    for (int i=0; i<n; ++i) {
+      vals[i] = (i%2==0 ? 1 : -1) * (1.0 + 1e-3*i) * std::pow(10.0,i%17-8);
+    }
+    std::vector<double> sums(4);
+    for (int nranks : {1,2,3,4}) {
+      run_on_thread_ranks(nranks,[&](const Comm& comm) {
+        const int chunk = n / comm.size();
+        double sum;
+        comm.reproducible_sum(vals.data()+comm.rank()*chunk,&sum,chunk);
+        if (comm.am_i_root()) {
+          sums[nranks-1] = sum;
+        }
+      });
+    }
+    for (int i=1; i<4; ++i) {
+      REQUIRE (sums[i]==sums[0]);
+    }
+  }
+
+  SECTION ("hierarchical") {
+    for (int nranks : {1,2,3,4}) {
+      REQUIRE_NOTHROW (run_on_thread_ranks(nranks,test_hierarchical));
+    }
+  }
+
+  SECTION ("errors") {
+    // A failing rank interrupts the others, even if they wait on it
+    auto fail_on_one = [](const Comm& comm) {
+      EKAT_REQUIRE_MSG (comm.rank()!=1, "Rank 1 failed.\n");
+      int val;
+      comm.recv(&val,1,1);
+    };
+    REQUIRE_THROWS_WITH (run_on_thread_ranks(3,fail_on_one),
+                         Catch::Contains("Rank 1 failed"));
+
+    // Runs cannot be nested
+    REQUIRE_THROWS (run_on_thread_ranks(2,[](const Comm&) {
+      run_on_thread_ranks(2,[](const Comm&) {});
+    }));
+    REQUIRE_THROWS (run_on_thread_ranks(0,[](const Comm&) {}));
+  }
+}
+
+} // anonymous namespace
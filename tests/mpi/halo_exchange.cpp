@@ -0,0 +1,140 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/mpi/ekat_halo_exchange.hpp"
+#include "ekat/ekat_pack_kokkos.hpp"
+
+#include <vector>
+
+namespace {
+
+// A periodic 1D domain, split in contiguous chunks of n entries per rank.
+// Locally, entries are [halo(h), owned(n), halo(h)], with global id
+//   gid(j) = (rank*n + j - h) mod (size*n).
+// The field value at (j,k) is 100*gid(j)+k.
+struct Ring {
+  Ring (const ekat::Comm& comm_in, const int n_in, const int h_in)
+   : comm(comm_in), n(n_in), h(h_in)
+  {
+    const int rank = comm.rank();
+    const int size = comm.size();
+    left  = (rank+size-1) % size;
+    right = (rank+1) % size;
+  }
+
+  int gid (const int j) const {
+    const int ng = comm.size()*n;
+    return (comm.rank()*n + j - h + ng) % ng;
+  }
+
+  // Register the exchanges with the HaloExchange. Messages to a neighbor list
+  // the entries sent to its left first, then those sent to its right. If the
+  // left and right neighbors are the same rank, the lists are merged.
+  template<typename HE>
+  void register_neighbors (HE& he) const {
+    std::vector<int> lsend, rsend, lrecv, rrecv;
+    for (int i=0; i<h; ++i) {
+      lsend.push_back(h+i);       // My first owned entries go to the left
+      rsend.push_back(n+i);       // My last owned entries go to the right
+      lrecv.push_back(i);         // Left halo comes from the left neighbor
+      rrecv.push_back(n+h+i);     // Right halo comes from the right neighbor
+    }
+    if (left==right) {
+      auto send = lsend;
+      send.insert(send.end(),rsend.begin(),rsend.end());
+      // The neighbor sends its left entries first, which go to my right halo
+      auto recv = rrecv;
+      recv.insert(recv.end(),lrecv.begin(),lrecv.end());
+      he.add_neighbor(left,send,recv);
+    } else {
+      he.add_neighbor(left,lsend,lrecv);
+      he.add_neighbor(right,rsend,rrecv);
+    }
+  }
+
+  ekat::Comm comm;
+  int n, h;
+  int left, right;
+};
+
+TEST_CASE ("halo_exchange","") {
+  using namespace ekat;
+  using HE = HaloExchange<double>;
+  using view_2d = HE::KT::view_2d<double>;
+
+  Comm comm(MPI_COMM_WORLD);
+
+  const int n = 10;
+  const int h = 2;
+  const int nlev = 7;
+  const int nsteps = 3;
+  Ring ring(comm,n,h);
+
+  HE he(comm);
+  ring.register_neighbors(he);
+  REQUIRE_THROWS (he.start(view_2d("f",n+2*h,nlev)));
+  he.setup(nlev);
+  REQUIRE (he.is_setup());
+  REQUIRE (he.num_vals()==nlev);
+  REQUIRE_THROWS (he.add_neighbor(comm.rank(),{},{}));
+  REQUIRE_THROWS (he.setup(nlev));
+
+  view_2d f("f",n+2*h,nlev);
+  auto f_h = Kokkos::create_mirror_view(f);
+
+  for (int step=0; step<nsteps; ++step) {
+    // Owned entries hold the step-dependent value, halos hold garbage
+    for (int j=0; j<n+2*h; ++j) {
+      const bool owned = j>=h && j<n+h;
+      for (int k=0; k<nlev; ++k) {
+        f_h(j,k) = owned ? 100*ring.gid(j)+k+step : -1;
+      }
+    }
+    Kokkos::deep_copy(f,f_h);
+
+    // Modifying the owned entries between start and finish does not affect
+    // what the neighbors receive
+    he.start(f);
+    REQUIRE_THROWS (he.start(f));
+    Kokkos::parallel_for(HE::RangePolicy(h,n+h),KOKKOS_LAMBDA(const int j) {
+      for (int k=0; k<nlev; ++k) {
+        f(j,k) = -f(j,k);
+      }
+    });
+    he.finish(f);
+    REQUIRE_THROWS (he.finish(f));
+
+    Kokkos::deep_copy(f_h,f);
+    for (int j=0; j<n+2*h; ++j) {
+      const bool owned = j>=h && j<n+h;
+      for (int k=0; k<nlev; ++k) {
+        const double expected = 100*ring.gid(j)+k+step;
+        REQUIRE (f_h(j,k)==(owned ? -expected : expected));
+      }
+    }
+  }
+
+  // Exchange of a field of packs, through its scalarized view
+  using Pack = ekat::Pack<double,4>;
+  HE::KT::view_2d<Pack> p("p",n+2*h,ekat::npack<Pack>(2*nlev));
+  HE he_pack(comm,1);
+  ring.register_neighbors(he_pack);
+  he_pack.setup(4*ekat::npack<Pack>(2*nlev));
+  auto p_s = ekat::scalarize(p);
+  auto p_h = Kokkos::create_mirror_view(p_s);
+  for (int j=0; j<n+2*h; ++j) {
+    const bool owned = j>=h && j<n+h;
+    for (int k=0; k<p_h.extent_int(1); ++k) {
+      p_h(j,k) = owned ? ring.gid(j)+k : -1;
+    }
+  }
+  Kokkos::deep_copy(p_s,p_h);
+  he_pack.exchange(p_s);
+  Kokkos::deep_copy(p_h,p_s);
+  for (int j=0; j<n+2*h; ++j) {
+    for (int k=0; k<p_h.extent_int(1); ++k) {
+      REQUIRE (p_h(j,k)==ring.gid(j)+k);
+    }
+  }
+}
+
+} // anonymous namespace
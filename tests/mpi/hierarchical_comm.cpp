@@ -0,0 +1,130 @@
+#include <catch2/catch.hpp>
+
+#include "ekat/mpi/ekat_hierarchical_comm.hpp"
+#include "ekat/mpi/ekat_node_shared_array.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Check hierarchical collectives against the flat ones
+void test_collectives (const ekat::HierarchicalComm& hcomm)
+{
+  const auto& comm = hcomm.comm();
+  const int rank = comm.rank();
+  const int size = comm.size();
+  const int n = 5;
+
+  // The node info is consistent across all ranks
+  REQUIRE (hcomm.node_id(rank)==hcomm.node_id());
+  REQUIRE (hcomm.node_rank(rank)==hcomm.node_comm().rank());
+  REQUIRE (hcomm.am_i_leader()==(hcomm.node_comm().rank()==0));
+  if (hcomm.am_i_leader()) {
+    REQUIRE (hcomm.leaders_comm().size()==hcomm.num_nodes());
+    REQUIRE (hcomm.leaders_comm().rank()==hcomm.node_id());
+  } else {
+    REQUIRE_THROWS (hcomm.leaders_comm());
+  }
+  REQUIRE_THROWS (hcomm.node_id(size));
+
+  // Integer sums are exact, so results must match the flat ones
+  std::vector<int> mine(n), expected(n), result(n);
+  for (int i=0; i<n; ++i) {
+    mine[i] = (rank+1)*(i+1);
+  }
+  comm.all_reduce(mine.data(),expected.data(),n,MPI_SUM);
+  hcomm.all_reduce(mine.data(),result.data(),n,MPI_SUM);
+  REQUIRE (result==expected);
+  hcomm.all_reduce(mine.data(),n,MPI_SUM);
+  REQUIRE (mine==expected);
+
+  int max_rank = rank;
+  hcomm.all_reduce(&max_rank,1,MPI_MAX);
+  REQUIRE (max_rank==size-1);
+
+  for (int root=0; root<size; ++root) {
+    std::vector<double> vals(n,-1);
+    if (rank==root) {
+      for (int i=0; i<n; ++i) {
+        vals[i] = root + 0.5*i;
+      }
+    }
+    hcomm.broadcast(vals.data(),n,root);
+    for (int i=0; i<n; ++i) {
+      REQUIRE (vals[i]==root + 0.5*i);
+    }
+  }
+  REQUIRE_THROWS (hcomm.broadcast(result.data(),n,size));
+}
+
+TEST_CASE ("hierarchical_comm","") {
+  using namespace ekat;
+
+  Comm comm(MPI_COMM_WORLD);
+  const int rank = comm.rank();
+  const int size = comm.size();
+
+  SECTION ("shared_nodes") {
+    HierarchicalComm hcomm(comm);
+    test_collectives(hcomm);
+  }
+
+  SECTION ("emulated_nodes") {
+    // Emulate nodes of up to 1, 2 and 3 ranks
+    for (int node_size : {1,2,3}) {
+      // The node comm is not owned by hcomm, so we free it ourselves
+      auto node_comm = comm.split(rank/node_size);
+      {
+        HierarchicalComm hcomm(comm,node_comm);
+        REQUIRE (hcomm.num_nodes()==(size+node_size-1)/node_size);
+        REQUIRE (hcomm.node_id()==rank/node_size);
+        test_collectives(hcomm);
+      }
+      node_comm.free_mpi_comm();
+    }
+  }
+
+#ifdef EKAT_ENABLE_MPI
+  SECTION ("reordered_nodes") {
+    // Within each node, ranks are in reverse order (also with a single node)
+    for (int node_size : {2,size}) {
+      MPI_Comm split;
+      MPI_Comm_split(comm.mpi_comm(),rank/node_size,size-rank,&split);
+      Comm node_comm(split);
+      {
+        HierarchicalComm hcomm(comm,node_comm);
+        REQUIRE (hcomm.num_nodes()==(size+node_size-1)/node_size);
+        REQUIRE (hcomm.node_rank(rank)==std::min(node_size,size-rank/node_size*node_size)-1-rank%node_size);
+        test_collectives(hcomm);
+      }
+      node_comm.free_mpi_comm();
+    }
+  }
+#endif
+
+  SECTION ("node_shared_array") {
+    HierarchicalComm hcomm(comm);
+    const auto& node_comm = hcomm.node_comm();
+    const int n = 100;
+
+    NodeSharedArray<double> table(node_comm,n);
+    REQUIRE (table.size()==n);
+    REQUIRE (table.am_i_writer()==hcomm.am_i_leader());
+    if (table.am_i_writer()) {
+      for (int i=0; i<n; ++i) {
+        table.data()[i] = 2*i + hcomm.node_id();
+      }
+    }
+    table.sync();
+
+    // All ranks on the node see the same memory
+    auto v = table.view();
+    for (int i=0; i<n; ++i) {
+      REQUIRE (v(i)==2*i + hcomm.node_id());
+    }
+    REQUIRE_THROWS (NodeSharedArray<double>(node_comm,-1));
+  }
+}
+
+} // anonymous namespace
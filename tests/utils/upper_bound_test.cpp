@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 
 #include "ekat/util/ekat_upper_bound.hpp"
+#include "ekat/kokkos/ekat_kokkos_types.hpp"
 
 #include <random>
 #include <vector>
@@ -28,4 +29,100 @@ TEST_CASE("upper_bound", "soak") {
   }
 }
 
+TEST_CASE("upper_bound_branchless", "soak") {
+  using Pack = ekat::Pack<double,8>;
+
+  std::default_random_engine generator;
+  std::uniform_int_distribution<int> size_dist(0,300);
+  std::uniform_real_distribution<double> value_dist(0.0,1.0);
+
+  for (int r = 0; r < 1000; ++r) {
+    const int size = size_dist(generator);
+    std::vector<double> v(size);
+    for (int i = 0; i < size; ++i) {
+      v[i] = value_dist(generator);
+    }
+    // Add some duplicates, to check ties are handled correctly
+    for (int i = 1; i < size; i += 7) {
+      v[i] = v[i-1];
+    }
+    std::sort(v.begin(), v.end());
+
+    const double* beg = v.data();
+    const double* end = v.data() + size;
+
+    // Search values also slightly outside the range of v, as well as values in v
+    Pack search_vals;
+    for (int s = 0; s < Pack::n; ++s) {
+      search_vals[s] = value_dist(generator)*1.2 - 0.1;
+    }
+    if (size > 0) {
+      search_vals[0] = v[size/2];
+      search_vals[1] = v[0];
+      search_vals[2] = v[size-1];
+    }
+
+    std::vector<double> eytz(size+1);
+    std::vector<int> rank(size+1);
+    ekat::eytzinger_build(beg, size, eytz.data(), rank.data());
+
+    const auto ub_bl = ekat::upper_bound_branchless(beg, end, search_vals);
+    const auto ub_ez = ekat::eytzinger_upper_bound(eytz.data(), rank.data(), size, search_vals);
+    for (int s = 0; s < Pack::n; ++s) {
+      const int ub = std::upper_bound(beg, end, search_vals[s]) - beg;
+      REQUIRE(ekat::upper_bound_branchless(beg, end, search_vals[s]) - beg == ub);
+      REQUIRE(ekat::eytzinger_upper_bound(eytz.data(), rank.data(), size, search_vals[s]) == ub);
+      REQUIRE(ub_bl[s] == ub);
+      REQUIRE(ub_ez[s] == ub);
+    }
+  }
+}
+
+TEST_CASE("eytzinger_table", "soak") {
+  using Device = ekat::DefaultDevice;
+  using KT = ekat::KokkosTypes<Device>;
+  using Pack = ekat::Pack<double,4>;
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<double> value_dist(0.0,1.0);
+
+  const int size = 1000;
+  const int nsearch = 256;
+
+  KT::view_1d<double> table("table",size);
+  KT::view_1d<Pack> vals("vals",nsearch);
+  KT::view_1d<ekat::Pack<int,4>> ub("ub",nsearch);
+
+  auto table_h = Kokkos::create_mirror_view(table);
+  auto vals_h = Kokkos::create_mirror_view(vals);
+  for (int i = 0; i < size; ++i) {
+    table_h(i) = value_dist(generator);
+  }
+  std::sort(table_h.data(), table_h.data()+size);
+  for (int i = 0; i < nsearch; ++i) {
+    for (int s = 0; s < Pack::n; ++s) {
+      vals_h(i)[s] = value_dist(generator);
+    }
+  }
+  Kokkos::deep_copy(table, table_h);
+  Kokkos::deep_copy(vals, vals_h);
+
+  ekat::EytzingerTable<double,Device> et(table);
+  REQUIRE (et.size()==size);
+
+  Kokkos::parallel_for(KT::RangePolicy(0,nsearch),
+                       KOKKOS_LAMBDA(const int i) {
+    ub(i) = et.upper_bound(vals(i));
+  });
+
+  auto ub_h = Kokkos::create_mirror_view(ub);
+  Kokkos::deep_copy(ub_h, ub);
+  for (int i = 0; i < nsearch; ++i) {
+    for (int s = 0; s < Pack::n; ++s) {
+      const double* beg = table_h.data();
+      REQUIRE (ub_h(i)[s] == std::upper_bound(beg, beg+size, vals_h(i)[s]) - beg);
+    }
+  }
+}
+
 } // empty namespace